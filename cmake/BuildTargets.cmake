@@ -2,6 +2,7 @@
 # create the targets
 set(RDF_BINARY_NAME ${PROJECT_NAME})		# binary
 set(RDF_TEST_NAME ${PROJECT_NAME}Test)		# test binary
+set(RDF_BENCHMARK_NAME ${PROJECT_NAME}Benchmark)	# benchmark binary
 set(RDF_DLL_CORE_NAME ${PROJECT_NAME}Core)	# library
 set(CMAKE_INCLUDE_CURRENT_DIR ON)
 
@@ -33,6 +34,19 @@ set_target_properties(${RDF_TEST_NAME} PROPERTIES LINK_FLAGS_DEBUG "${CMAKE_EXE_
 
 add_dependencies(${RDF_TEST_NAME} ${RDF_DLL_MODULE_NAME} ${RDF_DLL_CORE_NAME}) 
 
+# add benchmark target
+add_executable(${RDF_BENCHMARK_NAME} WIN32  MACOSX_BUNDLE ${BENCHMARK_SOURCES} ${BENCHMARK_HEADERS} ${RDF_RC})
+target_link_libraries(${RDF_BENCHMARK_NAME} ${RDF_LIB_CORE_NAME} ${OpenCV_LIBS}) 
+
+set_target_properties(${RDF_BENCHMARK_NAME} PROPERTIES COMPILE_FLAGS "-DNOMINMAX")
+set_target_properties(${RDF_BENCHMARK_NAME} PROPERTIES LINK_FLAGS_RELEASE "${CMAKE_EXE_LINKER_FLAGS_RELEASE}")
+
+add_dependencies(${RDF_BENCHMARK_NAME} ${RDF_DLL_CORE_NAME}) 
+
+if((CMAKE_COMPILER_IS_GNUCXX AND ENABLE_COVERAGE) OR (NOT CMAKE_CONFIGURATION_TYPES AND NOT CMAKE_BUILD_TYPE MATCHES "^(Release|RelWithDebInfo|MinSizeRel)$"))
+	message(WARNING "${RDF_BENCHMARK_NAME} is not built with release flags - timings will not be representative (use -DCMAKE_BUILD_TYPE=Release)")
+endif()
+
 # add core
 add_library(
 	${RDF_DLL_CORE_NAME} SHARED 
@@ -49,11 +63,14 @@ target_link_libraries(${RDF_DLL_CORE_NAME} ${VERSION_LIB} ${OpenCV_LIBS})
 add_dependencies(${RDF_BINARY_NAME} ${RDF_DLL_CORE_NAME}) 
 
 target_include_directories(${RDF_BINARY_NAME} 		PRIVATE ${OpenCV_INCLUDE_DIRS})
-target_include_directories(${RDF_TEST_NAME} 	    	PRIVATE ${OpenCV_INCLUDE_DIRS})
+target_include_directories(${RDF_TEST_NAME} 	    	PRIVATE ${OpenCV_INCLUDE_DIRS} ${CMAKE_CURRENT_SOURCE_DIR}/src/Benchmark)
+target_compile_definitions(${RDF_TEST_NAME} 		PRIVATE RDF_PERFORMANCE_BASELINE="${CMAKE_CURRENT_SOURCE_DIR}/resources/performance/baseline.json")
+target_include_directories(${RDF_BENCHMARK_NAME} 	PRIVATE ${OpenCV_INCLUDE_DIRS})
 target_include_directories(${RDF_DLL_CORE_NAME} 	PRIVATE ${OpenCV_INCLUDE_DIRS})
 
 target_link_libraries(${RDF_BINARY_NAME} 		Qt5::Core Qt5::Network Qt5::Gui)
 target_link_libraries(${RDF_TEST_NAME} 			Qt5::Core Qt5::Network Qt5::Gui)
+target_link_libraries(${RDF_BENCHMARK_NAME} 		Qt5::Core Qt5::Network Qt5::Gui)
 target_link_libraries(${RDF_DLL_CORE_NAME} 	Qt5::Core Qt5::Network Qt5::Gui)
 
 # core flags
@@ -103,6 +120,11 @@ if (MSVC)
 	set_target_properties(${RDF_TEST_NAME} PROPERTIES LINK_FLAGS_RELEASE "/SUBSYSTEM:CONSOLE")
 	set_target_properties(${RDF_TEST_NAME} PROPERTIES LINK_FLAGS_RELWITHDEBINFO "/SUBSYSTEM:CONSOLE")
 
+	# set as console project 
+	set_target_properties(${RDF_BENCHMARK_NAME} PROPERTIES LINK_FLAGS_DEBUG "/SUBSYSTEM:CONSOLE")
+	set_target_properties(${RDF_BENCHMARK_NAME} PROPERTIES LINK_FLAGS_RELEASE "/SUBSYSTEM:CONSOLE")
+	set_target_properties(${RDF_BENCHMARK_NAME} PROPERTIES LINK_FLAGS_RELWITHDEBINFO "/SUBSYSTEM:CONSOLE")
+
 endif ()
 
 file(GLOB RDF_AUTOMOC "${CMAKE_BINARY_DIR}/*_automoc.cpp")
@@ -147,6 +169,26 @@ configure_file(${RDF_SOURCE_DIR}/ReadFramework.cmake.in ${CMAKE_BINARY_DIR}/Read
 # add_test(NAME TableTest COMMAND ${RDF_TEST_NAME} "--table")
 # add_test(NAME PreProcessing COMMAND ${RDF_TEST_NAME} "--pre-processing")
 # add_test(NAME SuperPixel COMMAND ${RDF_TEST_NAME} "--super-pixel")
+# add_test(NAME Kernels COMMAND ${RDF_BENCHMARK_NAME} "--runs" "3")
+
+# offline tests (no test resources needed)
+add_test(NAME LabelContours COMMAND ${RDF_TEST_NAME} "--label-contours")
+add_test(NAME RandomTrees COMMAND ${RDF_TEST_NAME} "--random-trees")
+add_test(NAME TextHeight COMMAND ${RDF_TEST_NAME} "--text-height")
+add_test(NAME WriterIndex COMMAND ${RDF_TEST_NAME} "--writer-index")
+add_test(NAME MatFile COMMAND ${RDF_TEST_NAME} "--mat-file")
+
+# runs offline on synthetic pages and fails if a stage exceeds its budget w.r.t. the committed baseline
+# (update resources/performance/baseline.json with --perf-update on the reference machine)
+if(ENABLE_PERFORMANCE_TEST AND NOT ENABLE_COVERAGE)
+	if(CMAKE_CONFIGURATION_TYPES)
+		add_test(NAME Performance CONFIGURATIONS Release RelWithDebInfo COMMAND ${RDF_TEST_NAME} "--performance")
+	elseif(CMAKE_BUILD_TYPE MATCHES "^(Release|RelWithDebInfo)$")
+		add_test(NAME Performance COMMAND ${RDF_TEST_NAME} "--performance")
+	else()
+		message(STATUS "the performance test is only registered for release builds")
+	endif()
+endif()
 
 #package 
 if (UNIX)
@@ -0,0 +1,387 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "BatchProcessing.h"
+
+#include "PageParser.h"
+#include "Utils.h"
+#include "Profiler.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+namespace rdf {
+
+/// <summary>
+/// Processes a single page of a batch.
+/// Exceptions are caught so that a broken page does not stop the batch.
+/// </summary>
+class PageTask : public QRunnable {
+
+public:
+	PageTask(const DebugConfig& config, const BatchProcessing::PageFunction& process, 
+		BatchProcessing::PageResult& result, QSemaphore& inFlight, QAtomicInt& numDone, int numPages) :
+		mConfig(config), mProcess(process), mResult(result), mInFlight(inFlight), mNumDone(numDone), mNumPages(numPages) {
+	}
+
+	void run() override {
+
+		Timer dt;
+
+		try {
+			rdfProfileScope("page");
+			bool ok = mProcess(mConfig);
+			mResult.status = ok ? BatchProcessing::status_ok : BatchProcessing::status_failed;
+		}
+		catch (const std::exception& e) {
+			mResult.status = BatchProcessing::status_exception;
+			mResult.message = QString::fromLocal8Bit(e.what());
+		}
+		catch (...) {
+			mResult.status = BatchProcessing::status_exception;
+			mResult.message = "unknown exception";
+		}
+
+		mResult.ms = dt.elapsed();
+		mResult.peakMemory = Utils::peakMemory();
+
+		int numDone = mNumDone.fetchAndAddOrdered(1) + 1;
+		qInfo().noquote() << QString("[%1/%2]").arg(numDone).arg(mNumPages) 
+			<< QFileInfo(mResult.imagePath).fileName()
+			<< BatchProcessing::statusName(mResult.status) << "in" << dt 
+			<< mResult.message;
+
+		mInFlight.release();
+	}
+
+private:
+	DebugConfig mConfig;
+	const BatchProcessing::PageFunction& mProcess;
+	BatchProcessing::PageResult& mResult;
+	QSemaphore& mInFlight;
+	QAtomicInt& mNumDone;
+	int mNumPages;
+};
+
+// BatchProcessing --------------------------------------------------------------------
+BatchProcessing::BatchProcessing(const DebugConfig& config) : mConfig(config) {
+}
+
+/// <summary>
+/// Returns true if path is a directory or a list file.
+/// List files are plain text files with a .txt, .lst or .list suffix.
+/// </summary>
+/// <param name="path">The input path.</param>
+bool BatchProcessing::isBatchInput(const QString & path) {
+
+	QFileInfo info(path);
+
+	if (info.isDir())
+		return true;
+
+	if (!info.isFile())
+		return false;
+
+	QStringList listSuffixes;
+	listSuffixes << "txt" << "lst" << "list";
+
+	return listSuffixes.contains(info.suffix().toLower());
+}
+
+/// <summary>
+/// Collects the image paths of a batch.
+/// If path is a directory, all images in this directory are returned.
+/// Otherwise, path is a list file with one image path per line.
+/// Empty lines and lines starting with # are ignored. Relative
+/// paths are relative to the list file.
+/// </summary>
+/// <param name="path">A directory or list file.</param>
+/// <returns>The absolute image paths.</returns>
+QStringList BatchProcessing::collectImages(const QString & path) {
+
+	QStringList imagePaths;
+	QFileInfo info(path);
+
+	if (info.isDir()) {
+
+		QStringList filters;
+		for (const QByteArray& f : QImageReader::supportedImageFormats())
+			filters << "*." + QString::fromLatin1(f);
+
+		QDir dir(info.absoluteFilePath());
+		for (const QFileInfo& fi : dir.entryInfoList(filters, QDir::Files, QDir::Name))
+			imagePaths << fi.absoluteFilePath();
+	}
+	else if (info.isFile()) {
+
+		if (!isBatchInput(path))
+			return QStringList() << info.absoluteFilePath();
+
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			qWarning() << "cannot open" << path;
+			return imagePaths;
+		}
+
+		QDir dir = info.absoluteDir();
+		QTextStream ts(&file);
+
+		while (!ts.atEnd()) {
+
+			QString line = ts.readLine().trimmed();
+
+			if (line.isEmpty() || line.startsWith("#"))
+				continue;
+
+			imagePaths << QFileInfo(dir, line).absoluteFilePath();
+		}
+	}
+	else
+		qWarning() << path << "does not exist";
+
+	return imagePaths;
+}
+
+/// <summary>
+/// Sets the number of worker threads.
+/// </summary>
+/// <param name="numThreads">The number of threads, if &lt; 1 QThread::idealThreadCount() is used.</param>
+void BatchProcessing::setNumThreads(int numThreads) {
+	mNumThreads = numThreads;
+}
+
+int BatchProcessing::numThreads() const {
+	return mNumThreads > 0 ? mNumThreads : qMax(QThread::idealThreadCount(), 1);
+}
+
+/// <summary>
+/// Sets the maximal number of pages that are scheduled at the same time.
+/// Reduce it (below numThreads) to reduce the peak memory.
+/// </summary>
+/// <param name="maxInFlight">The maximum number of pages in flight, if &lt; 1 twice the number of threads is used.</param>
+void BatchProcessing::setMaxInFlight(int maxInFlight) {
+	mMaxInFlight = maxInFlight;
+}
+
+int BatchProcessing::maxInFlight() const {
+	return mMaxInFlight > 0 ? mMaxInFlight : 2 * numThreads();
+}
+
+/// <summary>
+/// Sets the path of the JSON summary.
+/// If it is empty, no summary is written.
+/// </summary>
+void BatchProcessing::setSummaryPath(const QString & path) {
+	mSummaryPath = path;
+}
+
+QString BatchProcessing::summaryPath() const {
+	return mSummaryPath;
+}
+
+/// <summary>
+/// Processes all pages.
+/// </summary>
+/// <param name="imagePaths">The image paths.</param>
+/// <param name="process">The function that processes a single page.</param>
+/// <returns>true if all pages were processed successfully.</returns>
+bool BatchProcessing::run(const QStringList & imagePaths, const PageFunction & process) {
+
+	Timer dt;
+
+	mResults.clear();
+	mResults.resize(imagePaths.size());
+
+	// pages are processed in parallel - avoid oversubscription by nested parallel_for_ loops
+	int cvThreads = cv::getNumThreads();
+	if (numThreads() > 1)
+		cv::setNumThreads(1);
+
+	qInfo() << "processing" << imagePaths.size() << "pages with" << numThreads() << "threads," << maxInFlight() << "pages in flight";
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(numThreads());
+	
+	QSemaphore inFlight(maxInFlight());
+	QAtomicInt numDone(0);
+	PageResult* results = mResults.data();
+
+	for (int idx = 0; idx < imagePaths.size(); idx++) {
+
+		results[idx].imagePath = imagePaths[idx];
+		
+		inFlight.acquire();
+		pool.start(new PageTask(pageConfig(imagePaths[idx]), process, results[idx], inFlight, numDone, imagePaths.size()));
+	}
+
+	pool.waitForDone();
+	cv::setNumThreads(cvThreads);
+
+	mTotalMs = dt.elapsed();
+	qInfo().noquote() << toString();
+
+	if (!mSummaryPath.isEmpty())
+		writeSummary();
+
+	for (const PageResult& r : mResults) {
+		if (r.status != status_ok)
+			return false;
+	}
+
+	return true;
+}
+
+QVector<BatchProcessing::PageResult> BatchProcessing::results() const {
+	return mResults;
+}
+
+QJsonObject BatchProcessing::toJson() const {
+
+	QJsonObject jo;
+	QJsonArray pages;
+	QVector<int> counts(status_end, 0);
+
+	for (const PageResult& r : mResults) {
+
+		QJsonObject po;
+		po["image"] = r.imagePath;
+		po["status"] = statusName(r.status);
+		po["ms"] = r.ms;
+		po["peakMB"] = r.peakMemory / (1024.0 * 1024.0);
+
+		if (!r.message.isEmpty())
+			po["message"] = r.message;
+
+		pages << po;
+		counts[r.status]++;
+	}
+
+	jo["numPages"] = mResults.size();
+	jo["numOk"] = counts[status_ok];
+	jo["numFailed"] = counts[status_failed];
+	jo["numExceptions"] = counts[status_exception];
+	jo["numThreads"] = numThreads();
+	jo["maxInFlight"] = maxInFlight();
+	jo["totalMs"] = mTotalMs;
+	jo["pages"] = pages;
+
+	return jo;
+}
+
+QString BatchProcessing::toString() const {
+
+	QVector<int> counts(status_end, 0);
+	qint64 pageMs = 0;
+
+	for (const PageResult& r : mResults) {
+		counts[r.status]++;
+		pageMs += r.ms;
+	}
+
+	QString msg;
+	msg += QString::number(mResults.size()) + " pages processed in " + Timer().stringifyTime(mTotalMs);
+	msg += " (ok: " + QString::number(counts[status_ok]);
+	msg += ", failed: " + QString::number(counts[status_failed]);
+	msg += ", exceptions: " + QString::number(counts[status_exception]) + ")";
+
+	if (!mResults.isEmpty() && mTotalMs > 0) {
+		msg += " mean page time: " + QString::number(pageMs / mResults.size()) + " ms";
+		msg += " throughput: " + QString::number(mResults.size() * 1000.0 / mTotalMs, 'f', 2) + " pages/s";
+	}
+
+	return msg;
+}
+
+QString BatchProcessing::statusName(const Status & status) {
+
+	switch (status) {
+	case status_ok:			return "ok";
+	case status_failed:		return "failed";
+	case status_exception:	return "exception";
+	default:				return "unknown";
+	}
+}
+
+/// <summary>
+/// Returns the configuration of a single page.
+/// The XML path is derived from the image path. Outputs are
+/// written to the output directory (if specified) or next to the image.
+/// </summary>
+DebugConfig BatchProcessing::pageConfig(const QString & imagePath) const {
+
+	DebugConfig dc = mConfig;
+	dc.setImagePath(imagePath);
+	dc.setXmlPath(PageXmlParser::imagePathToXmlPath(imagePath));
+
+	QFileInfo outInfo(mConfig.outputPath());
+
+	if (!mConfig.outputPath().isEmpty() && outInfo.isDir()) {
+		QString fileName = QFileInfo(imagePath).completeBaseName() + "-result.png";
+		dc.setOutputPath(QDir(outInfo.absoluteFilePath()).absoluteFilePath(fileName));
+	}
+	else
+		dc.setOutputPath(Utils::createFilePath(imagePath, "-result", "png"));
+
+	return dc;
+}
+
+bool BatchProcessing::writeSummary() const {
+
+	QFile file(mSummaryPath);
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "cannot write batch summary to" << mSummaryPath;
+		return false;
+	}
+
+	file.write(QJsonDocument(toJson()).toJson());
+	qInfo() << "batch summary written to" << mSummaryPath;
+
+	return true;
+}
+
+}
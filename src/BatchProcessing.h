@@ -0,0 +1,119 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#include "DebugUtils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+
+#include <functional>
+#pragma warning(pop)
+
+// TODO: add DllExport magic
+
+// Qt defines
+
+namespace rdf {
+
+// read defines
+
+/// <summary>
+/// Processes a directory (or a list file) of pages in a single process.
+/// Pages are processed on a bounded worker pool. Each page is isolated:
+/// if it fails or throws, the remaining pages are processed anyways.
+/// A per-page summary (status & timings) is written to a JSON file.
+/// </summary>
+class BatchProcessing {
+
+public:
+	BatchProcessing(const DebugConfig& config = DebugConfig());
+
+	/// <summary>
+	/// Processes a single page and returns false if it failed.
+	/// </summary>
+	typedef std::function<bool(const DebugConfig&)> PageFunction;
+
+	enum Status {
+		status_ok = 0,
+		status_failed,		// the page function returned false
+		status_exception,	// the page function threw
+
+		status_end
+	};
+
+	struct PageResult {
+		QString imagePath;
+		Status status = status_failed;
+		int ms = 0;
+		qint64 peakMemory = 0;	// peak resident memory (bytes) of the process after the page
+		QString message;
+	};
+
+	static bool isBatchInput(const QString& path);
+	static QStringList collectImages(const QString& path);
+
+	void setNumThreads(int numThreads);
+	int numThreads() const;
+
+	void setMaxInFlight(int maxInFlight);
+	int maxInFlight() const;
+
+	void setSummaryPath(const QString& path);
+	QString summaryPath() const;
+
+	bool run(const QStringList& imagePaths, const PageFunction& process);
+
+	QVector<PageResult> results() const;
+	QJsonObject toJson() const;
+	QString toString() const;
+
+	static QString statusName(const Status& status);
+
+private:
+	DebugConfig mConfig;
+	int mNumThreads = -1;		// < 1 -> QThread::idealThreadCount()
+	int mMaxInFlight = -1;		// < 1 -> 2 * numThreads
+	QString mSummaryPath;
+
+	QVector<PageResult> mResults;
+	int mTotalMs = 0;
+
+	DebugConfig pageConfig(const QString& imagePath) const;
+	bool writeSummary() const;
+};
+
+}
@@ -0,0 +1,733 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "Benchmark.h"
+
+#include "Utils.h"
+#include "Settings.h"
+#include "ScaleFactory.h"
+#include "PixelSet.h"
+#include "Binarization.h"
+#include "SkewEstimation.h"
+#include "SuperPixel.h"
+#include "GraphCut.h"
+#include "LineTrace.h"
+#include "GaborFiltering.h"
+#include "WriterDatabase.h"
+#include "Image.h"
+#include "ImageProcessor.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QMap>
+#include <QDir>
+#include <QFile>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/ml.hpp>
+#pragma warning(pop)
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace rdf {
+
+namespace {
+
+	// loads a config as ModuleConfig::loadSettings() did before settings snapshots
+	template <class C>
+	void loadConfigFromFile() {
+		C c;
+		DefaultSettings s;
+		c.loadSettings(s);
+	}
+
+	template <class C>
+	void loadConfigFromSnapshot() {
+		C c;
+		c.loadSettings();
+	}
+}
+
+// BenchmarkResult --------------------------------------------------------------------
+BenchmarkResult::BenchmarkResult(const QString & name, double amount, const QString & unit) {
+	mName = name;
+	mAmount = amount;
+	mUnit = unit;
+}
+
+bool BenchmarkResult::isEmpty() const {
+	return mTimes.isEmpty();
+}
+
+QString BenchmarkResult::name() const {
+	return mName;
+}
+
+QString BenchmarkResult::unit() const {
+	return mUnit;
+}
+
+void BenchmarkResult::addTime(double ms) {
+	mTimes << ms;
+}
+
+QVector<double> BenchmarkResult::times() const {
+	return mTimes;
+}
+
+/// <summary>
+/// The median run time in ms.
+/// </summary>
+double BenchmarkResult::median() const {
+
+	if (mTimes.isEmpty())
+		return 0.0;
+
+	QVector<double> t = mTimes;
+	std::sort(t.begin(), t.end());
+
+	int n = t.size();
+	return n % 2 ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) * 0.5;
+}
+
+/// <summary>
+/// The 95th percentile of the run times in ms.
+/// </summary>
+double BenchmarkResult::p95() const {
+	return percentile(0.95);
+}
+
+double BenchmarkResult::min() const {
+	return mTimes.isEmpty() ? 0.0 : *std::min_element(mTimes.begin(), mTimes.end());
+}
+
+/// <summary>
+/// Returns the throughput (unit/s) w.r.t. the median run time.
+/// </summary>
+double BenchmarkResult::throughput() const {
+
+	double m = median();
+	return m > 0 ? mAmount / (m / 1000.0) : 0.0;
+}
+
+QJsonObject BenchmarkResult::toJson() const {
+
+	QJsonObject jo;
+	jo.insert("name", mName);
+	jo.insert("unit", mUnit);
+	jo.insert("amount", mAmount);
+	jo.insert("median", median());
+	jo.insert("p95", p95());
+	jo.insert("min", min());
+	jo.insert("throughput", throughput());
+
+	QJsonArray ja;
+	for (double t : mTimes)
+		ja << t;
+	jo.insert("times", ja);
+
+	return jo;
+}
+
+BenchmarkResult BenchmarkResult::fromJson(const QJsonObject & jo) {
+
+	BenchmarkResult r(jo.value("name").toString(), jo.value("amount").toDouble(), jo.value("unit").toString("MP"));
+
+	for (const QJsonValue& jv : jo.value("times").toArray())
+		r.addTime(jv.toDouble());
+
+	// baselines without single timings
+	if (r.isEmpty() && jo.contains("median"))
+		r.addTime(jo.value("median").toDouble());
+
+	return r;
+}
+
+QString BenchmarkResult::toString() const {
+
+	return QString("%1 median: %2 ms p95: %3 ms (%4 %5/s)")
+		.arg(mName, -18)
+		.arg(median(), 9, 'f', 2)
+		.arg(p95(), 9, 'f', 2)
+		.arg(throughput(), 0, 'f', 2)
+		.arg(mUnit);
+}
+
+/// <summary>
+/// Nearest rank percentile.
+/// </summary>
+double BenchmarkResult::percentile(double p) const {
+
+	if (mTimes.isEmpty())
+		return 0.0;
+
+	QVector<double> t = mTimes;
+	std::sort(t.begin(), t.end());
+
+	int idx = qBound(0, (int)std::ceil(p * t.size()) - 1, t.size() - 1);
+	return t[idx];
+}
+
+// Benchmark --------------------------------------------------------------------
+Benchmark::Benchmark(const cv::Size& pageSize, int numRuns) {
+	mPageSize = pageSize;
+	mNumRuns = numRuns;
+}
+
+void Benchmark::setNumRuns(int numRuns) {
+	mNumRuns = qMax(1, numRuns);
+}
+
+/// <summary>
+/// Restricts the benchmark to the kernels specified.
+/// All kernels are run if the list is empty.
+/// </summary>
+void Benchmark::setKernels(const QStringList & kernels) {
+	mKernels = kernels;
+}
+
+QStringList Benchmark::kernelNames() {
+
+	return QStringList() 
+		<< "su-binarization" 
+		<< "skew" 
+		<< "mser" 
+		<< "delaunay" 
+		<< "graph-shared"
+		<< "graph-compact"
+		<< "graphcut" 
+		<< "linetrace" 
+		<< "contours-mask"
+		<< "contours-labels"
+		<< "gabor" 
+		<< "fisher"
+		<< "config-file"
+		<< "config-snapshot"
+		<< "decode-full"
+		<< "decode-scaled";
+}
+
+/// <summary>
+/// Runs all (selected) kernels.
+/// Inputs that are needed by later kernels 
+/// (binary image, super pixels, GMM) are computed once for the selected kernels and not timed.
+/// </summary>
+/// <returns>false if a kernel fails.</returns>
+bool Benchmark::run() {
+
+	mResults.clear();
+
+	cv::Mat doc = syntheticDocument(mPageSize);
+	double mp = doc.rows * doc.cols / 1e6;
+
+	qInfo().nospace() << "benchmarking on a " << doc.cols << "x" << doc.rows << " synthetic page, " 
+		<< mNumRuns << " runs, " << cv::getNumThreads() << " threads";
+
+	// prepare inputs (only for the selected kernels) -------------------------------------
+	cv::Mat bwImg;
+	if (isSelected("linetrace")) {
+
+		BinarizationSuAdapted bin(doc);
+		if (!bin.compute()) {
+			qWarning() << "could not binarize the synthetic page";
+			return false;
+		}
+		bwImg = bin.binaryImage();
+	}
+
+	PixelSet set;
+	double ksp = 0.0;
+	if (isSelected("delaunay") || isSelected("graph-shared") || isSelected("graph-compact") || isSelected("graphcut")) {
+
+		SuperPixel sp(doc);
+		if (!sp.compute()) {
+			qWarning() << "could not compute super pixels of the synthetic page";
+			return false;
+		}
+		set = sp.pixelSet();
+		ksp = set.size() / 1e3;
+	}
+
+	if (isSelected("graphcut")) {
+
+		LocalOrientation lo(set);
+		lo.config()->setScaleFactory(QSharedPointer<ScaleFactory>(new ScaleFactory(doc.size())));
+		if (!lo.compute()) {
+			qWarning() << "could not compute the local orientation";
+			return false;
+		}
+	}
+
+	// label image (e.g. DeepMerge's output)
+	int numLabels = 8;
+	cv::Mat labels;
+	if (isSelected("contours-mask") || isSelected("contours-labels"))
+		labels = syntheticLabels(cv::Size(2000, 3000), numLabels);
+
+	// a centered crop for the texture features
+	cv::Mat crop;
+	GaborFilterBank gfb;
+	if (isSelected("gabor")) {
+
+		cv::Rect cr(0, 0, qMin(512, doc.cols), qMin(512, doc.rows));
+		cr.x = (doc.cols - cr.width) / 2;
+		cr.y = (doc.rows - cr.height) / 2;
+		crop = doc(cr).clone();
+
+		gfb = GaborFilterBank(QVector<double>() << 4 << 8 << 16, QVector<double>() << 0 << 45 << 90 << 135, 32);
+	}
+
+	// GMM on synthetic descriptors (a mixture of 16 gaussians)
+	cv::Mat desc;
+	FisherVectorEncoder fve;
+
+	if (isSelected("fisher")) {
+
+		cv::RNG rng(42);
+		cv::Mat centers(16, 64, CV_32FC1);
+		rng.fill(centers, cv::RNG::UNIFORM, -5.0, 5.0);
+
+		desc = cv::Mat(20000, 64, CV_32FC1);
+		rng.fill(desc, cv::RNG::NORMAL, 0.0, 1.0);
+		for (int rIdx = 0; rIdx < desc.rows; rIdx++)
+			desc.row(rIdx) += centers.row(rIdx % centers.rows);
+
+		cv::theRNG().state = 42;	// k-means initialization
+		cv::Ptr<cv::ml::EM> em = cv::ml::EM::create();
+		em->setClustersNumber(centers.rows);
+		em->setCovarianceMatrixType(cv::ml::EM::COV_MAT_DIAGONAL);
+		em->setTermCriteria(cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 100, FLT_EPSILON));
+
+		if (!em->trainEM(desc.rowRange(0, 4000))) {
+			qWarning() << "could not train the GMM";
+			return false;
+		}
+
+		fve = FisherVectorEncoder(em);
+	}
+
+	// kernels --------------------------------------------------------------------
+	bool ok = true;
+
+	ok &= measure("su-binarization", mp, "MP", [&]() {
+		BinarizationSuAdapted b(doc);
+		return b.compute();
+	});
+
+	ok &= measure("skew", mp, "MP", [&]() {
+		BaseSkewEstimation se(doc);
+		return se.compute();
+	});
+
+	ok &= measure("mser", mp, "MP", [&]() {
+		SuperPixel s(doc);
+		return s.compute();
+	});
+
+	ok &= measure("delaunay", ksp, "kSP", [&]() {
+		DelaunayPixelConnector dpc;
+		return !dpc.connect(set.pixels()).isEmpty();
+	});
+
+	ok &= measure("graph-shared", ksp, "kSP", [&]() {
+		PixelGraph pg(set);
+		pg.connect(DelaunayPixelConnector());
+		return pg.numEdges() > 0;
+	});
+
+	ok &= measure("graph-compact", ksp, "kSP", [&]() {
+		PixelGraph pg(set, PixelGraph::storage_compact);
+		pg.connect(DelaunayPixelConnector());
+		return pg.numEdges() > 0;
+	});
+
+	ok &= measure("graphcut", ksp, "kSP", [&]() {
+		GraphCutOrientation gc(set);
+		return gc.compute();
+	});
+
+	ok &= measure("linetrace", mp, "MP", [&]() {
+		LineTrace lt(bwImg);
+		return lt.compute();
+	});
+
+	// tracing each label's mask vs. a single pass over the label image
+	ok &= measure("contours-mask", labels.rows * labels.cols / 1e6, "MP", [&]() {
+		int numPolys = 0;
+		for (int idx = 0; idx < numLabels; idx++) {
+			cv::Mat mask = labels == idx;
+			numPolys += IP::maskToPoly(mask, 1.0).size();
+		}
+		return numPolys > 0;
+	});
+
+	ok &= measure("contours-labels", labels.rows * labels.cols / 1e6, "MP", [&]() {
+		return !IP::labelsToPolys(labels, numLabels).isEmpty();
+	});
+
+	ok &= measure("gabor", crop.rows * crop.cols / 1e6, "MP", [&]() {
+		cv::Mat f = GaborFiltering::extractGaborFeatures(crop, gfb);
+		return !f.empty();
+	});
+
+	ok &= measure("fisher", desc.rows / 1e3, "kDesc", [&]() {
+		cv::Mat fv = fve.encode(desc, true);
+		return !fv.empty();
+	});
+
+	// module construction: parsing the settings file per module vs. the shared snapshot
+	int numConfigs = 250;
+
+	ok &= measure("config-file", numConfigs * 4 / 1e3, "kConfigs", [&]() {
+		for (int idx = 0; idx < numConfigs; idx++) {
+			loadConfigFromFile<SuperPixelConfig>();
+			loadConfigFromFile<LocalOrientationConfig>();
+			loadConfigFromFile<GraphCutConfig>();
+			loadConfigFromFile<LineTraceConfig>();
+		}
+		return true;
+	});
+
+	ok &= measure("config-snapshot", numConfigs * 4 / 1e3, "kConfigs", [&]() {
+		for (int idx = 0; idx < numConfigs; idx++) {
+			loadConfigFromSnapshot<SuperPixelConfig>();
+			loadConfigFromSnapshot<LocalOrientationConfig>();
+			loadConfigFromSnapshot<GraphCutConfig>();
+			loadConfigFromSnapshot<LineTraceConfig>();
+		}
+		return true;
+	});
+
+	// image ingestion: full resolution vs. decoding at the processing resolution
+	if (isSelected("decode-full") || isSelected("decode-scaled")) {
+
+		QString jpgPath = QDir::temp().absoluteFilePath("rdf-benchmark-page.jpg");
+		
+		if (!Image::save(doc, jpgPath, 90)) {
+			qWarning() << "could not write" << jpgPath;
+			return false;
+		}
+
+		ImageReader reader(jpgPath);
+
+		ok &= measure("decode-full", mp, "MP", [&]() {
+			return reader.read(false);
+		});
+
+		ok &= measure("decode-scaled", mp, "MP", [&]() {
+			return reader.read(true);
+		});
+
+		qInfo().noquote() << reader.toString();
+		QFile::remove(jpgPath);
+	}
+
+	return ok;
+}
+
+QVector<BenchmarkResult> Benchmark::results() const {
+	return mResults;
+}
+
+QJsonObject Benchmark::toJson() const {
+
+	QJsonObject jo;
+	jo.insert("width", mPageSize.width);
+	jo.insert("height", mPageSize.height);
+	jo.insert("runs", mNumRuns);
+	jo.insert("threads", cv::getNumThreads());
+	jo.insert("release", isReleaseBuild());
+	jo.insert("opencv", QString(CV_VERSION));
+
+	QJsonArray ja;
+	for (const BenchmarkResult& r : mResults)
+		ja << r.toJson();
+	jo.insert("kernels", ja);
+
+	return jo;
+}
+
+bool Benchmark::write(const QString & filePath) const {
+
+	if (Utils::writeJson(filePath, toJson()) <= 0) {
+		qWarning() << "could not write benchmark results to" << filePath;
+		return false;
+	}
+
+	qInfo() << "benchmark results written to" << filePath;
+	return true;
+}
+
+/// <summary>
+/// Compares the median run times to a baseline file (written by Benchmark::write).
+/// A kernel regressed if its median is more than tolerance slower than the baseline.
+/// </summary>
+/// <param name="baselinePath">The baseline JSON file.</param>
+/// <param name="tolerance">The relative tolerance (0.1 = 10% slower).</param>
+/// <returns>The number of regressions or -1 if the baseline could not be loaded.</returns>
+int Benchmark::compare(const QString & baselinePath, double tolerance) const {
+
+	QJsonObject jo = Utils::readJson(baselinePath);
+
+	if (jo.isEmpty()) {
+		qWarning() << "could not read baseline from" << baselinePath;
+		return -1;
+	}
+
+	if (jo.value("width").toInt() != mPageSize.width || jo.value("height").toInt() != mPageSize.height)
+		qWarning() << "the baseline was measured with a different page size - results are not comparable";
+
+	if (jo.value("release").toBool() != isReleaseBuild())
+		qWarning() << "the baseline was measured with a different build type - results are not comparable";
+
+	QMap<QString, BenchmarkResult> baseline;
+	for (const QJsonValue& jv : jo.value("kernels").toArray()) {
+		BenchmarkResult r = BenchmarkResult::fromJson(jv.toObject());
+		baseline.insert(r.name(), r);
+	}
+
+	int numRegressions = 0;
+
+	for (const BenchmarkResult& r : mResults) {
+
+		if (!baseline.contains(r.name())) {
+			qInfo() << r.name() << "has no baseline";
+			continue;
+		}
+
+		double bm = baseline.value(r.name()).median();
+		double change = bm > 0 ? (r.median() - bm) / bm : 0.0;
+
+		QString msg = QString("%1 %2 ms vs. %3 ms baseline (%4%5%)")
+			.arg(r.name(), -18)
+			.arg(r.median(), 0, 'f', 2)
+			.arg(bm, 0, 'f', 2)
+			.arg(change >= 0 ? "+" : "")
+			.arg(change * 100.0, 0, 'f', 1);
+
+		if (change > tolerance) {
+			qWarning().noquote() << "[REGRESSION]" << msg;
+			numRegressions++;
+		}
+		else
+			qInfo().noquote() << msg;
+	}
+
+	return numRegressions;
+}
+
+/// <summary>
+/// Creates a deterministic label image with random (overlapping) rectangles and ellipses.
+/// </summary>
+/// <param name="size">The image size.</param>
+/// <param name="numLabels">The number of labels (including the background label 0).</param>
+/// <param name="seed">The random seed.</param>
+/// <returns>A CV_8UC1 label image.</returns>
+cv::Mat Benchmark::syntheticLabels(const cv::Size & size, int numLabels, int seed) {
+
+	cv::Mat labels(size, CV_8UC1, cv::Scalar(0));
+	cv::RNG rng(seed);
+
+	for (int idx = 0; idx < 400; idx++) {
+
+		cv::Point c(rng.uniform(0, size.width), rng.uniform(0, size.height));
+		cv::Size s(rng.uniform(10, 300), rng.uniform(5, 150));
+		cv::Scalar l(rng.uniform(1, numLabels));
+
+		if (idx % 2)
+			cv::rectangle(labels, cv::Rect(c, s), l, cv::FILLED);
+		else
+			cv::ellipse(labels, c, s, rng.uniform(0.0, 180.0), 0, 360, l, cv::FILLED);
+	}
+
+	return labels;
+}
+
+/// <summary>
+/// Renders a deterministic synthetic document.
+/// The page has text lines (random words), a ruled table,
+/// uneven illumination and noise and is rotated by skew degrees.
+/// </summary>
+/// <param name="size">The page size.</param>
+/// <param name="skew">The skew angle in degrees.</param>
+/// <param name="seed">The random seed.</param>
+/// <returns>A CV_8UC3 page.</returns>
+cv::Mat Benchmark::syntheticDocument(const cv::Size & size, double skew, int seed) {
+
+	cv::RNG rng(seed);
+	cv::Mat page(size, CV_8UC3, cv::Scalar(215, 230, 240));	// yellowish paper
+	cv::Scalar ink(60, 40, 35);
+
+	int font = cv::FONT_HERSHEY_SIMPLEX;
+	int margin = qRound(size.width * 0.08);
+	int lineHeight = qMax(size.height / 55, 12);
+
+	int bl = 0;
+	cv::Size ts = cv::getTextSize("X", font, 1.0, 1, &bl);
+	double scale = lineHeight * 0.45 / ts.height;
+	int thickness = qMax(1, qRound(scale * 1.5));
+	int space = qRound(lineHeight * 0.4);
+
+	auto randomWord = [&rng]() {
+		std::string w;
+		int len = rng.uniform(2, 11);
+		for (int idx = 0; idx < len; idx++)
+			w += (char)('a' + rng.uniform(0, 26));
+		return w;
+	};
+
+	// text block
+	int tableTop = qRound(size.height * 0.65);
+	for (int y = margin + lineHeight; y < tableTop - lineHeight; y += lineHeight) {
+
+		// paragraph breaks
+		if (rng.uniform(0, 12) == 0)
+			continue;
+
+		int x = margin;
+		while (true) {
+
+			std::string w = randomWord();
+			cv::Size ws = cv::getTextSize(w, font, scale, thickness, &bl);
+
+			if (x + ws.width > size.width - margin)
+				break;
+
+			cv::putText(page, w, cv::Point(x, y), font, scale, ink, thickness, cv::LINE_AA);
+			x += ws.width + space;
+		}
+	}
+
+	// ruled table
+	int numRows = 6;
+	int numCols = 4;
+	int lt = qMax(2, lineHeight / 10);
+	cv::Rect table(margin, tableTop, size.width - 2 * margin, size.height - margin - tableTop);
+	double cw = table.width / (double)numCols;
+	double ch = table.height / (double)numRows;
+
+	for (int rIdx = 0; rIdx <= numRows; rIdx++) {
+		int y = table.y + qRound(rIdx * ch);
+		cv::line(page, cv::Point(table.x, y), cv::Point(table.br().x, y), ink, lt);
+	}
+
+	for (int cIdx = 0; cIdx <= numCols; cIdx++) {
+		int x = table.x + qRound(cIdx * cw);
+		cv::line(page, cv::Point(x, table.y), cv::Point(x, table.br().y), ink, lt);
+	}
+
+	for (int rIdx = 0; rIdx < numRows; rIdx++) {
+		for (int cIdx = 0; cIdx < numCols; cIdx++) {
+			cv::Point p(table.x + qRound(cIdx * cw) + space, table.y + qRound((rIdx + 0.5) * ch) + lineHeight / 4);
+			cv::putText(page, randomWord(), p, font, scale, ink, thickness, cv::LINE_AA);
+		}
+	}
+
+	// skew
+	cv::Mat rot = cv::getRotationMatrix2D(cv::Point2f(size.width * 0.5f, size.height * 0.5f), skew, 1.0);
+	cv::warpAffine(page, page, rot, size, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+
+	// uneven illumination (darker to the right) & sensor noise
+	cv::Mat shade(1, size.width, CV_16SC1);
+	for (int x = 0; x < size.width; x++)
+		shade.at<short>(x) = (short)qRound(-30.0 * x / size.width);
+	cv::repeat(shade, size.height, 1, shade);
+
+	cv::Mat shade3;
+	cv::merge(std::vector<cv::Mat>(3, shade), shade3);
+
+	cv::Mat noise(size, CV_16SC3);
+	rng.fill(noise, cv::RNG::NORMAL, 0.0, 6.0);
+
+	cv::Mat p16;
+	page.convertTo(p16, CV_16SC3);
+	p16 += shade3 + noise;
+	p16.convertTo(page, CV_8UC3);
+
+	return page;
+}
+
+/// <summary>
+/// Returns true if the benchmark was compiled with optimizations.
+/// </summary>
+bool Benchmark::isReleaseBuild() {
+
+#if defined(DEBUG) || defined(_DEBUG) || (defined(__GNUC__) && !defined(__OPTIMIZE__))
+	return false;
+#else
+	return true;
+#endif
+}
+
+bool Benchmark::isSelected(const QString & name) const {
+	return mKernels.isEmpty() || mKernels.contains(name);
+}
+
+/// <summary>
+/// Times a kernel numRuns times after a warm-up run.
+/// The kernel fails if any of its runs fails.
+/// </summary>
+bool Benchmark::measure(const QString & name, double amount, const QString & unit, const std::function<bool()>& kernel) {
+
+	if (!isSelected(name))
+		return true;
+
+	// warm-up: lazy initializations, caches & OpenCV's thread pool
+	if (!kernel()) {
+		qWarning() << name << "failed";
+		return false;
+	}
+
+	BenchmarkResult r(name, amount, unit);
+	QElapsedTimer dt;
+
+	for (int idx = 0; idx < mNumRuns; idx++) {
+		dt.start();
+		bool ok = kernel();
+		r.addTime(dt.nsecsElapsed() / 1e6);
+
+		if (!ok) {
+			qWarning() << name << "failed in run" << idx + 1;
+			return false;
+		}
+	}
+
+	qInfo().noquote() << r.toString();
+	mResults << r;
+
+	return true;
+}
+
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#include <functional>
+
+// Qt defines
+
+namespace rdf {
+
+// read defines
+
+/// <summary>
+/// Timings of a single benchmark kernel.
+/// The throughput is given in unit per second
+/// where amount is the work done in one run
+/// (e.g. mega pixels of the page).
+/// </summary>
+class BenchmarkResult {
+
+public:
+	BenchmarkResult(const QString& name = QString(), double amount = 0.0, const QString& unit = "MP");
+
+	bool isEmpty() const;
+
+	QString name() const;
+	QString unit() const;
+
+	void addTime(double ms);
+	QVector<double> times() const;
+
+	double median() const;
+	double p95() const;
+	double min() const;
+	double throughput() const;
+
+	QJsonObject toJson() const;
+	static BenchmarkResult fromJson(const QJsonObject& jo);
+	QString toString() const;
+
+private:
+	QString mName;
+	QString mUnit;
+	double mAmount = 0.0;
+	QVector<double> mTimes;		// ms
+
+	double percentile(double p) const;
+};
+
+/// <summary>
+/// Benchmarks the hot kernels of the framework
+/// on a deterministic synthetic document.
+/// Each kernel is warmed up once and then timed numRuns times.
+/// Results can be written to JSON and compared against a baseline.
+/// </summary>
+class Benchmark {
+
+public:
+	Benchmark(const cv::Size& pageSize = cv::Size(1240, 1754), int numRuns = 10);
+
+	void setNumRuns(int numRuns);
+	void setKernels(const QStringList& kernels);
+	static QStringList kernelNames();
+
+	bool run();
+	QVector<BenchmarkResult> results() const;
+
+	QJsonObject toJson() const;
+	bool write(const QString& filePath) const;
+	int compare(const QString& baselinePath, double tolerance = 0.1) const;
+
+	static cv::Mat syntheticDocument(const cv::Size& size, double skew = 1.5, int seed = 42);
+	static cv::Mat syntheticLabels(const cv::Size& size, int numLabels, int seed = 42);
+	static bool isReleaseBuild();
+
+private:
+	cv::Size mPageSize;
+	int mNumRuns = 10;
+	QStringList mKernels;
+	QVector<BenchmarkResult> mResults;
+
+	bool isSelected(const QString& name) const;
+	bool measure(const QString& name, double amount, const QString& unit, const std::function<bool()>& kernel);
+};
+
+}
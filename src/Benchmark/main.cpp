@@ -0,0 +1,140 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#include "Utils.h"
+#include "Benchmark.h"
+
+#if defined(_MSC_BUILD) && !defined(QT_NO_DEBUG_OUTPUT) // fixes cmake bug - really release uses subsystem windows, debug and release subsystem console
+#pragma comment (linker, "/SUBSYSTEM:CONSOLE")
+#else
+#pragma comment (linker, "/SUBSYSTEM:WINDOWS")
+#endif
+
+int main(int argc, char** argv) {
+
+	// check opencv version
+	qInfo().nospace() << "I am using OpenCV " << CV_MAJOR_VERSION << "." << CV_MINOR_VERSION << "." << CV_VERSION_REVISION;
+
+	QCoreApplication::setOrganizationName("TU Wien");
+	QCoreApplication::setOrganizationDomain("https://cvl.tuwien.ac.at/");
+	QCoreApplication::setApplicationName("READ Framework");
+	rdf::Utils::instance().initFramework();
+
+	QCoreApplication app(argc, (char**)argv);	// enable headless
+
+	// CMD parser --------------------------------------------------------------------
+	QCommandLineParser parser;
+
+	parser.setApplicationDescription("READ Framework kernel benchmarks.");
+	parser.addHelpOption();
+	parser.addVersionOption();
+
+	// number of runs
+	QCommandLineOption runsOpt(QStringList() << "r" << "runs", QObject::tr("Number of timed runs per kernel."), "number", "10");
+	parser.addOption(runsOpt);
+
+	// page size
+	QCommandLineOption sizeOpt(QStringList() << "s" << "size", QObject::tr("Size of the synthetic page (WxH)."), "size", "1240x1754");
+	parser.addOption(sizeOpt);
+
+	// kernels
+	QCommandLineOption kernelOpt(QStringList() << "k" << "kernels", 
+		QObject::tr("Comma separated list of kernels: %1.").arg(rdf::Benchmark::kernelNames().join(", ")), "kernels");
+	parser.addOption(kernelOpt);
+
+	// threads
+	QCommandLineOption threadsOpt(QStringList() << "j" << "threads", QObject::tr("Number of OpenCV threads (default: all cores)."), "number");
+	parser.addOption(threadsOpt);
+
+	// output
+	QCommandLineOption outputOpt(QStringList() << "o" << "output", QObject::tr("Write the results to a JSON file."), "path");
+	parser.addOption(outputOpt);
+
+	// baseline
+	QCommandLineOption baselineOpt(QStringList() << "b" << "baseline", QObject::tr("Compare the results to a baseline JSON file."), "path");
+	parser.addOption(baselineOpt);
+
+	// tolerance
+	QCommandLineOption toleranceOpt(QStringList() << "tolerance", QObject::tr("Relative slow down that is reported as regression."), "value", "0.1");
+	parser.addOption(toleranceOpt);
+
+	parser.process(*QCoreApplication::instance());
+	// CMD parser --------------------------------------------------------------------
+
+	if (!rdf::Benchmark::isReleaseBuild())
+		qWarning() << "this is not an optimized build - timings are not representative";
+
+	QStringList sl = parser.value(sizeOpt).split("x");
+	cv::Size pageSize(sl.first().toInt(), sl.last().toInt());
+
+	if (sl.size() != 2 || pageSize.width <= 0 || pageSize.height <= 0) {
+		qWarning() << "illegal page size:" << parser.value(sizeOpt);
+		return 1;
+	}
+
+	if (parser.isSet(threadsOpt))
+		cv::setNumThreads(parser.value(threadsOpt).toInt());
+
+	rdf::Benchmark bm(pageSize);
+	bm.setNumRuns(parser.value(runsOpt).toInt());
+
+	if (parser.isSet(kernelOpt))
+		bm.setKernels(parser.value(kernelOpt).split(",", QString::SkipEmptyParts));
+
+	if (!bm.run())
+		return 1;	// fail the benchmark
+
+	if (parser.isSet(outputOpt) && !bm.write(parser.value(outputOpt)))
+		return 1;
+
+	if (parser.isSet(baselineOpt)) {
+
+		int numRegressions = bm.compare(parser.value(baselineOpt), parser.value(toleranceOpt).toDouble());
+
+		if (numRegressions < 0)
+			return 1;
+
+		if (numRegressions > 0) {
+			qWarning() << numRegressions << "kernel(s) regressed";
+			return 1;	// fail the benchmark
+		}
+	}
+
+	return 0;	// thanks
+}
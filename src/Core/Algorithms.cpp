@@ -300,6 +300,87 @@ double LineFitting::medianResiduals(const QVector<Vector2D>& pts, const Line & l
 	return Algorithms::statMoment(squaredDists, 0.5);
 }
 
+// DisjointSet --------------------------------------------------------------------
+DisjointSet::DisjointSet(int size) {
+
+	mParent.resize(size);
+	mSize.fill(1, size);
+
+	for (int idx = 0; idx < size; idx++)
+		mParent[idx] = idx;
+}
+
+int DisjointSet::size() const {
+	return mParent.size();
+}
+
+/// <summary>
+/// Returns the representative of idx's set.
+/// </summary>
+/// <param name="idx">The element index.</param>
+/// <returns></returns>
+int DisjointSet::find(int idx) {
+
+	assert(idx >= 0 && idx < mParent.size());
+
+	// path halving
+	while (mParent[idx] != idx) {
+		mParent[idx] = mParent[mParent[idx]];
+		idx = mParent[idx];
+	}
+
+	return idx;
+}
+
+/// <summary>
+/// Merges the sets of idx1 and idx2.
+/// </summary>
+/// <param name="idx1">The first element index.</param>
+/// <param name="idx2">The second element index.</param>
+/// <returns>false if both elements are already in the same set.</returns>
+bool DisjointSet::unite(int idx1, int idx2) {
+
+	int r1 = find(idx1);
+	int r2 = find(idx2);
+
+	if (r1 == r2)
+		return false;
+
+	// union by size
+	if (mSize[r1] < mSize[r2])
+		std::swap(r1, r2);
+
+	mParent[r2] = r1;
+	mSize[r1] += mSize[r2];
+
+	return true;
+}
+
+/// <summary>
+/// Returns a set label for each element.
+/// Labels are dense [0 #sets) and numbered in order
+/// of the first element of each set (deterministic).
+/// </summary>
+/// <returns></returns>
+QVector<int> DisjointSet::labels() {
+
+	QVector<int> labels(mParent.size(), -1);
+	QVector<int> rootLabels(mParent.size(), -1);
+	int numSets = 0;
+
+	for (int idx = 0; idx < mParent.size(); idx++) {
+
+		int root = find(idx);
+
+		if (rootLabels[root] == -1)
+			rootLabels[root] = numSets++;
+
+		labels[idx] = rootLabels[root];
+	}
+
+	return labels;
+}
+
 // Pixel Distances --------------------------------------------------------------------
 /// <summary>
 /// Euclidean distance between the pixel's centers.
@@ -153,6 +153,27 @@ protected:
 	double medianResiduals(const QVector<Vector2D>& pts, const Line& line) const;
 };
 
+/// <summary>
+/// Disjoint-set forest (union-find) over dense indexes [0 size).
+/// Uses union by size and path halving, hence
+/// operations run in nearly constant (amortized) time.
+/// </summary>
+class DllCoreExport DisjointSet {
+
+public:
+	DisjointSet(int size = 0);
+
+	int size() const;
+	int find(int idx);
+	bool unite(int idx1, int idx2);
+
+	QVector<int> labels();
+
+protected:
+	QVector<int> mParent;
+	QVector<int> mSize;
+};
+
 // pixel distance functions
 namespace PixelDistance {
 	DllCoreExport double euclidean(const Pixel* px1, const Pixel* px2);
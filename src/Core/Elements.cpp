@@ -41,6 +41,8 @@
 #include <QXmlStreamReader>
 #include <QUuid>
 #include <QPainter>
+#include <algorithm>
+#include <cmath>
 #pragma warning(pop)
 
 namespace rdf {
@@ -56,6 +58,15 @@ Region::Region(const Type& type, const QString& id) {
 	mType = type;
 }
 
+Region::~Region() {
+
+	// release the back references of our children
+	for (auto c : mChildren) {
+		if (c && c->mParent.region == this)
+			c->mParent.region = 0;
+	}
+}
+
 /// <summary>
 /// Writes the Region r to the data stream s
 /// </summary>
@@ -119,6 +130,7 @@ Region::Type Region::type() const {
 /// <param name="id">A unique identifier.</param>
 void Region::setId(const QString & id) {
 	mId = id;
+	invalidateIndex();
 }
 
 /// <summary>
@@ -144,6 +156,7 @@ QString Region::custom() const {
 /// <param name="polygon">A polygon that represents the Region.</param>
 void Region::setPolygon(const Polygon & polygon) {
 	mPoly = polygon;
+	invalidateIndex();
 }
 
 /// <summary>
@@ -156,6 +169,7 @@ Polygon Region::polygon() const {
 
 void Region::scaleRegion(double scale) {
 	mPoly.scale(scale);
+	invalidateIndex();
 }
 
 /// <summary>
@@ -193,6 +207,8 @@ void Region::draw(QPainter& p, const RegionTypeConfig& config) const {
 /// <param name="child">The child region.</param>
 void Region::addChild(QSharedPointer<Region> child) {
 	mChildren.append(child);
+	linkChild(child);
+	invalidateIndex();
 }
 
 /// <summary>
@@ -270,9 +286,13 @@ void Region::addUniqueChild(QSharedPointer<Region> child, bool update) {
 	}
 
 	if (childIdx == -1)
-		mChildren.append(child);
-	else if (update)
+		addChild(child);
+	else if (update) {
+		unlinkChild(mChildren[childIdx]);
 		mChildren.replace(childIdx, child);	// update
+		linkChild(child);
+		invalidateIndex();
+	}
 }
 
 /// <summary>
@@ -283,14 +303,17 @@ void Region::removeChild(QSharedPointer<Region> child) {
 	
 	int idx = mChildren.indexOf(child);
 	
-	if (idx != -1)
+	if (idx != -1) {
 		mChildren.remove(idx);
+		unlinkChild(child);
+		invalidateIndex();
+	}
 	else
 		qWarning() << "cannot remove" << child;
 }
 
 void Region::removeAllChildren() {
-	mChildren.clear();
+	setChildren(QVector<QSharedPointer<Region> >());
 }
 
 /// <summary>
@@ -298,7 +321,16 @@ void Region::removeAllChildren() {
 /// </summary>
 /// <param name="children">The child regions.</param>
 void Region::setChildren(const QVector<QSharedPointer<Region>>& children) {
+
+	for (auto c : mChildren)
+		unlinkChild(c);
+
 	mChildren = children;
+
+	for (auto c : mChildren)
+		linkChild(c);
+
+	invalidateIndex();
 }
 
 /// <summary>
@@ -353,6 +385,36 @@ void Region::collectRegions(QVector<QSharedPointer<Region> >& regions, const Reg
 		c->collectRegions(regions, type);
 }
 
+void Region::linkChild(const QSharedPointer<Region>& child) {
+
+	if (child)
+		child->mParent.region = this;
+}
+
+void Region::unlinkChild(const QSharedPointer<Region>& child) {
+
+	if (child && child->mParent.region == this)
+		child->mParent.region = 0;
+}
+
+/// <summary>
+/// Notifies the RootRegion (if any) that its index is outdated.
+/// Needs to be called whenever the polygon, ID or children change.
+/// </summary>
+void Region::invalidateIndex() const {
+
+	const Region* r = this;
+	while (r->mParent.region)
+		r = r->mParent.region;
+
+	if (r->type() != type_root)
+		return;
+
+	const RootRegion* root = dynamic_cast<const RootRegion*>(r);
+	if (root && !root->mIndexLocked)
+		root->mIndex.invalidate();
+}
+
 /// <summary>
 /// Returns a string discribing the Region.
 /// </summary>
@@ -397,18 +459,19 @@ bool Region::read(QXmlStreamReader & reader) {
 	RegionXmlHelper& rm = RegionXmlHelper::instance();
 
 	// append children?!
-	if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_coords)) {
+	if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_coords)) {
 		
-		QString pts = reader.attributes().value(rm.tag(RegionXmlHelper::attr_points)).toString();
+		QStringRef pts = reader.attributes().value(rm.tag(RegionXmlHelper::attr_points));
 		if (!pts.isEmpty()) {
 			mPoly.read(pts);
+			invalidateIndex();
 		}
 		// fallback to old point coordinates
 		else {
 			readPoints(reader);
 		}
 	}
-	//else if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_coords)) {
+	//else if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_coords)) {
 
 	//}
 	else if (reader.tokenType() == QXmlStreamReader::StartElement)
@@ -431,11 +494,11 @@ bool Region::readPoints(QXmlStreamReader & reader) {
 	while (!reader.atEnd()) {
 		reader.readNext();
 
-		if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_point)) {
+		if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_point)) {
 			
 			// parse x
 			bool ok = false;
-			QString str = reader.attributes().value("x").toString();
+			QStringRef str = reader.attributes().value("x");
 			int x = str.toInt(&ok);
 
 			if (!ok) {
@@ -444,7 +507,7 @@ bool Region::readPoints(QXmlStreamReader & reader) {
 			}
 
 			// parse y
-			str = reader.attributes().value("y").toString();
+			str = reader.attributes().value("y");
 			int y = str.toInt(&ok);
 
 			if (!ok) {
@@ -456,12 +519,13 @@ bool Region::readPoints(QXmlStreamReader & reader) {
 		}
 
 		// are we done?
-		if (reader.tokenType() == QXmlStreamReader::EndElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_coords))
+		if (reader.tokenType() == QXmlStreamReader::EndElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_coords))
 			break;
 
 	}
 
 	mPoly.setPolygon(poly);
+	invalidateIndex();
 
 	return !poly.isEmpty();
 }
@@ -686,8 +750,8 @@ bool TextLine::read(QXmlStreamReader & reader) {
 		mTextEquiv = TextEquiv::read(reader);
 	}
 	// read baseline
-	else if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_baseline)) {
-		mBaseLine.read(reader.attributes().value(rm.tag(RegionXmlHelper::attr_points)).toString());
+	else if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_baseline)) {
+		mBaseLine.read(reader.attributes().value(rm.tag(RegionXmlHelper::attr_points)));
 	}
 	else
 		return Region::read(reader);
@@ -1579,7 +1643,7 @@ bool TableCell::read(QXmlStreamReader & reader) {
 
 	RegionXmlHelper& rm = RegionXmlHelper::instance();
 
-	if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName().toString() == rm.tag(RegionXmlHelper::tag_cornerpts)) {
+	if (reader.tokenType() == QXmlStreamReader::StartElement && reader.qualifiedName() == rm.tag(RegionXmlHelper::tag_cornerpts)) {
 
 		reader.readNext();
 		QString pts = reader.text().toUtf8().trimmed();	// add text
@@ -1769,7 +1833,7 @@ void LayerElement::readChildren(QXmlStreamReader & reader) {
 	while (!reader.atEnd()) {
 
 		reader.readNext();
-		QString tag = reader.qualifiedName().toString();
+		QStringRef tag = reader.qualifiedName();
 
 		if (reader.tokenType() == QXmlStreamReader::EndElement && tag == "Layer") {
 			break;
@@ -1845,6 +1909,437 @@ QVector<QSharedPointer<Region>> LayerElement::regions() const {
 	return mRegions;
 }
 
+// RegionIndex --------------------------------------------------------------------
+namespace {
+
+	const int nodeCapacity = 16;	// max number of items/children per R-tree node
+
+	/// <summary>
+	/// Inclusive rectangle intersection.
+	/// In contrast to QRectF::intersects degenerated (e.g. separator)
+	/// boxes and touching boxes intersect.
+	/// </summary>
+	bool overlaps(const QRectF& r1, const QRectF& r2) {
+		return r1.left() <= r2.right() && r2.left() <= r1.right() &&
+			r1.top() <= r2.bottom() && r2.top() <= r1.bottom();
+	}
+
+	/// <summary>
+	/// Sort-tile-recursive ordering of the ids.
+	/// Consecutive blocks of capacity ids are spatially close.
+	/// </summary>
+	template <typename BoxFunc>
+	void sortTiles(QVector<int>& ids, BoxFunc box, int capacity) {
+
+		int n = ids.size();
+		int numPages = (n + capacity - 1) / capacity;
+		int numSlices = (int)std::ceil(std::sqrt((double)numPages));
+		int sliceSize = numSlices * capacity;
+
+		std::sort(ids.begin(), ids.end(), [&](int i1, int i2) {
+			return box(i1).center().x() < box(i2).center().x();
+		});
+
+		for (int idx = 0; idx < n; idx += sliceSize) {
+			std::sort(ids.begin() + idx, ids.begin() + qMin(idx + sliceSize, n), [&](int i1, int i2) {
+				return box(i1).center().y() < box(i2).center().y();
+			});
+		}
+	}
+}
+
+RegionIndex::RegionIndex() {
+}
+
+/// <summary>
+/// The index is a cache of a specific region tree.
+/// Hence, copies are empty and need to be rebuilt.
+/// </summary>
+RegionIndex::RegionIndex(const RegionIndex&) {
+}
+
+RegionIndex& RegionIndex::operator=(const RegionIndex&) {
+	
+	invalidate();
+	return *this;
+}
+
+bool RegionIndex::isValid() const {
+	return mValid;
+}
+
+/// <summary>
+/// Clears the index so that it needs to be rebuilt.
+/// </summary>
+void RegionIndex::invalidate() {
+
+	if (!mValid && mEntries.isEmpty())
+		return;
+
+	mEntries.clear();
+	mIds.clear();
+	mEntryIdx.clear();
+	mNodes.clear();
+	mItems.clear();
+	mPending.clear();
+	mNumRemoved = 0;
+	mNextRank = 0;
+	mValid = false;
+}
+
+/// <summary>
+/// Number of regions in the index.
+/// </summary>
+int RegionIndex::size() const {
+	return mEntries.size() - mNumRemoved;
+}
+
+/// <summary>
+/// Indexes all regions below root.
+/// </summary>
+/// <param name="root">The root region.</param>
+void RegionIndex::rebuild(const Region* root) {
+
+	invalidate();
+
+	if (root)
+		addChildren(root);
+
+	buildTree();
+	mValid = true;
+}
+
+/// <summary>
+/// Adds a region and all its children to the index.
+/// </summary>
+/// <param name="region">The region to be added.</param>
+/// <param name="parent">The region's parent.</param>
+void RegionIndex::insert(QSharedPointer<Region> region, const Region* parent) {
+	insert(region, parent, -1);
+}
+
+/// <summary>
+/// Replaces a region (and its children) with newRegion.
+/// newRegion takes the position of region in query results.
+/// </summary>
+/// <param name="region">The region to be replaced.</param>
+/// <param name="newRegion">The new region.</param>
+/// <param name="parent">The new region's parent.</param>
+void RegionIndex::replace(QSharedPointer<Region> region, QSharedPointer<Region> newRegion, const Region* parent) {
+
+	int rank = -1;
+	auto it = mEntryIdx.find(region.data());
+	if (it != mEntryIdx.end())
+		rank = mEntries[it.value()].rank;
+
+	remove(region);
+	insert(newRegion, parent, rank);
+}
+
+void RegionIndex::insert(const QSharedPointer<Region>& region, const Region* parent, int rank) {
+
+	if (!region)
+		return;
+
+	int first = mEntries.size();
+	add(region, parent, rank);
+	addChildren(region.data());
+
+	for (int idx = first; idx < mEntries.size(); idx++)
+		mPending << idx;
+
+	// the pending list is scanned linearly - merge it into the tree if it becomes too large
+	if (mPending.size() + mNumRemoved > qMax(nodeCapacity, 4 * (int)std::sqrt((double)mEntries.size())))
+		compact();
+}
+
+/// <summary>
+/// Removes a region and all its children from the index.
+/// </summary>
+/// <param name="region">The region to be removed.</param>
+void RegionIndex::remove(QSharedPointer<Region> region) {
+
+	removeEntry(region);
+
+	if (mNumRemoved > qMax(nodeCapacity, mEntries.size() / 2))
+		compact();
+}
+
+/// <summary>
+/// Returns the first region (w.r.t. the result order) with the given ID.
+/// </summary>
+/// <param name="id">The region ID.</param>
+/// <returns>The region or NULL if no region has this ID.</returns>
+QSharedPointer<Region> RegionIndex::find(const QString& id) const {
+
+	int first = -1;
+	for (auto it = mIds.find(id); it != mIds.end() && it.key() == id; it++) {
+		if (first == -1 || mEntries[it.value()].rank < mEntries[first].rank)
+			first = it.value();
+	}
+
+	return first != -1 ? mEntries[first].region : QSharedPointer<Region>();
+}
+
+/// <summary>
+/// Returns all regions that might be equal to region.
+/// These are regions with the same ID or an intersecting bounding box.
+/// </summary>
+/// <param name="region">The region to compare with.</param>
+/// <param name="parent">If not NULL, only direct children of parent are returned.</param>
+QVector<QSharedPointer<Region> > RegionIndex::candidates(const Region& region, const Region* parent) const {
+
+	QVector<int> entries;
+	
+	Polygon poly = region.polygon();
+	if (!poly.isEmpty())
+		entries = query(poly.polygon().boundingRect(), parent);
+
+	QString id = region.id();
+	for (auto it = mIds.find(id); it != mIds.end() && it.key() == id; it++) {
+		if (!parent || mEntries[it.value()].parent == parent)
+			entries << it.value();
+	}
+
+	sortByRank(entries);
+	entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+	return toRegions(entries);
+}
+
+/// <summary>
+/// Returns all regions whose bounding box contains p.
+/// </summary>
+QVector<QSharedPointer<Region> > RegionIndex::regionsAt(const QPointF & p) const {
+	
+	QVector<int> entries = query(QRectF(p, QSizeF(0, 0)), 0);
+	sortByRank(entries);
+
+	return toRegions(entries);
+}
+
+/// <summary>
+/// Returns all regions whose bounding box intersects rect.
+/// </summary>
+/// <param name="rect">The query rectangle.</param>
+/// <param name="parent">If not NULL, only direct children of parent are returned.</param>
+QVector<QSharedPointer<Region> > RegionIndex::regionsIn(const QRectF & rect, const Region* parent) const {
+	
+	QVector<int> entries = query(rect, parent);
+	sortByRank(entries);
+
+	return toRegions(entries);
+}
+
+void RegionIndex::add(const QSharedPointer<Region>& region, const Region* parent, int rank) {
+
+	Entry e;
+	e.region = region;
+	e.parent = parent;
+	e.rank = rank >= 0 ? rank : mNextRank++;
+
+	Polygon poly = region->polygon();
+	if (!poly.isEmpty()) {
+		e.box = poly.polygon().boundingRect();
+		e.hasBox = true;
+	}
+
+	int idx = mEntries.size();
+	mEntries << e;
+	mIds.insert(region->id(), idx);
+	mEntryIdx.insert(region.data(), idx);
+}
+
+void RegionIndex::addChildren(const Region* region) {
+
+	// same order as Region::collectRegions
+	QVector<QSharedPointer<Region> > children = region->children();
+
+	for (auto c : children) {
+		if (c)
+			add(c, region);
+	}
+
+	for (auto c : children) {
+		if (c)
+			addChildren(c.data());
+	}
+}
+
+void RegionIndex::removeEntry(const QSharedPointer<Region>& region) {
+
+	if (!region)
+		return;
+
+	auto it = mEntryIdx.find(region.data());
+	if (it == mEntryIdx.end())
+		return;
+
+	int idx = it.value();
+	mEntryIdx.erase(it);
+
+	Entry& e = mEntries[idx];
+	if (!e.removed) {
+		e.removed = true;
+		mIds.remove(region->id(), idx);
+		mNumRemoved++;
+	}
+
+	for (auto c : region->children())
+		removeEntry(c);
+}
+
+/// <summary>
+/// Drops removed entries and merges pending entries into the tree.
+/// The entry order is preserved.
+/// </summary>
+void RegionIndex::compact() {
+
+	QVector<Entry> entries;
+	entries.reserve(size());
+
+	for (const Entry& e : mEntries) {
+		if (!e.removed)
+			entries << e;
+	}
+
+	mEntries = entries;
+	mIds.clear();
+	mEntryIdx.clear();
+	mNumRemoved = 0;
+
+	for (int idx = 0; idx < mEntries.size(); idx++) {
+		mIds.insert(mEntries[idx].region->id(), idx);
+		mEntryIdx.insert(mEntries[idx].region.data(), idx);
+	}
+
+	buildTree();
+}
+
+void RegionIndex::buildTree() {
+
+	mNodes.clear();
+	mItems.clear();
+	mPending.clear();
+
+	for (int idx = 0; idx < mEntries.size(); idx++) {
+		if (!mEntries[idx].removed && mEntries[idx].hasBox)
+			mItems << idx;
+	}
+
+	if (mItems.isEmpty())
+		return;
+
+	// leaves
+	sortTiles(mItems, [&](int idx) { return mEntries[idx].box; }, nodeCapacity);
+
+	for (int idx = 0; idx < mItems.size(); idx += nodeCapacity) {
+
+		Node n;
+		n.first = idx;
+		n.count = qMin(nodeCapacity, mItems.size() - idx);
+		n.leaf = true;
+		n.box = mEntries[mItems[idx]].box;
+
+		for (int iIdx = idx + 1; iIdx < idx + n.count; iIdx++)
+			n.box = n.box.united(mEntries[mItems[iIdx]].box);
+
+		mNodes << n;
+	}
+
+	// inner nodes - each level is stored contiguously
+	int levelStart = 0;
+	int levelEnd = mNodes.size();
+
+	while (levelEnd - levelStart > 1) {
+
+		QVector<int> ids;
+		for (int idx = levelStart; idx < levelEnd; idx++)
+			ids << idx;
+
+		sortTiles(ids, [&](int idx) { return mNodes[idx].box; }, nodeCapacity);
+
+		QVector<Node> level;
+		for (int idx : ids)
+			level << mNodes[idx];
+
+		for (int idx = 0; idx < level.size(); idx++)
+			mNodes[levelStart + idx] = level[idx];
+
+		for (int idx = 0; idx < level.size(); idx += nodeCapacity) {
+
+			Node n;
+			n.first = levelStart + idx;
+			n.count = qMin(nodeCapacity, level.size() - idx);
+			n.leaf = false;
+			n.box = level[idx].box;
+
+			for (int nIdx = idx + 1; nIdx < idx + n.count; nIdx++)
+				n.box = n.box.united(level[nIdx].box);
+
+			mNodes << n;
+		}
+
+		levelStart = levelEnd;
+		levelEnd = mNodes.size();
+	}
+}
+
+QVector<int> RegionIndex::query(const QRectF & rect, const Region* parent) const {
+
+	QVector<int> entries;
+
+	auto collect = [&](int idx) {
+		const Entry& e = mEntries[idx];
+		if (!e.removed && e.hasBox && (!parent || e.parent == parent) && overlaps(e.box, rect))
+			entries << idx;
+	};
+
+	if (!mNodes.isEmpty()) {
+
+		QVector<int> stack;
+		stack << mNodes.size() - 1;
+
+		while (!stack.isEmpty()) {
+
+			const Node& n = mNodes[stack.takeLast()];
+
+			if (!overlaps(n.box, rect))
+				continue;
+
+			for (int idx = n.first; idx < n.first + n.count; idx++) {
+				if (n.leaf)
+					collect(mItems[idx]);
+				else
+					stack << idx;
+			}
+		}
+	}
+
+	for (int idx : mPending)
+		collect(idx);
+
+	return entries;
+}
+
+QVector<QSharedPointer<Region> > RegionIndex::toRegions(const QVector<int>& entries) const {
+
+	QVector<QSharedPointer<Region> > regions;
+	regions.reserve(entries.size());
+
+	for (int idx : entries)
+		regions << mEntries[idx].region;
+
+	return regions;
+}
+
+void RegionIndex::sortByRank(QVector<int>& entries) const {
+
+	std::sort(entries.begin(), entries.end(), [&](int i1, int i2) {
+		return mEntries[i1].rank < mEntries[i2].rank;
+	});
+}
+
 // RootRegion --------------------------------------------------------------------
 RootRegion::RootRegion(const Type & type) : Region(type) {
 
@@ -1865,4 +2360,130 @@ QVector<QSharedPointer<Region>> RootRegion::filter(const Region::Type & type) co
 	return Region::filter(this, type);
 }
 
+/// <summary>
+/// Reassigns the child w.r.t its ID (see Region::reassignChild).
+/// The region is looked up in the index rather than in all regions.
+/// </summary>
+/// <param name="child">A region that was potentially created from an existing region.</param>
+/// <returns>false if the child cannot be reassigned</returns>
+bool RootRegion::reassignChild(QSharedPointer<Region> child) {
+
+	if (!child) {
+		qWarning() << "reassignChild: child is NULL where it should not be";
+		return false;
+	}
+
+	QSharedPointer<Region> c = find(child->id());
+
+	if (!c)
+		return false;
+
+	// NOTE: currently we delete possible children of c
+	updateChildren(c, child->children());
+	
+	return true;
+}
+
+/// <summary>
+/// Adds the child if it does not exist already (see Region::addUniqueChild).
+/// Only children with the same ID or an intersecting bounding box
+/// are compared with child.
+/// </summary>
+/// <param name="child">The child to append.</param>
+/// <param name="update">if set to <c>true</c>, the existing child is updated.</param>
+void RootRegion::addUniqueChild(QSharedPointer<Region> child, bool update) {
+
+	if (!child) {
+		qWarning() << "addUniqueChild: child is NULL where it should not be";
+		return;
+	}
+
+	QSharedPointer<Region> existing;
+
+	for (auto ci : index().candidates(*child, this)) {
+
+		// see Region::addUniqueChild
+		if (ci->type() != child->type() && ci->id() == child->id() && update) {
+
+			// NOTE: currently we delete possible children of ci
+			updateChildren(ci, child->children());
+			return;
+		}
+
+		if (*ci == *child) {
+			existing = ci;
+			break;
+		}
+	}
+
+	if (!existing) {
+		mIndexLocked = true;
+		addChild(child);
+		mIndexLocked = false;
+		mIndex.insert(child, this);
+	}
+	else if (update) {
+
+		int idx = mChildren.indexOf(existing);
+
+		if (idx == -1) {
+			Region::addUniqueChild(child, update);
+			return;
+		}
+
+		mIndexLocked = true;
+		unlinkChild(existing);
+		mChildren.replace(idx, child);	// update
+		linkChild(child);
+		mIndexLocked = false;
+
+		mIndex.replace(existing, child, this);	// child keeps the position of existing
+	}
+}
+
+/// <summary>
+/// Returns the first region (w.r.t. the index' result order) with the given ID.
+/// </summary>
+/// <param name="id">The region ID.</param>
+/// <returns>The region or NULL if it does not exist.</returns>
+QSharedPointer<Region> RootRegion::find(const QString & id) const {
+	return index().find(id);
+}
+
+/// <summary>
+/// The index of all regions below this root.
+/// It is updated incrementally by reassignChild and addUniqueChild.
+/// Any other change of the region tree invalidates it and the 
+/// index is rebuilt on the next request. The rebuild is guarded
+/// so that a const root can be queried concurrently (as long as
+/// the region tree is not modified at the same time).
+/// </summary>
+const RegionIndex& RootRegion::index() const {
+
+	QMutexLocker lock(mIndexMutex.data());
+
+	if (!mIndex.isValid())
+		mIndex.rebuild(this);
+
+	return mIndex;
+}
+
+void RootRegion::updateChildren(QSharedPointer<Region> region, const QVector<QSharedPointer<Region> >& children) {
+
+	QVector<QSharedPointer<Region> > oldChildren = region->children();
+
+	mIndexLocked = true;
+	region->setChildren(children);
+	mIndexLocked = false;
+
+	if (!mIndex.isValid())
+		return;
+
+	for (auto c : oldChildren)
+		mIndex.remove(c);
+
+	for (auto c : children)
+		mIndex.insert(c, region.data());
+}
+
 }
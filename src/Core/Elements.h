@@ -39,6 +39,9 @@
 #include <QSharedPointer>
 #include <QPolygon>
 #include <QDateTime>
+#include <QHash>
+#include <QRectF>
+#include <QMutex>
 #pragma warning(pop)
 
 #pragma warning(disable: 4251)	// dll interface warning
@@ -84,6 +87,7 @@ public:
 	};
 
 	Region(const Type& type = Type::type_unknown, const QString& id = "");
+	virtual ~Region();
 
 	friend DllCoreExport QDataStream& operator<<(QDataStream& s, const Region& r);
 	friend DllCoreExport QDebug operator<< (QDebug d, const Region &r);
@@ -108,8 +112,8 @@ public:
 	void scaleRegion(double scale);
 
 	void addChild(QSharedPointer<Region> child);
-	bool reassignChild(QSharedPointer<Region> child);
-	void addUniqueChild(QSharedPointer<Region> child, bool update = false);
+	virtual bool reassignChild(QSharedPointer<Region> child);
+	virtual void addUniqueChild(QSharedPointer<Region> child, bool update = false);
 	void removeChild(QSharedPointer<Region> child);
 	void removeAllChildren();
 	void setChildren(const QVector<QSharedPointer<Region> >& children);
@@ -143,6 +147,93 @@ protected:
 
 	void collectRegions(QVector<QSharedPointer<Region> >& allRegions, const Region::Type& type = type_unknown) const;
 	virtual bool readPoints(QXmlStreamReader& reader);
+
+	void linkChild(const QSharedPointer<Region>& child);
+	void unlinkChild(const QSharedPointer<Region>& child);
+	void invalidateIndex() const;
+
+private:
+	// the parent is a back reference for index updates - it is not copied with the region
+	struct ParentLink {
+		ParentLink() {}
+		ParentLink(const ParentLink&) {}
+		ParentLink& operator=(const ParentLink&) { return *this; }
+
+		Region* region = 0;
+	};
+
+	ParentLink mParent;
+};
+
+/// <summary>
+/// Spatial and ID index of a region tree.
+/// Regions are hashed by their ID and their bounding boxes
+/// are stored in a packed R-tree (sort-tile-recursive).
+/// Inserted regions are kept in a pending list which is
+/// merged into the tree once it becomes too large.
+/// Query results are ordered like Region::allRegions() after a
+/// rebuild. Incremental updates keep the order of siblings
+/// (replaced regions keep their position), but inserted regions
+/// are ranked after all regions that are indexed already.
+/// </summary>
+class DllCoreExport RegionIndex {
+
+public:
+	RegionIndex();
+	RegionIndex(const RegionIndex& index);
+	RegionIndex& operator=(const RegionIndex& index);
+
+	bool isValid() const;
+	void invalidate();
+	int size() const;
+
+	void rebuild(const Region* root);
+	void insert(QSharedPointer<Region> region, const Region* parent);
+	void replace(QSharedPointer<Region> region, QSharedPointer<Region> newRegion, const Region* parent);
+	void remove(QSharedPointer<Region> region);
+
+	QSharedPointer<Region> find(const QString& id) const;
+	QVector<QSharedPointer<Region> > candidates(const Region& region, const Region* parent = 0) const;
+	QVector<QSharedPointer<Region> > regionsAt(const QPointF& p) const;
+	QVector<QSharedPointer<Region> > regionsIn(const QRectF& rect, const Region* parent = 0) const;
+
+private:
+	struct Entry {
+		QSharedPointer<Region> region;
+		const Region* parent = 0;
+		QRectF box;
+		int rank = 0;		// result order (see Region::allRegions())
+		bool hasBox = false;
+		bool removed = false;
+	};
+
+	struct Node {
+		QRectF box;
+		int first = 0;		// first item (leaf) or child node
+		int count = 0;
+		bool leaf = true;
+	};
+
+	QVector<Entry> mEntries;
+	QMultiHash<QString, int> mIds;
+	QHash<const Region*, int> mEntryIdx;
+
+	QVector<Node> mNodes;		// packed R-tree, the root is the last node
+	QVector<int> mItems;		// entry indexes in leaf order
+	QVector<int> mPending;		// entries that are not in the tree yet
+	int mNumRemoved = 0;
+	int mNextRank = 0;
+	bool mValid = false;
+
+	void insert(const QSharedPointer<Region>& region, const Region* parent, int rank);
+	void add(const QSharedPointer<Region>& region, const Region* parent, int rank = -1);
+	void addChildren(const Region* region);
+	void removeEntry(const QSharedPointer<Region>& region);
+	void compact();
+	void buildTree();
+	QVector<int> query(const QRectF& rect, const Region* parent) const;
+	QVector<QSharedPointer<Region> > toRegions(const QVector<int>& entries) const;
+	void sortByRank(QVector<int>& entries) const;
 };
 
 class DllCoreExport RootRegion : public Region {
@@ -154,6 +245,20 @@ public:
 	QVector<QSharedPointer<Region> > allRegions() const;
 	QVector<QSharedPointer<Region> > filter(const Region::Type& type) const;
 
+	virtual bool reassignChild(QSharedPointer<Region> child) override;
+	virtual void addUniqueChild(QSharedPointer<Region> child, bool update = false) override;
+
+	QSharedPointer<Region> find(const QString& id) const;
+	const RegionIndex& index() const;
+
+private:
+	friend class Region;
+
+	mutable RegionIndex mIndex;
+	QSharedPointer<QMutex> mIndexMutex = QSharedPointer<QMutex>(new QMutex());	// guards the on demand rebuild
+	bool mIndexLocked = false;		// true while the root updates its index itself
+
+	void updateChildren(QSharedPointer<Region> region, const QVector<QSharedPointer<Region> >& children);
 };
 
 class DllCoreExport TableRegion : public Region {
@@ -175,12 +175,29 @@ QStringList RegionXmlHelper::createTags() const {
 
 	QStringList tn;
 	for (int idx = 0; idx < XmlTags::tag_end; idx++)
-		tn.append(tag((XmlTags) idx));
+		tn.append(createTag((XmlTags) idx));
 
 	return tn;
 }
 
-QString RegionXmlHelper::tag(const XmlTags& tagId) const {
+/// <summary>
+/// Returns the (cached) XML tag.
+/// The tags are created once so that the
+/// parsers do not allocate a string per comparison.
+/// </summary>
+/// <param name="tagId">The tag identifier.</param>
+/// <returns></returns>
+const QString& RegionXmlHelper::tag(const XmlTags& tagId) const {
+
+	if (tagId >= 0 && tagId < mTags.size())
+		return mTags[tagId];
+
+	static const QString empty;
+	qWarning() << "unknown tag: " << tagId;
+	return empty;
+}
+
+QString RegionXmlHelper::createTag(const XmlTags& tagId) const {
 
 	switch (tagId) {
 	case tag_coords:		return "Coords";
@@ -304,6 +321,16 @@ bool RegionManager::isValidTypeName(const QString & typeName) const {
 	return mTypeNames.contains(typeName);
 }
 
+bool RegionManager::isValidTypeName(const QStringRef & typeName) const {
+
+	for (const QString& tn : mTypeNames) {
+		if (typeName == tn)
+			return true;
+	}
+
+	return false;
+}
+
 QSharedPointer<Region> RegionManager::createRegion(const Region::Type & type) const {
 
 	switch (type) {
@@ -395,7 +422,9 @@ QVector<QSharedPointer<rdf::Region> > RegionManager::regionsAt(
 	if (!root)
 		return sRegions;
 
-	QVector<QSharedPointer<Region> > regions = rdf::Region::allRegions(root.data());
+	// only regions whose bounding box contains p need to be tested
+	QSharedPointer<RootRegion> rr = root.dynamicCast<RootRegion>();
+	QVector<QSharedPointer<Region> > regions = rr ? rr->index().regionsAt(p) : rdf::Region::allRegions(root.data());
 
 	for (auto r : regions) {
 
@@ -431,4 +460,16 @@ Region::Type RegionManager::type(const QString& typeName) const {
 	return Region::type_unknown;
 }
 
+Region::Type RegionManager::type(const QStringRef & typeName) const {
+
+	for (int idx = 0; idx < mTypeNames.size(); idx++) {
+		if (typeName == mTypeNames[idx])
+			return (Region::Type) idx;
+	}
+
+	qWarning() << "Unknown type: " << typeName;
+
+	return Region::type_unknown;
+}
+
 }
@@ -133,12 +133,13 @@ public:
 		tag_end
 	};
 
-	QString tag(const XmlTags& tagId) const;
+	const QString& tag(const XmlTags& tagId) const;
 
 private:
 	RegionXmlHelper();
 	RegionXmlHelper(const RegionXmlHelper&);
 
+	QString createTag(const XmlTags& tagId) const;
 	QStringList createTags() const;
 	QStringList mTags;
 };
@@ -149,9 +150,11 @@ public:
 	static RegionManager& instance();
 
 	Region::Type type(const QString& typeName) const;
+	Region::Type type(const QStringRef& typeName) const;
 	QString typeName(const Region::Type& type) const;
 	QStringList typeNames() const;
 	bool isValidTypeName(const QString& typeName) const;
+	bool isValidTypeName(const QStringRef& typeName) const;
 
 	QSharedPointer<Region> createRegion(
 		const Region::Type& type) const;
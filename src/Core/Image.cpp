@@ -35,15 +35,21 @@
 #include "Shapes.h"
 #include "Utils.h"
 #include "Network.h"
+#include "ScaleFactory.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QImageReader>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QPainter>
 #include <QUrl>
 #include <QDir>
+#include <QDataStream>
+#include <QJsonObject>
 
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
@@ -409,8 +415,25 @@ cv::Mat Image::jsonToMat(const QJsonObject & jo, const QString& filePath) {
 		return cv::Mat();
 	}
 
+	// is the data stored in a binary container?
+	if (jo.contains("offset")) {
+
+		cv::Mat img = MatFile::read(jo, filePath);
+
+		if (!img.empty() && (img.rows != rows || img.cols != cols || img.type() != type)) {
+			qCritical() << "illegal cv::Mat dimensions in binary container";
+			return cv::Mat();
+		}
+
+		// fall back to embedded data (if any)
+		if (!img.empty() || jo.value("data").toString().isEmpty())
+			return img;
+
+		qInfo() << "reading embedded data instead of the binary container";
+	}
+
 	QByteArray ba;
-	QString fileName = jo.value("fileName").toString("");
+	QString fileName = jo.contains("offset") ? "" : jo.value("fileName").toString("");
 
 	// is the data embedded? (NOTE: only up to 40 MB)
 	if (fileName.isEmpty()) {
@@ -446,6 +469,492 @@ cv::Mat Image::jsonToMat(const QJsonObject & jo, const QString& filePath) {
 	return img;
 }
 
+// MatFile --------------------------------------------------------------------
+namespace {
+	const quint32 matFileMagic = 0x4d464452;	// RDFM
+	const quint16 matFileVersion = 1;
+	const int matFileAlignment = 64;			// header size & data alignment
+	const int matFileChunkSize = 1 << 24;		// compressed chunks (16 MB)
+	const quint16 matFileCompressed = 0x1;
+}
+
+MatFile::MatFile(const QString & filePath) : mFile(filePath) {
+}
+
+MatFile::~MatFile() {
+	close();
+}
+
+/// <summary>
+/// Opens the container.
+/// Use QIODevice::WriteOnly to create a new container
+/// and QIODevice::ReadOnly to read blocks.
+/// </summary>
+/// <param name="mode">The open mode.</param>
+/// <returns>true if the file could be opened.</returns>
+bool MatFile::open(QIODevice::OpenMode mode) {
+
+	close();
+
+	if (mode & QIODevice::WriteOnly)
+		mode |= QIODevice::Truncate;
+
+	if (!mFile.open(mode)) {
+		qCritical() << "cannot open" << mFile.fileName() << mFile.errorString();
+		return false;
+	}
+
+	return true;
+}
+
+bool MatFile::isOpen() const {
+	return mFile.isOpen();
+}
+
+void MatFile::close() {
+
+	if (mFile.isOpen())
+		mFile.close();
+}
+
+QString MatFile::filePath() const {
+	return mFile.fileName();
+}
+
+/// <summary>
+/// Appends a matrix to the container.
+/// </summary>
+/// <param name="img">The matrix.</param>
+/// <param name="compress">If true, the data is compressed (fast zlib level).</param>
+/// <returns>The meta data (rows, cols, type, fileName, offset) which can be stored in a JSON.</returns>
+QJsonObject MatFile::append(const cv::Mat & img, bool compress) {
+
+	if (!mFile.isOpen() || !mFile.isWritable()) {
+		qCritical() << "cannot append to" << mFile.fileName() << "- it is not opened for writing";
+		return QJsonObject();
+	}
+
+	cv::Mat data = img.isContinuous() ? img : img.clone();
+	quint64 numBytes = (quint64)data.total() * data.elemSize();
+	quint64 dataSize = numBytes;
+
+	// compress in independent chunks so that reading never needs the full compressed block
+	QVector<QByteArray> chunks;
+	if (compress) {
+		dataSize = 0;
+		for (quint64 idx = 0; idx < numBytes; idx += matFileChunkSize) {
+			int len = (int)qMin<quint64>(matFileChunkSize, numBytes - idx);
+			chunks << qCompress(data.ptr<uchar>() + idx, len, 1);
+			dataSize += sizeof(quint32) + chunks.last().size();
+		}
+	}
+
+	qint64 offset = mFile.pos();
+
+	QDataStream ds(&mFile);
+	ds.setByteOrder(QDataStream::LittleEndian);
+	ds << matFileMagic << matFileVersion << (quint16)(compress ? matFileCompressed : 0);
+	ds << (qint32)data.type() << (qint32)data.rows << (qint32)data.cols << (qint32)0;
+	ds << dataSize;
+
+	bool ok = writePadding();
+
+	if (compress) {
+		for (const QByteArray& c : chunks) {
+			ds << (quint32)c.size();
+			ok &= mFile.write(c) == c.size();
+		}
+	}
+	else if (dataSize > 0)
+		ok &= mFile.write(data.ptr<const char>(), (qint64)dataSize) == (qint64)dataSize;
+
+	ok &= writePadding();
+
+	if (!ok || ds.status() != QDataStream::Ok) {
+		qCritical() << "could not write data to" << mFile.fileName();
+		return QJsonObject();
+	}
+
+	QJsonObject jo;
+	jo.insert("rows", img.rows);
+	jo.insert("cols", img.cols);
+	jo.insert("type", img.type());
+	jo.insert("compressed", compress);
+	jo.insert("fileName", QFileInfo(mFile.fileName()).fileName());
+	jo.insert("offset", (double)offset);	// JSON numbers are exact up to 2^53
+
+	return jo;
+}
+
+/// <summary>
+/// Reads the matrix stored at offset.
+/// The data is read directly into the matrix' buffer.
+/// </summary>
+/// <param name="offset">The block's offset (see append()).</param>
+/// <returns>The matrix or an empty matrix if it could not be read.</returns>
+cv::Mat MatFile::read(qint64 offset) {
+
+	Header h;
+	if (!readHeader(offset, h))
+		return cv::Mat();
+
+	cv::Mat img(h.rows, h.cols, h.type);
+	quint64 numBytes = (quint64)img.total() * img.elemSize();
+
+	if (!h.compressed) {
+
+		if (h.size != numBytes || mFile.read(img.ptr<char>(), (qint64)numBytes) != (qint64)numBytes) {
+			qCritical() << "illegal block size when reading cv::Mat from" << mFile.fileName();
+			return cv::Mat();
+		}
+
+		return img;
+	}
+
+	// decode chunk by chunk
+	QDataStream ds(&mFile);
+	ds.setByteOrder(QDataStream::LittleEndian);
+
+	quint64 pos = 0;
+	quint64 consumed = 0;
+	while (consumed < h.size && pos < numBytes) {
+
+		quint32 len = 0;
+		ds >> len;
+		QByteArray chunk = qUncompress(mFile.read(len));
+		consumed += sizeof(quint32) + len;
+
+		if (chunk.isEmpty() || pos + chunk.size() > numBytes) {
+			qCritical() << "corrupted chunk when reading cv::Mat from" << mFile.fileName();
+			return cv::Mat();
+		}
+
+		memcpy(img.ptr<uchar>() + pos, chunk.constData(), chunk.size());
+		pos += chunk.size();
+	}
+
+	if (pos != numBytes) {
+		qCritical() << "illegal block size when reading cv::Mat from" << mFile.fileName();
+		return cv::Mat();
+	}
+
+	return img;
+}
+
+/// <summary>
+/// Reads a matrix from the meta data returned by append().
+/// </summary>
+/// <param name="jo">The meta data.</param>
+/// <param name="dirPath">The directory of the container (if the file name is relative).</param>
+/// <returns></returns>
+cv::Mat MatFile::read(const QJsonObject & jo, const QString & dirPath) {
+
+	QString fileName = jo.value("fileName").toString();
+	qint64 offset = (qint64)jo.value("offset").toDouble(-1);
+
+	if (fileName.isEmpty() || offset < 0) {
+		qWarning() << "cannot read mat - no binary container specified";
+		return cv::Mat();
+	}
+
+	QFileInfo fi(QDir(dirPath), fileName);
+	if (!fi.exists()) {
+		qCritical() << "binary container" << fi.absoluteFilePath() << "is missing - it has to be next to its JSON file";
+		return cv::Mat();
+	}
+
+	MatFile mf(fi.absoluteFilePath());
+	if (!mf.open(QIODevice::ReadOnly))
+		return cv::Mat();
+
+	return mf.read(offset);
+}
+
+/// <summary>
+/// The default file suffix of binary containers.
+/// </summary>
+/// <returns></returns>
+QString MatFile::suffix() {
+	return "rdfb";
+}
+
+/// <summary>
+/// Payloads (in bytes) below this limit are embedded in the JSON.
+/// Base64 adds 33%, so embedded payloads stay well below the
+/// JSON document size limit (~40 MB).
+/// </summary>
+/// <returns></returns>
+quint64 MatFile::embedLimit() {
+	return 16 << 20;
+}
+
+bool MatFile::readHeader(qint64 offset, Header & header) {
+
+	if (!mFile.isOpen() || !mFile.isReadable()) {
+		qCritical() << "cannot read from" << mFile.fileName() << "- it is not opened for reading";
+		return false;
+	}
+
+	if (!mFile.seek(offset)) {
+		qCritical() << "illegal offset" << offset << "in" << mFile.fileName();
+		return false;
+	}
+
+	QDataStream ds(&mFile);
+	ds.setByteOrder(QDataStream::LittleEndian);
+
+	quint32 magic = 0;
+	quint16 version = 0, flags = 0;
+	qint32 type = -1, rows = 0, cols = 0, reserved = 0;
+	quint64 size = 0;
+
+	ds >> magic >> version >> flags >> type >> rows >> cols >> reserved >> size;
+
+	if (ds.status() != QDataStream::Ok || magic != matFileMagic || version > matFileVersion) {
+		qCritical() << "no cv::Mat found at" << offset << "in" << mFile.fileName();
+		return false;
+	}
+
+	if (rows < 0 || cols < 0 || type < 0) {
+		qCritical() << "illegal cv::Mat header at" << offset << "in" << mFile.fileName();
+		return false;
+	}
+
+	header.type = type;
+	header.rows = rows;
+	header.cols = cols;
+	header.compressed = (flags & matFileCompressed) != 0;
+	header.size = size;
+
+	// the data starts after the (aligned) header
+	return mFile.seek(offset + matFileAlignment);
+}
+
+bool MatFile::writePadding() {
+
+	qint64 pad = (matFileAlignment - mFile.pos() % matFileAlignment) % matFileAlignment;
+
+	if (pad > 0)
+		return mFile.write(QByteArray((int)pad, 0)) == pad;
+
+	return true;
+}
+
+// ImageReader --------------------------------------------------------------------
+namespace {
+
+	// cv::Mat type that corresponds to a QImage format (see Image::qImage2Mat)
+	int matType(QImage::Format format) {
+
+		switch (format) {
+		case QImage::Format_ARGB32:
+		case QImage::Format_RGB32:		return CV_8UC4;
+		case QImage::Format_RGB888:		return CV_8UC3;
+		case QImage::Format_Grayscale8:	return CV_8UC1;
+		default:						return -1;
+		}
+	}
+}
+
+ImageReader::ImageReader(const QString & filePath) {
+	mFilePath = filePath;
+}
+
+/// <summary>
+/// Decodes the image.
+/// If scaled is true, the image is decoded with the
+/// ScaleFactory's resolution (see ScaleFactoryConfig::maxImageSide).
+/// </summary>
+/// <param name="scaled">If true, the image is decoded at the processing resolution.</param>
+/// <returns>true if the image was decoded.</returns>
+bool ImageReader::read(bool scaled) {
+
+	rdfProfileScope("decode");
+
+	QElapsedTimer dt;
+	dt.start();
+
+	mImg = cv::Mat();
+	mScaledDecode = false;
+	mZeroCopy = false;
+	mDecodedBytes = 0;
+
+	QImageReader reader(mFilePath);
+	mOriginalSize = reader.size();
+
+	// e.g. urls or decoders that cannot read the header
+	if (!mOriginalSize.isValid())
+		return readFallback(scaled);
+
+	mScaleFactory = QSharedPointer<ScaleFactory>(new ScaleFactory(Vector2D(mOriginalSize.width(), mOriginalSize.height())));
+	double sf = scaled ? mScaleFactory->scaleFactor() : 1.0;
+
+	QSize size = mOriginalSize;
+
+	if (sf != 1.0) {
+		size = QSize(qRound(mOriginalSize.width() * sf), qRound(mOriginalSize.height() * sf));
+
+		if (reader.supportsOption(QImageIOHandler::ScaledSize)) {
+			reader.setScaledSize(size);
+			mScaledDecode = true;
+		}
+	}
+
+	// decode directly into the cv::Mat if the decoder delivers the size & format we need
+	QImage::Format format = reader.imageFormat();
+	int type = matType(format);
+	QImage qImg;
+
+	if (type != -1 && (sf == 1.0 || mScaledDecode)) {
+		mImg = cv::Mat(size.height(), size.width(), type);
+		qImg = QImage(mImg.data, mImg.cols, mImg.rows, (int)mImg.step, format);
+	}
+
+	if (!reader.read(&qImg)) {
+		qWarning().noquote() << "could not decode" << mFilePath << "-" << reader.errorString();
+		mImg = cv::Mat();
+		return false;
+	}
+
+	// the decoder re-allocated the image (or we could not provide a buffer)
+	mZeroCopy = !mImg.empty() && qImg.constBits() == mImg.data && qImg.format() == format;
+
+	if (!mZeroCopy) {
+
+		int qType = matType(qImg.format());
+		cv::Mat dImg = qType != -1 ? 
+			cv::Mat(qImg.height(), qImg.width(), qType, (uchar*)qImg.constBits(), qImg.bytesPerLine()) :
+			Image::qImage2Mat(qImg);
+		mDecodedBytes += qImg.byteCount();
+
+		// the decoder cannot scale - resize directly from the decoded buffer
+		if (dImg.cols != size.width() || dImg.rows != size.height())
+			cv::resize(dImg, mImg, cv::Size(size.width(), size.height()), 0, 0, CV_INTER_AREA);
+		else
+			mImg = qType != -1 ? dImg.clone() : dImg;	// we need to own the pointer
+	}
+	qImg = QImage();
+
+	mDecodedBytes += mImg.total() * mImg.elemSize();
+	mDecodeTime = dt.nsecsElapsed() / 1e6;
+	mPeakMemory = Utils::peakMemory();
+
+	return !mImg.empty();
+}
+
+cv::Mat ImageReader::image() const {
+	return mImg;
+}
+
+/// <summary>
+/// Returns the scale factory of the original image.
+/// Pass it to modules (e.g. LayoutAnalysis::setScaleFactory)
+/// so that results are mapped to the original image size.
+/// </summary>
+QSharedPointer<ScaleFactory> ImageReader::scaleFactory() const {
+	return mScaleFactory;
+}
+
+QSize ImageReader::originalSize() const {
+	return mOriginalSize;
+}
+
+/// <summary>
+/// The decoding time in ms.
+/// </summary>
+double ImageReader::decodeTime() const {
+	return mDecodeTime;
+}
+
+bool ImageReader::isScaledDecode() const {
+	return mScaledDecode;
+}
+
+bool ImageReader::isZeroCopy() const {
+	return mZeroCopy;
+}
+
+/// <summary>
+/// The number of bytes allocated for decoding.
+/// </summary>
+qint64 ImageReader::decodedBytes() const {
+	return mDecodedBytes;
+}
+
+/// <summary>
+/// The peak resident memory of the process (in bytes) after decoding.
+/// </summary>
+qint64 ImageReader::peakMemory() const {
+	return mPeakMemory;
+}
+
+QJsonObject ImageReader::toJson() const {
+
+	QJsonObject jo;
+	jo.insert("image", mFilePath);
+	jo.insert("originalWidth", mOriginalSize.width());
+	jo.insert("originalHeight", mOriginalSize.height());
+	jo.insert("width", mImg.cols);
+	jo.insert("height", mImg.rows);
+	jo.insert("decodeMs", mDecodeTime);
+	jo.insert("scaledDecode", mScaledDecode);
+	jo.insert("zeroCopy", mZeroCopy);
+	jo.insert("decodedMB", mDecodedBytes / (1024.0 * 1024.0));
+	jo.insert("peakMB", mPeakMemory / (1024.0 * 1024.0));
+
+	return jo;
+}
+
+QString ImageReader::toString() const {
+
+	QString msg = QString("%1: %2x%3 decoded to %4x%5 in %6 ms")
+		.arg(QFileInfo(mFilePath).fileName())
+		.arg(mOriginalSize.width()).arg(mOriginalSize.height())
+		.arg(mImg.cols).arg(mImg.rows)
+		.arg(mDecodeTime, 0, 'f', 1);
+
+	msg += mScaledDecode ? " (decoder scaled" : " (full resolution";
+	msg += mZeroCopy ? ", zero copy)" : ")";
+	msg += QString(" buffers: %1 MB, peak memory: %2 MB")
+		.arg(mDecodedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+		.arg(mPeakMemory / (1024.0 * 1024.0), 0, 'f', 1);
+
+	return msg;
+}
+
+/// <summary>
+/// Loads images that QImageReader cannot handle directly (e.g. urls).
+/// The image is decoded at full resolution and resized.
+/// </summary>
+bool ImageReader::readFallback(bool scaled) {
+
+	QElapsedTimer dt;
+	dt.start();
+
+	bool ok = true;
+	QImage qImg = Image::load(mFilePath, &ok);
+
+	if (qImg.isNull()) {
+		qWarning() << "could not load image from" << mFilePath;
+		return false;
+	}
+
+	mOriginalSize = qImg.size();
+	mImg = Image::qImage2Mat(qImg);
+	mDecodedBytes = qImg.byteCount() + mImg.total() * mImg.elemSize();
+	qImg = QImage();
+
+	mScaleFactory = QSharedPointer<ScaleFactory>(new ScaleFactory(mImg.size()));
+
+	if (scaled)
+		mImg = mScaleFactory->scaled(mImg);
+
+	mDecodeTime = dt.nsecsElapsed() / 1e6;
+	mPeakMemory = Utils::peakMemory();
+
+	return !mImg.empty();
+}
+
 // Histogram --------------------------------------------------------------------
 Histogram::Histogram(const cv::Mat & values) {
 	
@@ -39,6 +39,8 @@
 #include <QColor>
 #include <QPen>
 #include <QDebug>
+#include <QFile>
+#include <QVector>
 
 #include <opencv2/core.hpp>
 #pragma warning(pop)
@@ -54,10 +56,100 @@
 #endif
 
 // Qt defines
+class QJsonObject;
 
 namespace rdf {
 
 class Rect;
+class ScaleFactory;
+
+/// <summary>
+/// Binary container for cv::Mat payloads (e.g. feature caches, models).
+/// Each block consists of a 64 byte header (type, rows, cols, flags, size)
+/// followed by the data (64 byte aligned). Blocks are not memory mapped:
+/// uncompressed blocks are read (copied) directly into the matrix' buffer.
+/// Compressed blocks are stored in chunks so that they can be decoded
+/// without holding several copies of the whole matrix in memory.
+/// JSON files only keep the block's meta data (see append()).
+/// Payloads smaller than embedLimit() are embedded in the JSON instead
+/// so that small models remain a single file.
+/// </summary>
+class DllCoreExport MatFile {
+
+public:
+	MatFile(const QString& filePath = QString());
+	~MatFile();
+
+	bool open(QIODevice::OpenMode mode);
+	bool isOpen() const;
+	void close();
+
+	QString filePath() const;
+
+	QJsonObject append(const cv::Mat& img, bool compress = false);
+	cv::Mat read(qint64 offset);
+
+	static cv::Mat read(const QJsonObject& jo, const QString& dirPath);
+	static QString suffix();
+	static quint64 embedLimit();
+
+private:
+	struct Header {
+		int type = -1;
+		int rows = 0;
+		int cols = 0;
+		bool compressed = false;
+		quint64 size = 0;			// size of the data block in bytes
+	};
+
+	bool readHeader(qint64 offset, Header& header);
+	bool writePadding();
+
+	QFile mFile;
+};
+
+/// <summary>
+/// Decodes images at the resolution they are processed with.
+/// The scale factor is computed (ScaleFactory) from the image header
+/// and passed to the decoder (e.g. DCT scaling for JPEGs) so that
+/// large scans are never decoded at full resolution. If the decoder's
+/// output format matches, it decodes directly into the cv::Mat buffer.
+/// Decoders that cannot scale fall back to decoding and resizing.
+/// </summary>
+class DllCoreExport ImageReader {
+
+public:
+	ImageReader(const QString& filePath = QString());
+
+	bool read(bool scaled = true);
+
+	cv::Mat image() const;
+	QSharedPointer<ScaleFactory> scaleFactory() const;
+	QSize originalSize() const;
+
+	double decodeTime() const;
+	bool isScaledDecode() const;
+	bool isZeroCopy() const;
+	qint64 decodedBytes() const;
+	qint64 peakMemory() const;
+
+	QJsonObject toJson() const;
+	QString toString() const;
+
+private:
+	QString mFilePath;
+	cv::Mat mImg;
+	QSharedPointer<ScaleFactory> mScaleFactory;
+	QSize mOriginalSize;
+
+	double mDecodeTime = 0.0;		// ms
+	bool mScaledDecode = false;		// the decoder scaled the image
+	bool mZeroCopy = false;			// the decoder wrote to the cv::Mat
+	qint64 mDecodedBytes = 0;		// size of the decoded buffer(s)
+	qint64 mPeakMemory = 0;			// peak resident memory of the process after decoding
+
+	bool readFallback(bool scaled);
+};
 
 class DllCoreExport Histogram {
 
@@ -298,6 +298,136 @@ QVector<Polygon> IP::maskToPoly(const cv::Mat & src, double scale) {
 	return polys;
 }
 
+/// <summary>
+/// Converts a label image to polygons.
+/// In contrast to calling maskToPoly for each label,
+/// the label image is scanned once: 8-connected components
+/// are labeled (union-find) and only the outer contour of each
+/// component is traced (Suzuki's border following).
+/// Similar to maskToPoly, inner contours (holes) are ignored.
+/// </summary>
+/// <param name="labels">The label image (CV_8UC1 or CV_32SC1).</param>
+/// <param name="numLabels">The number of labels. Polygons of labels outside [0 numLabels) are ignored.</param>
+/// <param name="scale">The scale factor applied to the polygons.</param>
+/// <returns>The polygons of each label (index = label).</returns>
+QVector<QVector<Polygon> > IP::labelsToPolys(const cv::Mat & labels, int numLabels, double scale) {
+
+	QVector<QVector<Polygon> > polys(qMax(numLabels, 0));
+
+	if (labels.empty())
+		return polys;
+
+	if (labels.channels() != 1 || (labels.depth() != CV_8U && labels.depth() != CV_32S)) {
+		qWarning() << "IP::labelsToPolys: CV_8UC1 or CV_32SC1 label image expected";
+		return polys;
+	}
+
+	cv::Mat components;
+	QVector<int> parent;
+	QVector<cv::Point> starts;
+
+	if (labels.depth() == CV_8U)
+		labelComponents<unsigned char>(labels, components, parent, starts);
+	else
+		labelComponents<int>(labels, components, parent, starts);
+
+	for (int idx = 0; idx < parent.size(); idx++) {
+
+		// only roots start a new contour
+		if (parent[idx] != idx)
+			continue;
+
+		const cv::Point& s = starts[idx];
+		int l = labels.depth() == CV_8U ? labels.at<unsigned char>(s) : labels.at<int>(s);
+
+		if (l < 0 || l >= numLabels)
+			continue;
+
+		Polygon p = Polygon::fromCvPoints(traceOuterContour(components, parent, s));
+		if (scale != 1.0)
+			p.scale(scale);
+
+		polys[l] << p;
+	}
+
+	return polys;
+}
+
+std::vector<cv::Point> IP::traceOuterContour(const cv::Mat & components, const QVector<int>& parent, const cv::Point & start) {
+
+	// neighbors in counter-clockwise order (starting east)
+	static const cv::Point dirs[8] = {
+		cv::Point(1, 0), cv::Point(1, -1), cv::Point(0, -1), cv::Point(-1, -1),
+		cv::Point(-1, 0), cv::Point(-1, 1), cv::Point(0, 1), cv::Point(1, 1)
+	};
+
+	int root = parent[components.at<int>(start)];
+	cv::Rect bounds(0, 0, components.cols, components.rows);
+
+	auto inside = [&](const cv::Point& p) {
+		return bounds.contains(p) && parent[components.at<int>(p)] == root;
+	};
+
+	std::vector<cv::Point> pts;
+
+	// search clockwise starting west (the start pixel's west neighbor is never part of the component)
+	int d1 = -1;
+	for (int k = 0; k < 8 && d1 == -1; k++) {
+		int d = (4 - k + 8) & 7;
+		if (inside(start + dirs[d]))
+			d1 = d;
+	}
+
+	// isolated pixel
+	if (d1 == -1) {
+		pts.push_back(start);
+		return pts;
+	}
+
+	const cv::Point p1 = start + dirs[d1];
+	cv::Point p3 = start;
+	int d2 = d1;	// direction from p3 to the previous contour pixel
+
+	while (true) {
+
+		// search counter-clockwise starting after the previous pixel
+		int d4 = d2;
+		for (int k = 1; k <= 8; k++) {
+			int d = (d2 + k) & 7;
+			if (inside(p3 + dirs[d])) {
+				d4 = d;
+				break;
+			}
+		}
+
+		cv::Point p4 = p3 + dirs[d4];
+		pts.push_back(p3);
+
+		if (p4 == start && p3 == p1)
+			break;
+
+		d2 = (d4 + 4) & 7;
+		p3 = p4;
+	}
+
+	// remove points on straight segments (similar to CV_CHAIN_APPROX_SIMPLE)
+	if (pts.size() <= 2)
+		return pts;
+
+	std::vector<cv::Point> simplified;
+	size_t n = pts.size();
+	for (size_t idx = 0; idx < n; idx++) {
+
+		cv::Point dPrev = pts[idx] - pts[(idx + n - 1) % n];
+		cv::Point dNext = pts[(idx + 1) % n] - pts[idx];
+
+		if (dPrev != dNext)
+			simplified.push_back(pts[idx]);
+	}
+
+	return simplified.empty() ? pts : simplified;
+}
+
 /// <summary>
 /// Dilates the image bwImg with a given structuring element.
 /// </summary>
@@ -99,8 +99,71 @@ public:
 	static void normalize(cv::Mat& src);
 
 	static QVector<Polygon> maskToPoly(const cv::Mat& src, double scale);
+	static QVector<QVector<Polygon> > labelsToPolys(const cv::Mat& labels, int numLabels, double scale = 1.0);
 
 private:
+	template<typename lFmt>
+	static void labelComponents(const cv::Mat& labels, cv::Mat& components, QVector<int>& parent, QVector<cv::Point>& starts) {
+
+		components.create(labels.size(), CV_32SC1);
+
+		// union-find: the root is the component's first (top-left) pixel
+		auto find = [&](int idx) {
+			while (parent[idx] != idx) {
+				parent[idx] = parent[parent[idx]];
+				idx = parent[idx];
+			}
+			return idx;
+		};
+
+		auto unite = [&](int idx1, int idx2) {
+			idx1 = find(idx1);
+			idx2 = find(idx2);
+			if (idx1 < idx2)		parent[idx2] = idx1;
+			else if (idx2 < idx1)	parent[idx1] = idx2;
+		};
+
+		for (int rIdx = 0; rIdx < labels.rows; rIdx++) {
+
+			const lFmt* lPtr = labels.ptr<lFmt>(rIdx);
+			const lFmt* lPtrU = rIdx > 0 ? labels.ptr<lFmt>(rIdx - 1) : 0;
+			int* cPtr = components.ptr<int>(rIdx);
+			const int* cPtrU = rIdx > 0 ? components.ptr<int>(rIdx - 1) : 0;
+
+			for (int cIdx = 0; cIdx < labels.cols; cIdx++) {
+
+				lFmt l = lPtr[cIdx];
+				int id = (cIdx > 0 && lPtr[cIdx - 1] == l) ? cPtr[cIdx - 1] : -1;
+
+				// 8-connected neighbors of the previous row
+				for (int nIdx = qMax(cIdx - 1, 0); lPtrU && nIdx <= qMin(cIdx + 1, labels.cols - 1); nIdx++) {
+
+					if (lPtrU[nIdx] != l)
+						continue;
+
+					if (id == -1)
+						id = cPtrU[nIdx];
+					else
+						unite(id, cPtrU[nIdx]);
+				}
+
+				if (id == -1) {
+					id = parent.size();
+					parent << id;
+					starts << cv::Point(cIdx, rIdx);
+				}
+
+				cPtr[cIdx] = id;
+			}
+		}
+
+		// parents are always smaller than their children - so one pass resolves all roots
+		for (int idx = 0; idx < parent.size(); idx++)
+			parent[idx] = parent[parent[idx]];
+	}
+
+	static std::vector<cv::Point> traceOuterContour(const cv::Mat& components, const QVector<int>& parent, const cv::Point& start);
+
 	template<typename sFmt, typename mFmt>
 	static void mulMaskIntern(cv::Mat src, const cv::Mat mask) {
 
@@ -0,0 +1,132 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "ModelRegistry.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#pragma warning(pop)
+
+namespace rdf {
+
+// ModelRegistry --------------------------------------------------------------------
+ModelRegistry::ModelRegistry() {
+}
+
+ModelRegistry& ModelRegistry::instance() {
+
+	// function statics are initialized thread-safe (C++11)
+	static ModelRegistry inst;
+	return inst;
+}
+
+/// <summary>
+/// Removes all models that were loaded from filePath.
+/// Consumers that still hold a model keep their instance.
+/// </summary>
+/// <param name="filePath">The model's file path.</param>
+void ModelRegistry::remove(const QString & filePath) {
+
+	QString absPath = QFileInfo(filePath).absoluteFilePath();
+
+	QMutexLocker locker(&mMutex);
+
+	for (auto it = mModels.begin(); it != mModels.end();) {
+
+		if (it.key().endsWith(":" + absPath))
+			it = mModels.erase(it);
+		else
+			++it;
+	}
+
+	for (auto it = mLoadMutexes.begin(); it != mLoadMutexes.end();) {
+
+		if (it.key().endsWith(":" + absPath))
+			it = mLoadMutexes.erase(it);
+		else
+			++it;
+	}
+}
+
+/// <summary>
+/// Releases all cached models.
+/// </summary>
+void ModelRegistry::clear() {
+
+	QMutexLocker locker(&mMutex);
+	mModels.clear();
+	mLoadMutexes.clear();
+}
+
+int ModelRegistry::size() const {
+
+	QMutexLocker locker(&mMutex);
+	return mModels.size();
+}
+
+QSharedPointer<void> ModelRegistry::find(const QString & key, const QDateTime & modified) const {
+
+	auto it = mModels.constFind(key);
+
+	if (it == mModels.constEnd() || it->modified != modified)
+		return QSharedPointer<void>();
+
+	return it->model;
+}
+
+/// <summary>
+/// Returns the mutex that serializes loading the model with key.
+/// NOTE: mMutex must be locked.
+/// </summary>
+QSharedPointer<QMutex> ModelRegistry::loadMutex(const QString & key) {
+
+	QSharedPointer<QMutex>& m = mLoadMutexes[key];
+
+	if (!m)
+		m = QSharedPointer<QMutex>(new QMutex());
+
+	return m;
+}
+
+void ModelRegistry::insert(const QString & key, const QDateTime & modified, const QSharedPointer<void>& model) {
+
+	if (mModels.contains(key))
+		qInfo().noquote() << "[ModelRegistry]" << key << "was modified - reloading";
+
+	Entry e;
+	e.modified = modified;
+	e.model = model;
+
+	mModels.insert(key, e);
+}
+
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QSharedPointer>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutex>
+#include <QHash>
+#pragma warning(pop)
+
+#include <functional>
+#include <typeinfo>
+
+#pragma warning (disable: 4251)	// inlined Qt functions in dll interface
+
+#ifndef DllCoreExport
+#ifdef DLL_CORE_EXPORT
+#define DllCoreExport Q_DECL_EXPORT
+#else
+#define DllCoreExport Q_DECL_IMPORT
+#endif
+#endif
+
+// Qt defines
+
+namespace rdf {
+
+/// <summary>
+/// Process-wide cache for models that are loaded from disk.
+/// Each model file is loaded once and shared (read-only) 
+/// between all consumers. Entries are keyed by the model type,
+/// the absolute file path and the file's modification time.
+/// Hence, if a model file is re-written, it is loaded again.
+/// All methods are thread-safe.
+/// </summary>
+class DllCoreExport ModelRegistry {
+
+public:
+	static ModelRegistry& instance();
+
+	/// <summary>
+	/// Returns the model stored at filePath.
+	/// The model is loaded using load if it is not cached yet
+	/// or if the file was modified since it was cached.
+	/// NULL is returned (and nothing cached) if load fails.
+	/// </summary>
+	/// <param name="filePath">The model's file path.</param>
+	/// <param name="load">A function that loads the model from disk.</param>
+	/// <returns>A shared read-only model instance.</returns>
+	template <class T>
+	QSharedPointer<const T> model(const QString& filePath, const std::function<QSharedPointer<T>(const QString&)>& load) {
+
+		QFileInfo fi(filePath);
+		QString key = QString(typeid(T).name()) + ":" + fi.absoluteFilePath();
+		QDateTime modified = fi.lastModified();
+
+		QSharedPointer<QMutex> keyMutex;
+
+		{
+			QMutexLocker locker(&mMutex);
+			QSharedPointer<void> m = find(key, modified);
+
+			if (m)
+				return m.staticCast<const T>();
+
+			keyMutex = loadMutex(key);
+		}
+
+		// NOTE: the registry is not locked while loading - only concurrent
+		// requests of the same model wait so that it is loaded exactly once
+		QMutexLocker keyLocker(keyMutex.data());
+
+		{
+			QMutexLocker locker(&mMutex);
+			QSharedPointer<void> m = find(key, modified);
+
+			if (m)
+				return m.staticCast<const T>();
+		}
+
+		QSharedPointer<T> nm = load(filePath);
+
+		if (!nm)
+			return QSharedPointer<const T>();
+
+		QSharedPointer<void> m = nm;
+
+		{
+			QMutexLocker locker(&mMutex);
+			insert(key, modified, m);
+		}
+
+		return m.staticCast<const T>();
+	}
+
+	void remove(const QString& filePath);
+	void clear();
+	int size() const;
+
+private:
+	ModelRegistry();
+	ModelRegistry(const ModelRegistry&);
+
+	struct Entry {
+		QDateTime modified;
+		QSharedPointer<void> model;
+	};
+
+	mutable QMutex mMutex;
+	QHash<QString, Entry> mModels;
+	QHash<QString, QSharedPointer<QMutex> > mLoadMutexes;	// one per key - serializes loading the same model
+
+	QSharedPointer<void> find(const QString& key, const QDateTime& modified) const;
+	QSharedPointer<QMutex> loadMutex(const QString& key);
+	void insert(const QString& key, const QDateTime& modified, const QSharedPointer<void>& model);
+};
+
+}
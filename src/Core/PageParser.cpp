@@ -54,7 +54,6 @@ PageXmlParser::PageXmlParser() {
 
 bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent) {
 
-	QByteArray ba;
 	bool ok = true;
 
 	if (QFileInfo(xmlPath).exists()) {
@@ -66,19 +65,22 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 			mStatus = status_file_locked;
 			ok = false;
 		}
+		// parse directly from the file (no need to buffer the whole XML)
+		else if (mStatus == status_not_loaded) {
+			mPage = parse(&f, mStatus, ignoreLayers);
+		}
 
-		// load the element
-		ba = f.readAll();
 		f.close();
 	}
 	// if there is no local resource - try downloading it
 	else if (QUrl(xmlPath).isValid()) {
 
-		ba = net::download(xmlPath, &ok);
+		QByteArray ba = net::download(xmlPath, &ok);
 
-		if (!ok) {
+		if (!ok)
 			mStatus = status_not_downloaded;
-		}
+		else if (mStatus == status_not_loaded)
+			mPage = parse(ba, mStatus, ignoreLayers);
 	}
 	else {
 		qCritical() << "cannot read XML from non-existing file:" << xmlPath;
@@ -86,11 +88,8 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 		ok = false;
 	}
 
-	if (mStatus == status_not_loaded) {
-		mPage = parse(ba, mStatus, ignoreLayers);
-		if (mPage)
-			mPage->setXmlPath(xmlPath);
-	}
+	if (mPage && ok)
+		mPage->setXmlPath(xmlPath);
 
 	// create an empty page if we could not read the XML
 	if (!mPage || mStatus != status_ok) {
@@ -103,13 +102,13 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 	return ok;
 }
 
-void PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElement> pageElement) {
+bool PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElement> pageElement) {
 
 	mPage = pageElement;
 
 	if (!mPage) {
 		qWarning() << "[PageXmlWriter] cannot write a NULL page...";
-		return;
+		return false;
 	}
 
 	Timer dt;
@@ -123,18 +122,22 @@ void PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElem
 	// update date modified
 	mPage->setDateModified(QDateTime::currentDateTimeUtc());	// using UTC directly here - somehow the +01:00 to CET is not working here
 	
-	const QByteArray& ba = writePageElement();
-
 	QFile file(xmlPath);
-	file.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+		qWarning() << "could not open" << xmlPath << "for writing";
+		return false;
+	}
 
-	qint64 success = file.write(ba);
+	// stream the XML directly to the file
+	bool success = writePageElement(&file);
 	file.close();
 
-	if (success > 0)
+	if (success)
 		qDebug() << "XML written to" << xmlPath << "in" << dt;
 	else
-		qDebug() << "could not write to" << xmlPath;
+		qWarning() << "could not write to" << xmlPath;
+
+	return success;
 }
 
 PageXmlParser::LoadStatus PageXmlParser::loadStatus() const {
@@ -166,7 +169,30 @@ QSharedPointer<PageElement> PageXmlParser::page() const {
 	return mPage;
 }
 
-QString PageXmlParser::tagName(const RootTags & tag) const {
+/// <summary>
+/// Returns the (cached) tag name.
+/// The names are created once so that parsing
+/// does not allocate a string per comparison.
+/// </summary>
+/// <param name="tag">The tag.</param>
+/// <returns></returns>
+const QString& PageXmlParser::tagName(const RootTags & tag) const {
+
+	static const QVector<QString> tagNames = [] () {
+		QVector<QString> tn;
+		for (int idx = 0; idx < tag_end; idx++)
+			tn << createTagName((RootTags)idx);
+		return tn;
+	}();
+
+	if (tag >= 0 && tag < tagNames.size())
+		return tagNames[tag];
+
+	static const QString empty;
+	return empty;
+}
+
+QString PageXmlParser::createTagName(const RootTags & tag) {
 	
 	switch (tag) {
 
@@ -200,12 +226,31 @@ void PageXmlParser::setPage(QSharedPointer<PageElement> page) {
 
 QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatus& status, bool ignoreLayers) const {
 
+	QBuffer buffer;
+	buffer.setData(ba);
+	buffer.open(QIODevice::ReadOnly);
+
+	return parse(&buffer, status, ignoreLayers);
+}
+
+/// <summary>
+/// Parses a PAGE XML directly from a device (e.g. a QFile).
+/// The XML is streamed, tags are compared as string references.
+/// </summary>
+/// <param name="device">An opened device.</param>
+/// <param name="status">The resulting load status.</param>
+/// <param name="ignoreLayers">If true, layers are not parsed.</param>
+/// <returns>The parsed page element.</returns>
+QSharedPointer<PageElement> PageXmlParser::parse(QIODevice* device, LoadStatus& status, bool ignoreLayers) const {
+
 	QSharedPointer<PageElement> pageElement;
 
 	// load the element
 
-	QString pageTag = tagName(tag_page);	// cache - since it might be called a lot of time
-	QString metaTag = tagName(tag_meta);
+	// cache - since it might be called a lot of time
+	const QString& pageTag = tagName(tag_page);
+	const QString& metaTag = tagName(tag_meta);
+	const QString& layersTag = tagName(tag_layers);
 
 	RegionManager& rm = RegionManager::instance();
 
@@ -216,17 +261,17 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 
 	Timer dt;
 
-	QXmlStreamReader reader(ba);
+	QXmlStreamReader reader(device);
 
 	while (!reader.atEnd()) {
 
-		QString tag = reader.qualifiedName().toString();
+		QStringRef tag = reader.qualifiedName();
 
-		if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_meta)) {
+		if (reader.tokenType() == QXmlStreamReader::StartElement && tag == metaTag) {
 			parseMetadata(reader, pageElement);
 		}
 		// e.g. <Page imageFilename="00001234.tif" imageWidth="1000" imageHeight="2000">
-		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_page)) {
+		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == pageTag) {
 
 			pageElement->setImageFileName(reader.attributes().value(tagName(attr_imageFilename)).toString());
 
@@ -240,7 +285,7 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 				qWarning() << "could not read image dimensions";
 		}
 		// <Layers>
-		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_layers)) {
+		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == layersTag) {
 			parseLayers(reader, pageElement, ignoreLayers);
 		}
 		// e.g. <TextLine id="r1" type="heading">
@@ -254,6 +299,9 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 		reader.readNext();
 	}
 
+	if (reader.hasError())
+		qWarning() << "[PageXmlParser] error in line" << reader.lineNumber() << ":" << reader.errorString();
+
 	pageElement->setRootRegion(root);
 
 	if (!ignoreLayers) {
@@ -307,7 +355,7 @@ void PageXmlParser::parseRegion(QXmlStreamReader & reader, QSharedPointer<Region
 
 	RegionManager& rm = RegionManager::instance();
 
-	Region::Type rType = rm.type(reader.qualifiedName().toString());
+	Region::Type rType = rm.type(reader.qualifiedName());
 	QSharedPointer<Region> region = rm.createRegion(rType);
 	
 	// add region attributes
@@ -327,7 +375,7 @@ void PageXmlParser::parseRegion(QXmlStreamReader & reader, QSharedPointer<Region
 		else
 			reader.readNextStartElement();
 
-		QString tag = reader.qualifiedName().toString();
+		QStringRef tag = reader.qualifiedName();
 
 		// are we done here?
 		if (reader.tokenType() == QXmlStreamReader::EndElement && rm.isValidTypeName(tag))
@@ -355,13 +403,15 @@ void PageXmlParser::parseMetadata(QXmlStreamReader & reader, QSharedPointer<Page
 	//	<Created>2015-03-26T12:13:19.933+01:00</Created>
 	//	<LastChange>2016-01-13T08:59:18.921+01:00</LastChange>
 	//	</Metadata>
+	const QString& metaTag = tagName(tag_meta);
+
 	while (!reader.atEnd()) {
 
 		reader.readNext();
-		QString tag = reader.qualifiedName().toString();
+		QStringRef tag = reader.qualifiedName();
 
 		// are we done?
-		if (reader.tokenType() == QXmlStreamReader::EndElement && tag == tagName(tag_meta))
+		if (reader.tokenType() == QXmlStreamReader::EndElement && tag == metaTag)
 			break;
 
 		// skip non-starting elements
@@ -393,13 +443,14 @@ void PageXmlParser::parseMetadata(QXmlStreamReader & reader, QSharedPointer<Page
 /// <param name="page">The page.</param>
 void PageXmlParser::parseLayers(QXmlStreamReader & reader, QSharedPointer<PageElement> page, bool ignoreLayers) const {
 	QVector<QSharedPointer<LayerElement>> layers;
+	const QString& layersTag = tagName(tag_layers);
 
 	while (!reader.atEnd()) {
 
 		reader.readNext();
-		QString tag = reader.qualifiedName().toString();
+		QStringRef tag = reader.qualifiedName();
 
-		if (reader.tokenType() == QXmlStreamReader::EndElement && tag == tagName(tag_layers)) {
+		if (reader.tokenType() == QXmlStreamReader::EndElement && tag == layersTag) {
 			break;
 		}
 
@@ -416,17 +467,29 @@ void PageXmlParser::parseLayers(QXmlStreamReader & reader, QSharedPointer<PageEl
 
 QByteArray PageXmlParser::writePageElement() const {
 
-	if (!mPage) {
-		qWarning() << "Cannot write XML if page is NULL";
-		return QByteArray();
-	}
-
 	QByteArray ba;
 	QBuffer buffer(&ba);
 	buffer.open(QIODevice::WriteOnly);
 
+	if (!writePageElement(&buffer))
+		return QByteArray();
+
+	return ba;
+}
 
-	QXmlStreamWriter writer(&buffer);
+/// <summary>
+/// Writes the page element to an (opened) device.
+/// </summary>
+/// <param name="device">The device (e.g. a QFile) which is streamed to.</param>
+/// <returns>true if the XML was written successfully.</returns>
+bool PageXmlParser::writePageElement(QIODevice* device) const {
+
+	if (!mPage) {
+		qWarning() << "Cannot write XML if page is NULL";
+		return false;
+	}
+
+	QXmlStreamWriter writer(device);
 	writer.setAutoFormatting(true);
 	writer.writeStartDocument();
 
@@ -467,7 +530,7 @@ QByteArray PageXmlParser::writePageElement() const {
 	writer.writeEndElement();	// </PcGts>
 	writer.writeEndDocument();
 
-	return ba;
+	return !writer.hasError();
 }
 
 void PageXmlParser::writeMetaData(QXmlStreamWriter& writer) const {
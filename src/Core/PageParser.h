@@ -50,6 +50,7 @@
 // Qt defines
 class QXmlStreamReader;
 class QXmlStreamWriter;
+class QIODevice;
 
 namespace rdf {
 
@@ -94,12 +95,12 @@ public:
 	};
 
 	bool read(const QString& xmlPath, bool ignoreLayers = false, bool silent = false);
-	void write(const QString& xmlPath, const QSharedPointer<PageElement> pageElement);
+	bool write(const QString& xmlPath, const QSharedPointer<PageElement> pageElement);
 
 	LoadStatus loadStatus() const;
 	QString loadStatusMessage() const;
 
-	QString tagName(const RootTags& tag) const;
+	const QString& tagName(const RootTags& tag) const;
 
 	void setPage(QSharedPointer<PageElement> page);
 	QSharedPointer<PageElement> page() const;
@@ -111,13 +112,18 @@ protected:
 	QSharedPointer<PageElement> mPage;
 	LoadStatus mStatus = status_not_loaded;
 
-	virtual QSharedPointer<PageElement> parse(const QByteArray& ba, LoadStatus& status, bool ignoreLayers = false) const;
+	QSharedPointer<PageElement> parse(const QByteArray& ba, LoadStatus& status, bool ignoreLayers = false) const;
+	virtual QSharedPointer<PageElement> parse(QIODevice* device, LoadStatus& status, bool ignoreLayers = false) const;
 	virtual void parseRegion(QXmlStreamReader& reader, QSharedPointer<Region> parent) const;
 	virtual void parseMetadata(QXmlStreamReader& reader, QSharedPointer<PageElement> page) const;
 	virtual void parseLayers(QXmlStreamReader& reader, QSharedPointer<PageElement> page, bool ignoreLayers = false) const;
 
 	QByteArray writePageElement() const;
+	bool writePageElement(QIODevice* device) const;
 	void writeMetaData(QXmlStreamWriter& writer) const;
+
+private:
+	static QString createTagName(const RootTags& tag);
 };
 
 }
@@ -37,12 +37,14 @@
 #include "ElementsHelper.h"
 #include "Image.h"
 #include "Utils.h"
+#include "ModelRegistry.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QJsonObject>		// needed for LabelInfo
 #include <QJsonDocument>	// needed for LabelInfo
 #include <QJsonArray>		// needed for LabelInfo
 #include <QPainter>
+#include <QFileInfo>
 
 #include <QDebug>
 
@@ -470,6 +472,9 @@ bool PixelLabel::isEvaluated() const {
 SuperPixelModel::SuperPixelModel(const LabelManager & labelManager, const cv::Ptr<cv::ml::StatModel>& model) {
 	mModel = model;
 	mManager = labelManager;
+
+	if (randomTrees() && randomTrees()->isTrained())
+		mEngine = RandomTreesEngine(randomTrees(), mManager);
 }
 
 bool SuperPixelModel::isEmpty() const {
@@ -490,6 +495,50 @@ LabelManager SuperPixelModel::manager() const {
 
 QVector<PixelLabel> SuperPixelModel::classify(const cv::Mat & features) const {
 
+	if (mEngine.isEmpty() || features.cols != mEngine.numVars())
+		return classifyStatModel(features);
+
+	Timer dt;
+
+	cv::Mat cFeatures = features;
+	IP::normalize(cFeatures);
+
+	cv::Mat votes, labelIndexes;
+	if (!mEngine.predict(cFeatures, votes, labelIndexes))
+		return classifyStatModel(features);
+
+	QVector<LabelInfo> labels = mManager.labelInfos();
+	QVector<PixelLabel> labelInfos;
+	labelInfos.reserve(cFeatures.rows);
+
+	const int* lp = labelIndexes.ptr<int>();
+
+	for (int rIdx = 0; rIdx < cFeatures.rows; rIdx++) {
+
+		PixelVotes pv(mManager);
+		pv.setVotes(votes.row(rIdx), mEngine.numTrees());
+
+		PixelLabel pLabel;
+		pLabel.setVotes(pv);
+		pLabel.setLabel(labels[lp[rIdx]]);
+		labelInfos << pLabel;
+	}
+
+	qInfo() << cFeatures.rows << "features predicted in" << dt;
+
+	return labelInfos;
+}
+
+/// <summary>
+/// Classifies the features using OpenCV's generic StatModel interface.
+/// Each feature row is predicted separately. Use classify()
+/// which is considerably faster for RTrees. This method is
+/// kept as fallback (non-RTrees models) and for reference.
+/// </summary>
+/// <param name="features">The features (one sample per row).</param>
+/// <returns>The predicted labels.</returns>
+QVector<PixelLabel> SuperPixelModel::classifyStatModel(const cv::Mat & features) const {
+
 	Timer dt;
 
 	cv::Mat cFeatures = features;
@@ -551,15 +600,22 @@ bool SuperPixelModel::write(const QString & filePath) const {
 	QJsonObject jo;
 	mManager.toJson(jo);
 
-	// write RTrees classifier
-	toJson(jo);
+	// write RTrees classifier to a binary container next to the JSON (if it is large)
+	MatFile mf(Utils::createFilePath(filePath, "", MatFile::suffix()));
+	toJson(jo, mf.open(QIODevice::WriteOnly) ? &mf : 0);
+
+	// the model is embedded - remove the (empty) container
+	if (!jo.value("SuperPixelModel").isObject() && mf.isOpen()) {
+		mf.close();
+		QFile::remove(mf.filePath());
+	}
 
 	int64 bw = Utils::writeJson(filePath, jo);
 
 	return bw > 0;	// if we wrote more than 0 bytes, it's ok
 }
 
-void SuperPixelModel::toJson(QJsonObject& jo) const {
+void SuperPixelModel::toJson(QJsonObject& jo, MatFile* matFile) const {
 
 	if (!mModel) {
 		qWarning() << "cannot save SuperPixelModel because it is NULL.";
@@ -573,6 +629,13 @@ void SuperPixelModel::toJson(QJsonObject& jo) const {
 #endif
 	std::string data = fs.releaseAndGetString();
 
+	// store the model's meta data only
+	if (matFile && data.length() >= MatFile::embedLimit()) {
+		cv::Mat dm(1, (int)data.length(), CV_8UC1, (void*)data.c_str());
+		jo.insert("SuperPixelModel", matFile->append(dm, true));
+		return;
+	}
+
 	QByteArray ba(data.c_str(), (int)data.length());
 	QString ba64Str = ba.toBase64();
 
@@ -586,7 +649,10 @@ QSharedPointer<SuperPixelModel> SuperPixelModel::read(const QString & filePath)
 
 	QJsonObject jo = Utils::readJson(filePath);
 	sm->mManager = LabelManager::fromJson(jo);
-	sm->mModel = SuperPixelModel::readRTreesModel(jo);
+	sm->mModel = SuperPixelModel::readRTreesModel(jo, QFileInfo(filePath).absolutePath());
+
+	if (sm->randomTrees() && sm->randomTrees()->isTrained())
+		sm->mEngine = RandomTreesEngine(sm->randomTrees(), sm->mManager);
 
 	if (!sm->mManager.isEmpty() && sm->mModel) {
 		qInfo() << "var count:" << sm->model()->getVarCount() << "is classifier" << sm->model()->isClassifier();
@@ -600,11 +666,42 @@ QSharedPointer<SuperPixelModel> SuperPixelModel::read(const QString & filePath)
 	return sm;
 }
 
-cv::Ptr<cv::ml::RTrees> SuperPixelModel::readRTreesModel(QJsonObject & jo) {
+/// <summary>
+/// Returns the model stored at filePath.
+/// In contrast to read(), the model is only loaded once
+/// and then shared by all callers (see ModelRegistry).
+/// </summary>
+/// <param name="filePath">The model's file path.</param>
+/// <returns>A shared read-only model which is empty if it could not be loaded.</returns>
+QSharedPointer<const SuperPixelModel> SuperPixelModel::readCached(const QString & filePath) {
+
+	auto load = [](const QString& fp) {
+		QSharedPointer<SuperPixelModel> sm = SuperPixelModel::read(fp);
+		return sm->isEmpty() ? QSharedPointer<SuperPixelModel>() : sm;
+	};
+
+	QSharedPointer<const SuperPixelModel> sm = ModelRegistry::instance().model<SuperPixelModel>(filePath, load);
+
+	if (!sm)
+		return QSharedPointer<const SuperPixelModel>(new SuperPixelModel());
+
+	return sm;
+}
 
-	// decode data
-	QByteArray ba = jo.value("SuperPixelModel").toVariant().toByteArray();
-	ba = QByteArray::fromBase64(ba);
+cv::Ptr<cv::ml::RTrees> SuperPixelModel::readRTreesModel(QJsonObject & jo, const QString& dirPath) {
+
+	QByteArray ba;
+
+	// the model is stored in a binary container
+	if (jo.value("SuperPixelModel").isObject()) {
+		cv::Mat dm = Image::jsonToMat(jo.value("SuperPixelModel").toObject(), dirPath);
+		ba = QByteArray(dm.ptr<const char>(), (int)dm.total());
+	}
+	// decode embedded data
+	else {
+		ba = jo.value("SuperPixelModel").toVariant().toByteArray();
+		ba = QByteArray::fromBase64(ba);
+	}
 
 	if (!ba.length()) {
 		qCritical().noquote() << "cannot read model";
@@ -666,10 +763,32 @@ void PixelVotes::setRawVotes(const cv::Mat & rawVotes) {
 		qWarning() << "sum votes is zero - that's weird!";
 }
 
+/// <summary>
+/// Sets the (normalized) votes directly.
+/// votes is expected to be a 1 x LabelManager::size() CV_32FC1 
+/// row where each entry corresponds to the manager's label index.
+/// The votes are copied so that rows of a large vote matrix can be passed.
+/// </summary>
+/// <param name="votes">The votes.</param>
+/// <param name="numTrees">The number of trees that voted.</param>
+void PixelVotes::setVotes(const cv::Mat & votes, int numTrees) {
+
+	assert(votes.empty() || (votes.rows == 1 && votes.cols == mManager.size() && votes.type() == CV_32FC1));
+	mVotes = votes.clone();
+	mNumTrees = numTrees;
+}
+
 cv::Mat PixelVotes::data() const {
 	return mVotes;
 }
 
+/// <summary>
+/// The number of trees that voted.
+/// </summary>
+int PixelVotes::numTrees() const {
+	return qRound(mNumTrees);
+}
+
 int PixelVotes::labelIndex() const {
 	return mManager.labelInfos()[maxVote()].id();
 }
@@ -681,4 +800,177 @@ int PixelVotes::maxVote() const {
 	return pMaxIdx.x;
 }
 
-}
\ No newline at end of file
+// -------------------------------------------------------------------- RandomTreesEngine 
+/// <summary>
+/// Evaluates the samples of a given row range (see cv::parallel_for_).
+/// </summary>
+class RandomTreesBody : public cv::ParallelLoopBody {
+
+public:
+	RandomTreesBody(const RandomTreesEngine& engine, const cv::Mat& features, cv::Mat& votes) : 
+		mEngine(engine), mFeatures(features), mVotes(votes) {}
+
+	void operator()(const cv::Range& r) const override {
+
+		for (int rIdx = r.start; rIdx < r.end; rIdx++)
+			mEngine.predict(mFeatures.ptr<float>(rIdx), mVotes.ptr<float>(rIdx));
+	}
+
+protected:
+	const RandomTreesEngine& mEngine;
+	const cv::Mat& mFeatures;
+	cv::Mat& mVotes;
+};
+
+RandomTreesEngine::RandomTreesEngine(const cv::Ptr<cv::ml::RTrees>& trees, const LabelManager& manager) {
+
+	if (!trees || !trees->isTrained())
+		return;
+
+	mNumClasses = manager.size();
+	mNumVars = trees->getVarCount();
+
+	mNodes.reserve((int)trees->getNodes().size());
+
+	for (int rootIdx : trees->getRoots()) {
+
+		int idx = flatten(trees, rootIdx, manager);
+
+		// the forest cannot be flattened - it's safer to use OpenCV
+		if (idx == -1) {
+			qWarning() << "[RandomTreesEngine] I cannot flatten the random trees - using the default predict";
+			*this = RandomTreesEngine();
+			return;
+		}
+
+		mRoots << idx;
+	}
+
+	mNodes.squeeze();
+}
+
+bool RandomTreesEngine::isEmpty() const {
+	return mRoots.empty();
+}
+
+int RandomTreesEngine::numTrees() const {
+	return mRoots.size();
+}
+
+int RandomTreesEngine::numClasses() const {
+	return mNumClasses;
+}
+
+int RandomTreesEngine::numVars() const {
+	return mNumVars;
+}
+
+/// <summary>
+/// Predicts all samples (rows) of features in parallel.
+/// </summary>
+/// <param name="features">The features N x numVars() (converted to CV_32FC1 if needed).</param>
+/// <param name="votes">The normalized votes N x numClasses() CV_32FC1.</param>
+/// <param name="labelIndexes">The label index (arg-max of votes) w.r.t. the LabelManager N x 1 CV_32SC1.</param>
+/// <returns>false if the features cannot be predicted with this forest.</returns>
+bool RandomTreesEngine::predict(const cv::Mat & features, cv::Mat & votes, cv::Mat & labelIndexes) const {
+
+	if (isEmpty() || features.cols != mNumVars) {
+		qWarning() << "[RandomTreesEngine] cannot predict" << features.cols << "features with a forest trained on" << mNumVars << "vars";
+		return false;
+	}
+
+	cv::Mat cFeatures = features;
+	if (cFeatures.type() != CV_32FC1)
+		features.convertTo(cFeatures, CV_32F);
+
+	votes = cv::Mat(cFeatures.rows, mNumClasses, CV_32FC1, cv::Scalar(0));
+	cv::parallel_for_(cv::Range(0, cFeatures.rows), RandomTreesBody(*this, cFeatures, votes));
+
+	// find the arg-max
+	labelIndexes = cv::Mat(cFeatures.rows, 1, CV_32SC1);
+	int* lp = labelIndexes.ptr<int>();
+
+	for (int rIdx = 0; rIdx < votes.rows; rIdx++) {
+
+		const float* vp = votes.ptr<float>(rIdx);
+		int maxIdx = 0;
+
+		for (int cIdx = 1; cIdx < votes.cols; cIdx++) {
+			if (vp[cIdx] > vp[maxIdx])
+				maxIdx = cIdx;
+		}
+
+		lp[rIdx] = maxIdx;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Predicts a single sample.
+/// </summary>
+/// <param name="sample">The sample with numVars() entries.</param>
+/// <param name="votes">The votes with numClasses() entries which must be zero-initialized.</param>
+void RandomTreesEngine::predict(const float* sample, float* votes) const {
+
+	const Node* nodes = mNodes.constData();
+	float w = 1.0f / mRoots.size();
+
+	for (int rootIdx : mRoots) {
+
+		const Node* n = nodes + rootIdx;
+
+		while (n->varIdx != -1)
+			n = nodes + (sample[n->varIdx] <= n->threshold ? n->left : n->right);
+
+		votes[n->left] += w;
+	}
+}
+
+/// <summary>
+/// Adds the (sub-)tree of nodeIdx to the node array.
+/// </summary>
+/// <returns>The index of the node in the flat array or -1 if the tree cannot be flattened.</returns>
+int RandomTreesEngine::flatten(const cv::Ptr<cv::ml::RTrees>& trees, int nodeIdx, const LabelManager& manager) {
+
+	const cv::ml::DTrees::Node& node = trees->getNodes()[nodeIdx];
+	int idx = mNodes.size();
+	mNodes << Node();
+
+	// leaf: store the label index
+	if (node.split < 0) {
+
+		int labelIdx = manager.indexOf(qRound(node.value));
+
+		if (labelIdx == -1) {
+			qWarning() << "[RandomTreesEngine] unknown class:" << node.value;
+			return -1;
+		}
+
+		mNodes[idx].left = labelIdx;
+		return idx;
+	}
+
+	const cv::ml::DTrees::Split& split = trees->getSplits()[node.split];
+
+	// categorical splits are not supported
+	if (split.subsetOfs >= 0 || split.varIdx < 0 || split.varIdx >= mNumVars)
+		return -1;
+
+	int left = flatten(trees, node.left, manager);
+	int right = left != -1 ? flatten(trees, node.right, manager) : -1;
+
+	if (right == -1)
+		return -1;
+
+	// OpenCV goes left if val <= c (for non-inversed splits)
+	Node& n = mNodes[idx];
+	n.varIdx = split.varIdx;
+	n.threshold = split.c;
+	n.left = split.inversed ? right : left;
+	n.right = split.inversed ? left : right;
+
+	return idx;
+}
+
+}
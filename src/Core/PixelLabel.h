@@ -66,6 +66,7 @@ namespace rdf {
 
 // read defines
 class Pixel;
+class MatFile;
 class Region;
 
 /// <summary>
@@ -165,7 +166,9 @@ public:
 	bool isEmpty() const;
 
 	void setRawVotes(const cv::Mat& rawVotes);
+	void setVotes(const cv::Mat& votes, int numTrees);
 	cv::Mat data() const;
+	int numTrees() const;
 
 	int labelIndex() const;
 
@@ -199,6 +202,46 @@ protected:
 	PixelVotes mVotes;
 };
 
+/// <summary>
+/// Flattened copy of a trained cv::ml::RTrees.
+/// All trees are stored in one compact node array 
+/// (depth-first, left child first) which allows for
+/// cache-friendly traversal. Samples are evaluated
+/// in parallel and the votes are directly mapped to
+/// the LabelManager's indexes.
+/// NOTE: only ordered (non-categorical) splits are supported.
+/// </summary>
+class DllCoreExport RandomTreesEngine {
+
+public:
+	RandomTreesEngine(const cv::Ptr<cv::ml::RTrees>& trees = cv::Ptr<cv::ml::RTrees>(), const LabelManager& manager = LabelManager());
+
+	bool isEmpty() const;
+	int numTrees() const;
+	int numClasses() const;
+	int numVars() const;
+
+	bool predict(const cv::Mat& features, cv::Mat& votes, cv::Mat& labelIndexes) const;
+	void predict(const float* sample, float* votes) const;
+
+protected:
+
+	// leafs have varIdx == -1 and store the label index in left
+	struct Node {
+		int varIdx = -1;
+		float threshold = 0.0f;
+		int left = -1;
+		int right = -1;
+	};
+
+	QVector<Node> mNodes;
+	QVector<int> mRoots;
+	int mNumClasses = 0;
+	int mNumVars = 0;
+
+	int flatten(const cv::Ptr<cv::ml::RTrees>& trees, int nodeIdx, const LabelManager& manager);
+};
+
 class DllCoreExport SuperPixelModel {
 
 public:
@@ -211,16 +254,19 @@ public:
 	LabelManager manager() const;
 
 	QVector<PixelLabel> classify(const cv::Mat& features) const;
+	QVector<PixelLabel> classifyStatModel(const cv::Mat& features) const;
 
 	bool write(const QString& filePath) const;
 	static QSharedPointer<SuperPixelModel> read(const QString& filePath);
+	static QSharedPointer<const SuperPixelModel> readCached(const QString& filePath);
 
 protected:
 	cv::Ptr<cv::ml::StatModel> mModel;
 	LabelManager mManager;
+	RandomTreesEngine mEngine;
 
-	static cv::Ptr<cv::ml::RTrees> readRTreesModel(QJsonObject& jo);
-	void toJson(QJsonObject& jo) const;
+	static cv::Ptr<cv::ml::RTrees> readRTreesModel(QJsonObject& jo, const QString& dirPath = "");
+	void toJson(QJsonObject& jo, MatFile* matFile = 0) const;
 
 };
 
@@ -36,10 +36,15 @@
 #include "Elements.h"
 #include "Utils.h"
 #include "Settings.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
 #include <QPainter>
+#include <QHash>
+#include <QMutexLocker>
+
+#include <algorithm>
 
 #include <opencv2/imgproc.hpp>
 #pragma warning(pop)
@@ -506,49 +511,55 @@ QVector<QSharedPointer<PixelEdge> > PixelSet::connect(const QVector<QSharedPoint
 	return connector->connect(superPixels);
 }
 
+/// <summary>
+/// Groups the edges' pixels into connected components.
+/// Pixels are mapped to dense indexes and grouped using
+/// union-find, hence it runs in nearly linear time.
+/// The sets are ordered by their first pixel's appearance
+/// in edges and pixels keep their order of appearance.
+/// </summary>
+/// <param name="edges">The edges.</param>
+/// <returns>A pixel set for each connected component.</returns>
 QVector<PixelSet> PixelSet::fromEdges(const QVector<QSharedPointer<PixelEdge> >& edges) {
 
-	QVector<PixelSet> sets;
+	// map pixels to dense indexes
+	QHash<const Pixel*, int> pixelIndexes;
+	pixelIndexes.reserve(edges.size());
+	QVector<QSharedPointer<Pixel> > pixels;
 
-	for (const QSharedPointer<PixelEdge> e : edges) {
+	auto pixelIndex = [&](const QSharedPointer<Pixel>& px) {
 
-		int fIdx = -1;
-		int sIdx = -1;
+		auto it = pixelIndexes.constFind(px.data());
+		if (it != pixelIndexes.constEnd())
+			return it.value();
 
-		for (int idx = 0; idx < sets.size(); idx++) {
+		int idx = pixels.size();
+		pixelIndexes.insert(px.data(), idx);
+		pixels << px;
+		return idx;
+	};
 
-			if (sets[idx].contains(e->first()))
-				fIdx = idx;
-			if (sets[idx].contains(e->second()))
-				sIdx = idx;
+	QVector<QPair<int, int> > edgeIndexes;
+	edgeIndexes.reserve(edges.size());
 
-			if (fIdx != -1 && sIdx != -1)
-				break;
-		}
+	for (const QSharedPointer<PixelEdge>& e : edges) {
+		int fIdx = pixelIndex(e->first());
+		edgeIndexes << QPair<int, int>(fIdx, pixelIndex(e->second()));
+	}
 
-		// none is contained in a set
-		if (fIdx == -1 && sIdx == -1) {
-			PixelSet ps;
-			ps.add(e->first());
-			ps.add(e->second());
-			sets << ps;
-		}
-		// add first to the set of second
-		else if (fIdx == -1) {
-			sets[sIdx].add(e->first());
-		}
-		// add second to the set of first
-		else if (sIdx == -1) {
-			sets[fIdx].add(e->second());
-		}
-		// two different idx? - merge the sets
-		else if (fIdx != sIdx) {
-			sets[fIdx].append(sets[sIdx].pixels());
-			sets.remove(sIdx);
-		}
-		// else : nothing to do - they are both already added
+	DisjointSet ds(pixels.size());
+	for (const QPair<int, int>& e : edgeIndexes)
+		ds.unite(e.first, e.second);
 
-	}
+	QVector<int> labels = ds.labels();
+
+	int numSets = 0;
+	for (int l : labels)
+		numSets = qMax(numSets, l + 1);
+
+	QVector<PixelSet> sets(numSets);
+	for (int idx = 0; idx < pixels.size(); idx++)
+		sets[labels[idx]].add(pixels[idx]);
 
 	return sets;
 }
@@ -639,8 +650,9 @@ void PixelSet::draw(QPainter& p, const DrawFlags& options, const Pixel::DrawFlag
 PixelGraph::PixelGraph() {
 }
 
-PixelGraph::PixelGraph(const PixelSet& set) {
+PixelGraph::PixelGraph(const PixelSet& set, const Storage& storage) {
 	mSet = set;
+	mStorage = storage;
 }
 
 bool PixelGraph::isEmpty() const {
@@ -677,46 +689,120 @@ void PixelGraph::connect(const PixelConnector& connector, const SortMode& sort)
 
 	const QVector<QSharedPointer<Pixel> >& pixels = mSet.pixels();
 
-	mEdges = connector.connect(pixels);
+	mEdges.clear();
+	mIndexEdges.clear();
 
-	if (sort == sort_edges)
-		qSort(mEdges.begin(), mEdges.end());
-	else if (sort == sort_line_edges) {
+	// pixel lookup (maps pixel IDs to their current vector index)
+	mPixelLookup.clear();
+	mPixelLookup.reserve(pixels.size());
+	for (int idx = 0; idx < pixels.size(); idx++)
+		mPixelLookup.insert(pixels[idx]->id(), idx);
 
-		QVector<QSharedPointer<LineEdge> > lEdges;
-		for (auto e : mEdges)
-			lEdges << QSharedPointer<LineEdge>(new LineEdge(*e));
+	// compact graphs only keep the indexes (sorting edges by weight needs PixelEdges though)
+	if (mStorage == storage_compact && (sort == sort_none || sort == sort_distance)) {
 
-		qSort(lEdges.begin(), lEdges.end());
+		mIndexEdges = connector.connectIndexes(pixels);
 
-		mEdges.clear();
-		for (auto e : lEdges)
-			mEdges << e;
+		// compact graphs cannot store edges to pixels that are not in the set
+		mIndexEdges.erase(std::remove_if(mIndexEdges.begin(), mIndexEdges.end(), 
+			[](const IndexEdge& e) { return e.isNull(); }), mIndexEdges.end());
+
+		if (sort == sort_distance) {
+
+			auto lSort = [&](const IndexEdge& e1, const IndexEdge& e2) {
+				return Line(pixels[e1.first()]->center(), pixels[e1.second()]->center()).length() < 
+					Line(pixels[e2.first()]->center(), pixels[e2.second()]->center()).length();
+			};
+			std::sort(mIndexEdges.begin(), mIndexEdges.end(), lSort);
+		}
 	}
-	else if (sort == sort_distance) {
+	else {
+
+		mEdges = connector.connect(pixels);
 
-		auto lSort = [&](const  QSharedPointer<PixelEdge>& e1, const  QSharedPointer<PixelEdge>& e2) { 
-			return e1->edge().length() < e2->edge().length(); 
-		};
-		qSort(mEdges.begin(), mEdges.end(), lSort);
+		if (sort == sort_edges)
+			qSort(mEdges.begin(), mEdges.end());
+		else if (sort == sort_line_edges) {
+
+			QVector<QSharedPointer<LineEdge> > lEdges;
+			for (auto e : mEdges)
+				lEdges << QSharedPointer<LineEdge>(new LineEdge(*e));
+
+			qSort(lEdges.begin(), lEdges.end());
+
+			mEdges.clear();
+			for (auto e : lEdges)
+				mEdges << e;
+		}
+		else if (sort == sort_distance) {
+
+			auto lSort = [&](const  QSharedPointer<PixelEdge>& e1, const  QSharedPointer<PixelEdge>& e2) { 
+				return e1->edge().length() < e2->edge().length(); 
+			};
+			qSort(mEdges.begin(), mEdges.end(), lSort);
+		}
+
+		mIndexEdges.reserve(mEdges.size());
+		for (const QSharedPointer<PixelEdge>& e : mEdges)
+			mIndexEdges << IndexEdge(mPixelLookup.value(e->first()->id(), -1), mPixelLookup.value(e->second()->id(), -1));
 	}
 
-	// edge lookup (maps pixel IDs to their corresponding edge index) this is a 1 ... n relationship
-	for (int idx = 0; idx < mEdges.size(); idx++) {
+	index();
+}
 
-		QString key = mEdges[idx]->first()->id();
+/// <summary>
+/// Creates the adjacency list.
+/// Edges are assigned to their first pixel (this is a 1 ... n relationship).
+/// </summary>
+void PixelGraph::index() {
 
-		QVector<int> v = mPixelEdges.value(key);
-		v << idx;
+	int n = mSet.size();
 
-		mPixelEdges.insert(key, v);
+	// count the edges per pixel
+	mEdgeStart = QVector<int>(n + 1, 0);
+	for (const IndexEdge& e : mIndexEdges) {
+		if (e.first() >= 0)
+			mEdgeStart[e.first() + 1]++;
 	}
 
-	// pixel lookup (maps pixel IDs to their current vector index)
-	for (int idx = 0; idx < pixels.size(); idx++) {
-		mPixelLookup.insert(pixels[idx]->id(), idx);
+	for (int idx = 0; idx < n; idx++)
+		mEdgeStart[idx + 1] += mEdgeStart[idx];
+
+	// sort the edges by their first pixel (keeping their order)
+	QVector<int> pos = mEdgeStart;
+	mEdgeIndexes = QVector<int>(mEdgeStart[n]);
+	mForeignEdges.clear();
+
+	for (int idx = 0; idx < mIndexEdges.size(); idx++) {
+
+		int fIdx = mIndexEdges[idx].first();
+
+		if (fIdx >= 0)
+			mEdgeIndexes[pos[fIdx]++] = idx;
+		else if (idx < mEdges.size())	// connectors that create new pixels
+			mForeignEdges[mEdges[idx]->first()->id()] << idx;
 	}
+}
+
+/// <summary>
+/// Returns the PixelEdges.
+/// They are created if the graph has compact storage.
+/// </summary>
+const QVector<QSharedPointer<PixelEdge> >& PixelGraph::sharedEdges() const {
+
+	// concurrent readers must not fill the edges twice
+	QMutexLocker locker(mEdgeMutex.data());
 
+	if (mEdges.isEmpty() && !mIndexEdges.isEmpty()) {
+
+		const QVector<QSharedPointer<Pixel> >& pixels = mSet.pixels();
+
+		mEdges.reserve(mIndexEdges.size());
+		for (const IndexEdge& e : mIndexEdges)
+			mEdges << QSharedPointer<PixelEdge>(new PixelEdge(pixels[e.first()], pixels[e.second()]));
+	}
+
+	return mEdges;
 }
 
 PixelSet PixelGraph::set() const {
@@ -729,7 +815,7 @@ PixelSet PixelGraph::set() const {
 /// <returns>A vector of PixelEdges which connect 2 pixels each.</returns>
 QVector<QSharedPointer<PixelEdge> > PixelGraph::edges() const {
 
-	return mEdges;
+	return sharedEdges();
 }
 
 /// <summary>
@@ -749,10 +835,12 @@ QVector<QSharedPointer<PixelEdge>> PixelGraph::edges(const QString & pixelID) co
 /// <returns></returns>
 QVector<QSharedPointer<PixelEdge> > PixelGraph::edges(const QVector<int>& edgeIDs) const {
 
+	const QVector<QSharedPointer<PixelEdge> >& se = sharedEdges();
+
 	QVector<QSharedPointer<PixelEdge> > pe;
 	for (int eId : edgeIDs) {
-		assert(eId >= 0 && eId < mEdges.length());
-		pe << mEdges[eId];
+		assert(eId >= 0 && eId < se.length());
+		pe << se[eId];
 	}
 
 	return pe;
@@ -776,7 +864,42 @@ int PixelGraph::pixelIndex(const QString & pixelID) const {
 /// <param name="pixelID">Unique pixel ID.</param>
 /// <returns>A vector with edge indexes.</returns>
 QVector<int> PixelGraph::edgeIndexes(const QString & pixelID) const {
-	return mPixelEdges.value(pixelID);
+
+	auto pIt = mPixelLookup.constFind(pixelID);
+
+	if (pIt != mPixelLookup.constEnd())
+		return edgeIndexes(pIt.value());
+
+	return mForeignEdges.value(pixelID);
+}
+
+PixelGraph::Storage PixelGraph::storage() const {
+	return mStorage;
+}
+
+int PixelGraph::numEdges() const {
+	return mIndexEdges.size();
+}
+
+/// <summary>
+/// Returns all edges as pixel indexes.
+/// In contrast to edges(), this does not create PixelEdges.
+/// </summary>
+QVector<IndexEdge> PixelGraph::indexEdges() const {
+	return mIndexEdges;
+}
+
+/// <summary>
+/// Returns the indexes of all edges of the pixel with index pixelIdx.
+/// </summary>
+/// <param name="pixelIdx">The pixel's index in set().</param>
+/// <returns>A vector with edge indexes (see indexEdges()).</returns>
+QVector<int> PixelGraph::edgeIndexes(int pixelIdx) const {
+
+	if (pixelIdx < 0 || pixelIdx + 1 >= mEdgeStart.size())
+		return QVector<int>();
+
+	return mEdgeIndexes.mid(mEdgeStart[pixelIdx], mEdgeStart[pixelIdx + 1] - mEdgeStart[pixelIdx]);
 }
 
 // PixelTabStop --------------------------------------------------------------------
@@ -866,6 +989,101 @@ PixelTabStop::Type PixelTabStop::type() const {
 	return mType;
 }
 
+// PixelGrid --------------------------------------------------------------------
+PixelGrid::PixelGrid(const QVector<QSharedPointer<Pixel> >& pixels, double cellSize) {
+
+	if (pixels.isEmpty())
+		return;
+
+	double minX = DBL_MAX, minY = DBL_MAX;
+	double maxX = -DBL_MAX, maxY = -DBL_MAX;
+
+	for (const QSharedPointer<Pixel>& px : pixels) {
+		const Vector2D& c = px->center();
+		minX = qMin(minX, c.x());
+		minY = qMin(minY, c.y());
+		maxX = qMax(maxX, c.x());
+		maxY = qMax(maxY, c.y());
+	}
+
+	mOrigin = Vector2D(minX, minY);
+	mCellSize = cellSize > 0 ? cellSize : 1.0;
+
+	// limit the number of (empty) cells if the cell size is tiny
+	double maxCells = 4.0 * pixels.size() + 16;
+	while (((maxX - minX) / mCellSize + 1) * ((maxY - minY) / mCellSize + 1) > maxCells)
+		mCellSize *= 2.0;
+
+	mCols = (int)((maxX - minX) / mCellSize) + 1;
+	mRows = (int)((maxY - minY) / mCellSize) + 1;
+
+	// counting sort of the pixels w.r.t. their cells
+	QVector<int> cells(pixels.size());
+	mCellStart.fill(0, mCols * mRows + 1);
+
+	for (int idx = 0; idx < pixels.size(); idx++) {
+		const Vector2D& c = pixels[idx]->center();
+		int cIdx = qMin((int)((c.x() - minX) / mCellSize), mCols - 1);
+		int rIdx = qMin((int)((c.y() - minY) / mCellSize), mRows - 1);
+		cells[idx] = rIdx * mCols + cIdx;
+		mCellStart[cells[idx] + 1]++;
+	}
+
+	for (int idx = 1; idx < mCellStart.size(); idx++)
+		mCellStart[idx] += mCellStart[idx - 1];
+
+	QVector<int> pos = mCellStart;
+	mIndexes.resize(pixels.size());
+	for (int idx = 0; idx < pixels.size(); idx++)
+		mIndexes[pos[cells[idx]]++] = idx;
+}
+
+bool PixelGrid::isEmpty() const {
+	return mIndexes.isEmpty();
+}
+
+double PixelGrid::cellSize() const {
+	return mCellSize;
+}
+
+/// <summary>
+/// Returns the indexes of all pixels in cells that overlap
+/// with the query square of size 2*radius.
+/// Hence, callers need to test the exact distance.
+/// The indexes are sorted (i.e. pixel order is preserved).
+/// </summary>
+/// <param name="center">The query center.</param>
+/// <param name="radius">The query radius.</param>
+/// <returns>Candidate pixel indexes.</returns>
+QVector<int> PixelGrid::neighbors(const Vector2D & center, double radius) const {
+
+	QVector<int> indexes;
+
+	if (isEmpty())
+		return indexes;
+
+	auto cell = [&](double v, int maxIdx) {
+		return (int)qBound(0.0, std::floor(v / mCellSize), (double)maxIdx);
+	};
+
+	int c0 = cell(center.x() - radius - mOrigin.x(), mCols - 1);
+	int c1 = cell(center.x() + radius - mOrigin.x(), mCols - 1);
+	int r0 = cell(center.y() - radius - mOrigin.y(), mRows - 1);
+	int r1 = cell(center.y() + radius - mOrigin.y(), mRows - 1);
+
+	for (int rIdx = r0; rIdx <= r1; rIdx++) {
+		int first = mCellStart[rIdx * mCols + c0];
+		int last = mCellStart[rIdx * mCols + c1 + 1];
+
+		for (int idx = first; idx < last; idx++)
+			indexes << mIndexes[idx];
+	}
+
+	std::sort(indexes.begin(), indexes.end());
+
+	return indexes;
+}
+
 // PixelConnector --------------------------------------------------------------------
 PixelConnector::PixelConnector() {
 }
@@ -883,6 +1101,48 @@ void PixelConnector::setStopLines(const QVector<Line>& stopLines) {
 	mStopLines = stopLines;
 }
 
+/// <summary>
+/// Connects the pixels and returns the edges as pixel indexes.
+/// The default implementation maps the PixelEdges of connect().
+/// Override it if the connector can find the indexes directly.
+/// </summary>
+/// <param name="pixels">The pixels.</param>
+/// <returns>The edges (IndexEdge::isNull() if a pixel is not part of pixels).</returns>
+QVector<IndexEdge> PixelConnector::connectIndexes(const QVector<QSharedPointer<Pixel> >& pixels) const {
+
+	QHash<const Pixel*, int> lookup;
+	lookup.reserve(pixels.size());
+	for (int idx = 0; idx < pixels.size(); idx++)
+		lookup.insert(pixels[idx].data(), idx);
+
+	QVector<IndexEdge> edges;
+	for (const QSharedPointer<PixelEdge>& e : connect(pixels))
+		edges << IndexEdge(lookup.value(e->first().data(), -1), lookup.value(e->second().data(), -1));
+
+	return edges;
+}
+
+/// <summary>
+/// Returns the median of lineSpacing * multiplier.
+/// It is used as cell size of the PixelGrid.
+/// </summary>
+/// <param name="pixels">The pixels.</param>
+/// <param name="multiplier">The line spacing multiplier.</param>
+/// <returns></returns>
+double PixelConnector::medianRadius(const QVector<QSharedPointer<Pixel> >& pixels, double multiplier) const {
+
+	QList<double> radii;
+	for (const QSharedPointer<Pixel>& px : pixels) {
+		if (px->stats())
+			radii << px->stats()->lineSpacing() * multiplier;
+	}
+
+	if (radii.isEmpty())
+		return 0.0;
+
+	return Algorithms::statMoment(radii, 0.5);
+}
+
 QVector<QSharedPointer<PixelEdge> > PixelConnector::filter(QVector<QSharedPointer<PixelEdge> >& edges) const {
 
 	// nothing to do?
@@ -913,12 +1173,58 @@ QVector<QSharedPointer<PixelEdge> > PixelConnector::filter(QVector<QSharedPointe
 	return filteredEdges;
 }
 
+/// <summary>
+/// Removes all edges that cross stop lines.
+/// </summary>
+void PixelConnector::filter(QVector<IndexEdge>& edges, const QVector<QSharedPointer<Pixel> >& pixels) const {
+
+	// nothing to do?
+	if (mStopLines.empty())
+		return;
+
+	auto crosses = [&](const IndexEdge& e) {
+
+		Line l(pixels[e.first()]->center(), pixels[e.second()]->center());
+
+		for (const Line& line : mStopLines) {
+			if (l.intersects(line))
+				return true;
+		}
+
+		return false;
+	};
+
+	edges.erase(std::remove_if(edges.begin(), edges.end(), crosses), edges.end());
+}
+
 // DelaunayPixelConnector --------------------------------------------------------------------
 DelaunayPixelConnector::DelaunayPixelConnector() : PixelConnector() {
 }
 
 QVector<QSharedPointer<PixelEdge>> DelaunayPixelConnector::connect(const QVector<QSharedPointer<Pixel> >& pixels) const {
 	
+	QVector<QSharedPointer<PixelEdge> > edges;
+	for (const IndexEdge& e : triangulate(pixels))
+		edges << QSharedPointer<PixelEdge>(new PixelEdge(pixels[e.first()], pixels[e.second()]));
+
+	// remove edges that cross stop lines
+	filter(edges);
+
+	return edges;
+}
+
+QVector<IndexEdge> DelaunayPixelConnector::connectIndexes(const QVector<QSharedPointer<Pixel> >& pixels) const {
+
+	QVector<IndexEdge> edges = triangulate(pixels);
+	
+	// remove edges that cross stop lines
+	filter(edges, pixels);
+
+	return edges;
+}
+
+QVector<IndexEdge> DelaunayPixelConnector::triangulate(const QVector<QSharedPointer<Pixel> >& pixels) const {
+
 	//Timer dt;
 	// Create an instance of Subdiv2D
 	QVector<Vector2D> pts;
@@ -932,26 +1238,31 @@ QVector<QSharedPointer<PixelEdge>> DelaunayPixelConnector::connect(const QVector
 
 	cv::Subdiv2D subdiv(rect.toCvRect());
 
-	QVector<int> ids;
-	for (const QSharedPointer<Pixel>& b : pixels) {
-		Vector2D np = b->center();
-		ids << subdiv.insert(np.toCvPoint2f());
+	// maps Subdiv2D vertex IDs to pixel indexes (pixels at the same position share a vertex)
+	QVector<int> vertexToPixel;
+	for (int idx = 0; idx < pixels.size(); idx++) {
+		
+		int vIdx = subdiv.insert(pts[idx].toCvPoint2f());
+
+		if (vIdx >= vertexToPixel.size())
+			vertexToPixel.resize(vIdx + 1, -1);
+
+		if (vertexToPixel[vIdx] == -1)
+			vertexToPixel[vIdx] = idx;
 	}
 	//qDebug() << "Delaunay triangulation (OpenCV)" << dt;
 
+	auto pixelIdx = [&](int vIdx) {
+		return vIdx >= 0 && vIdx < vertexToPixel.size() ? vertexToPixel[vIdx] : -1;
+	};
+
 	// that took me long... but this is how we can map the edges to our objects without an (expensive) lookup
-	QVector<QSharedPointer<PixelEdge> > edges;
+	QVector<IndexEdge> edges;
 	for (int idx = 0; idx < (pixels.size()-8)*3; idx++) {
 
-		//assert(subdiv.edgeOrg((idx << 2)) < ids.size() && subdiv.edgeOrg((idx << 2)) >= 0);
-		//assert(subdiv.edgeDst((idx << 2)) < ids.size() && subdiv.edgeDst((idx << 2)) >= 0);
-
-		// for debugging:
 		int ei = idx << 2;
-		int eio = subdiv.edgeOrg(ei);
-		int eid = subdiv.edgeDst(ei);
-		int orgVertex = ids.indexOf(eio);
-		int dstVertex = ids.indexOf(eid);
+		int orgVertex = pixelIdx(subdiv.edgeOrg(ei));
+		int dstVertex = pixelIdx(subdiv.edgeDst(ei));
 
 		// there are a few edges that lead to nowhere
 		if (orgVertex == -1 || dstVertex == -1) {
@@ -961,15 +1272,10 @@ QVector<QSharedPointer<PixelEdge>> DelaunayPixelConnector::connect(const QVector
 		assert(orgVertex >= 0 && orgVertex < pixels.size());
 		assert(dstVertex >= 0 && dstVertex < pixels.size());
 
-		QSharedPointer<PixelEdge> pe(new PixelEdge(pixels[orgVertex], pixels[dstVertex]));
-		edges << pe;
+		edges << IndexEdge(orgVertex, dstVertex);
 	}
 
-	// remove edges that cross stop lines
-	filter(edges);
-
 	return edges;
-
 }
 
 // RegionPixelConnector --------------------------------------------------------------------
@@ -988,6 +1294,8 @@ QVector<QSharedPointer<PixelEdge>> RegionPixelConnector::connect(const QVector<Q
 	Timer dt;
 	QVector<QSharedPointer<PixelEdge> > edges;
 
+	PixelGrid grid(pixels, (mRadius != 0.0) ? mRadius : medianRadius(pixels, mMultiplier));
+
 	for (const QSharedPointer<Pixel>& px : pixels) {
 
 		if (!px->stats() && mRadius == 0.0) {
@@ -998,7 +1306,9 @@ QVector<QSharedPointer<PixelEdge>> RegionPixelConnector::connect(const QVector<Q
 		double cR = (mRadius != 0.0) ? mRadius : px->stats()->lineSpacing() * mMultiplier;
 		const Vector2D& pxc = px->center();
 
-		for (const QSharedPointer<Pixel>& npx : pixels) {
+		for (int nIdx : grid.neighbors(pxc, cR)) {
+
+			const QSharedPointer<Pixel>& npx = pixels[nIdx];
 
 			if (npx->id() == px->id())
 				continue;
@@ -1029,6 +1339,9 @@ QVector<QSharedPointer<PixelEdge>> TabStopPixelConnector::connect(const QVector<
 	
 	QVector<QSharedPointer<PixelEdge> > edges;
 
+	// candidates are only searched within 3 * line spacing
+	PixelGrid grid(pixels, medianRadius(pixels, mMultiplier * 3));
+
 	for (const QSharedPointer<Pixel>& px : pixels) {
 
 		if (!px->stats()) {
@@ -1047,9 +1360,11 @@ QVector<QSharedPointer<PixelEdge>> TabStopPixelConnector::connect(const QVector<
 		QList<double> dists;
 		QVector<QSharedPointer<PixelEdge> > cEdges;
 
-		for (const QSharedPointer<Pixel>& npx : pixels) {
+		for (int nIdx : grid.neighbors(pxc, cR * 3)) {
 
-			if (npx->id() == px->id())
+			const QSharedPointer<Pixel>& npx = pixels[nIdx];
+
+			if (npx->id() == px->id() || !npx->stats())
 				continue;
 
 			// directely reject
@@ -1121,6 +1436,8 @@ DBScanPixel::DBScanPixel(const PixelSet& pixels) {
 
 void DBScanPixel::compute() {
 
+	rdfProfileScope("DBScan");
+
 	// estimate max distance?
 	if (mMaxDistance == 0)
 		mMaxDistance = mPixels.lineSpacing();
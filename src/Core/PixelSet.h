@@ -42,6 +42,8 @@
 #include <QSharedPointer>
 #include <QVector>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #pragma warning(pop)
 
 #ifndef DllCoreExport
@@ -61,6 +63,61 @@ namespace rdf {
 class TextLine;
 class PixelSet;
 
+/// <summary>
+/// Uniform grid over pixel centers.
+/// It is used to find all pixels within a radius
+/// without comparing each pixel with all others.
+/// The cell size should be in the order of the query radius.
+/// </summary>
+class DllCoreExport PixelGrid {
+
+public:
+	PixelGrid(const QVector<QSharedPointer<Pixel> >& pixels = QVector<QSharedPointer<Pixel> >(), double cellSize = 0.0);
+
+	bool isEmpty() const;
+	double cellSize() const;
+
+	QVector<int> neighbors(const Vector2D& center, double radius) const;
+
+protected:
+	Vector2D mOrigin;
+	double mCellSize = 1.0;
+	int mCols = 0;
+	int mRows = 0;
+
+	QVector<int> mCellStart;	// index of each cell's first pixel in mIndexes (size: #cells + 1)
+	QVector<int> mIndexes;		// pixel indexes sorted by cells
+};
+
+/// <summary>
+/// Index based edge.
+/// It connects two pixels by their index in the
+/// pixel vector (e.g. of a PixelGraph) and is
+/// used instead of PixelEdge objects if no
+/// edge specific data (weights, ids) is needed.
+/// </summary>
+class DllCoreExport IndexEdge {
+
+public:
+	IndexEdge(int first = -1, int second = -1) : mFirst(first), mSecond(second) {};
+
+	inline int first() const {
+		return mFirst;
+	};
+
+	inline int second() const {
+		return mSecond;
+	};
+
+	inline bool isNull() const {
+		return mFirst < 0 || mSecond < 0;
+	};
+
+private:
+	int mFirst = -1;
+	int mSecond = -1;
+};
+
 /// <summary>
 /// Abstract class PixelConnector.
 /// This is the base class for all
@@ -74,6 +131,7 @@ public:
 	PixelConnector();
 	
 	virtual QVector<QSharedPointer<PixelEdge> > connect(const QVector<QSharedPointer<Pixel> >& pixels) const = 0;
+	virtual QVector<IndexEdge> connectIndexes(const QVector<QSharedPointer<Pixel> >& pixels) const;
 	void setDistanceFunction(const PixelDistance::PixelDistanceFunction& distFnc);
 	void setStopLines(const QVector<Line>& stopLines);
 
@@ -82,6 +140,8 @@ protected:
 	QVector<Line> mStopLines;
 
 	QVector<QSharedPointer<PixelEdge> > filter(QVector<QSharedPointer<PixelEdge> >& edges) const;
+	void filter(QVector<IndexEdge>& edges, const QVector<QSharedPointer<Pixel> >& pixels) const;
+	double medianRadius(const QVector<QSharedPointer<Pixel> >& pixels, double multiplier) const;
 };
 
 /// <summary>
@@ -93,6 +153,10 @@ class DllCoreExport DelaunayPixelConnector : public PixelConnector {
 public:
 	DelaunayPixelConnector();
 	virtual QVector<QSharedPointer<PixelEdge> > connect(const QVector<QSharedPointer<Pixel> >& pixels) const override;
+	virtual QVector<IndexEdge> connectIndexes(const QVector<QSharedPointer<Pixel> >& pixels) const override;
+
+private:
+	QVector<IndexEdge> triangulate(const QVector<QSharedPointer<Pixel> >& pixels) const;
 };
 
 /// <summary>
@@ -408,13 +472,28 @@ private:
 /// Represents a pixel graph.
 /// This class comes in handy if you want
 /// to map pixel edges with pixels.
+/// Edges are always indexed (IndexEdge) with a
+/// compressed adjacency list. With storage_compact,
+/// PixelEdge objects are only created if they are
+/// requested (edges()) so that large graphs do not
+/// allocate an object (and id) per edge. Creating them
+/// is thread-safe so that const graphs can be shared.
+/// Only the edge storage is compact: pixels (and their
+/// PixelStats) are still shared pointers owned by the PixelSet.
 /// </summary>
 /// <seealso cref="BaseElement" />
 class DllCoreExport PixelGraph : public BaseElement {
 
 public:
+	enum Storage {
+		storage_shared = 0,		// [default] edges are PixelEdge objects
+		storage_compact,		// edges are indexes, PixelEdges are created on demand
+
+		storage_end
+	};
+
 	PixelGraph();
-	PixelGraph(const PixelSet& set);
+	PixelGraph(const PixelSet& set, const Storage& storage = storage_shared);
 
 	enum SortMode {
 		sort_none,
@@ -438,13 +517,26 @@ public:
 	int pixelIndex(const QString & pixelID) const;
 	QVector<int> edgeIndexes(const QString & pixelID) const;
 
+	Storage storage() const;
+	int numEdges() const;
+	QVector<IndexEdge> indexEdges() const;
+	QVector<int> edgeIndexes(int pixelIdx) const;
+
 protected:
 	PixelSet mSet;
-	QVector<QSharedPointer<PixelEdge> > mEdges;
+	Storage mStorage = storage_shared;
+	mutable QVector<QSharedPointer<PixelEdge> > mEdges;	// created on demand with storage_compact
+	QSharedPointer<QMutex> mEdgeMutex = QSharedPointer<QMutex>(new QMutex());	// guards the on demand creation
+
+	QVector<IndexEdge> mIndexEdges;
+	QVector<int> mEdgeStart;					// index of each pixel's first edge in mEdgeIndexes (size: #pixels + 1)
+	QVector<int> mEdgeIndexes;					// edge indexes sorted by their first pixel
 
-	QMap<QString, int> mPixelLookup;			// maps pixel IDs to their current vector index
-	QMap<QString, QVector<int> > mPixelEdges;	// maps pixel IDs to their corresponding edge index
+	QHash<QString, int> mPixelLookup;			// maps pixel IDs to their current vector index
+	QHash<QString, QVector<int> > mForeignEdges;	// edges of pixels that are not in the set (e.g. Voronoi)
 
+	void index();
+	const QVector<QSharedPointer<PixelEdge> >& sharedEdges() const;
 };
 
 /// <summary>
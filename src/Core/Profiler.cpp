@@ -0,0 +1,743 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "Profiler.h"
+#include "Utils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QFile>
+#include <QMap>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+#include <opencv2/core.hpp>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#pragma warning(pop)
+
+namespace rdf {
+
+namespace {
+
+	/// <summary>
+	/// The open stages of a thread.
+	/// </summary>
+	struct ThreadState {
+
+		struct OpenStage {
+			QString name;
+			QString path;
+			qint64 startNs = 0;
+			qint64 cpuNs = 0;
+			qint64 numAllocs = 0;
+			qint64 allocBytes = 0;
+			qint64 numLargeAllocs = 0;
+			qint64 liveBytes = 0;
+			qint64 parentPeak = 0;
+			bool memory = false;
+			qint64 rss = 0;
+			qint64 peakRss = 0;
+		};
+
+		int threadId = -1;
+		QVector<OpenStage> stack;
+
+		qint64 numAllocs = 0;
+		qint64 allocBytes = 0;
+		qint64 numLargeAllocs = 0;
+
+		// NOTE: memory may be released by another thread - so these are relative measures only
+		qint64 liveBytes = 0;		// allocated - deallocated bytes
+		qint64 peakBytes = 0;		// peak of liveBytes since the last stage was opened
+	};
+
+	thread_local ThreadState threadState;
+	QAtomicInt threadCounter(0);
+
+	ThreadState& currentThread() {
+
+		if (threadState.threadId == -1)
+			threadState.threadId = threadCounter.fetchAndAddOrdered(1) + 1;
+
+		return threadState;
+	}
+
+	/// <summary>
+	/// CPU time of the calling thread in ns.
+	/// </summary>
+	qint64 threadCpuNs() {
+
+#ifdef WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+			return 0;
+
+		// FILETIME is in 100 ns
+		qint64 k = ((qint64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+		qint64 u = ((qint64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+		return (k + u) * 100;
+#else
+		timespec ts;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+			return 0;
+
+		return (qint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+	}
+
+	double toMs(qint64 ns) {
+		return ns / 1e6;
+	}
+
+	double toMb(qint64 numBytes) {
+		return numBytes / (1024.0 * 1024.0);
+	}
+
+	const qint64 largeAllocation = 1 << 20;	// 1 MB
+	const int maxEvents = 1 << 18;			// max number of events kept for the trace
+
+	/// <summary>
+	/// Reports cv::Mat allocations to the Profiler.
+	/// It wraps OpenCV's allocator. Mats allocated by it are
+	/// re-assigned to this allocator so that their deallocation
+	/// is reported too.
+	/// </summary>
+	class MatAllocationHook : public cv::MatAllocator {
+
+	public:
+		MatAllocationHook(cv::MatAllocator* allocator) : mAllocator(allocator) {}
+
+		cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, int flags, cv::UMatUsageFlags usageFlags) const override {
+
+			cv::UMatData* u = mAllocator->allocate(dims, sizes, type, data, step, flags, usageFlags);
+
+			if (u) {
+				u->currAllocator = this;
+				u->prevAllocator = this;
+
+				// user data is not allocated by OpenCV
+				if (!data)
+					Profiler::addAllocation((qint64)u->size);
+			}
+
+			return u;
+		}
+
+		bool allocate(cv::UMatData* u, int accessFlags, cv::UMatUsageFlags usageFlags) const override {
+			return mAllocator->allocate(u, accessFlags, usageFlags);
+		}
+
+		void deallocate(cv::UMatData* u) const override {
+
+			if (!u)
+				return;
+
+			if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+				Profiler::addDeallocation((qint64)u->size);
+
+			u->currAllocator = mAllocator;
+			u->prevAllocator = mAllocator;
+			mAllocator->deallocate(u);
+		}
+
+		cv::MatAllocator* allocator() const {
+			return mAllocator;
+		}
+
+	private:
+		cv::MatAllocator* mAllocator = 0;
+	};
+}
+
+// StageStats --------------------------------------------------------------------
+StageStats::StageStats() {
+}
+
+/// <summary>
+/// Returns true if the stage was not recorded (e.g. the profiler is disabled).
+/// </summary>
+bool StageStats::isEmpty() const {
+	return mWallNs < 0;
+}
+
+/// <summary>
+/// Returns true if the memory was tracked for this stage.
+/// </summary>
+bool StageStats::hasMemory() const {
+	return mMemory;
+}
+
+QString StageStats::name() const {
+	return mName;
+}
+
+double StageStats::wallMs() const {
+	return toMs(mWallNs);
+}
+
+double StageStats::cpuMs() const {
+	return toMs(mCpuNs);
+}
+
+qint64 StageStats::numAllocations() const {
+	return mNumAllocs;
+}
+
+qint64 StageStats::allocatedBytes() const {
+	return mAllocBytes;
+}
+
+qint64 StageStats::numLargeAllocations() const {
+	return mNumLargeAllocs;
+}
+
+/// <summary>
+/// Returns the maximum of bytes that were allocated (and not yet released) at once.
+/// </summary>
+qint64 StageStats::peakAllocatedBytes() const {
+	return mPeakAllocBytes;
+}
+
+qint64 StageStats::residentStart() const {
+	return mRssStart;
+}
+
+qint64 StageStats::residentEnd() const {
+	return mRssEnd;
+}
+
+/// <summary>
+/// Returns the peak resident memory of the process at the end of the stage.
+/// </summary>
+qint64 StageStats::peakResident() const {
+	return mPeakRss;
+}
+
+/// <summary>
+/// Returns how much the stage raised the peak resident memory of the process.
+/// If this is > 0, the stage is responsible for the process' peak.
+/// </summary>
+qint64 StageStats::peakResidentIncrease() const {
+	return mPeakRssIncrease;
+}
+
+QJsonObject StageStats::toJson() const {
+
+	QJsonObject jo;
+
+	if (isEmpty())
+		return jo;
+
+	jo["stage"] = mName;
+	jo["wallMs"] = wallMs();
+	jo["cpuMs"] = cpuMs();
+
+	if (mNumAllocs > 0) {
+		jo["allocations"] = (double)mNumAllocs;
+		jo["allocatedBytes"] = (double)mAllocBytes;
+		jo["largeAllocations"] = (double)mNumLargeAllocs;
+		jo["peakAllocatedBytes"] = (double)mPeakAllocBytes;
+	}
+
+	if (mMemory) {
+		jo["residentStartBytes"] = (double)mRssStart;
+		jo["residentEndBytes"] = (double)mRssEnd;
+		jo["peakResidentBytes"] = (double)mPeakRss;
+		jo["peakResidentIncreaseBytes"] = (double)mPeakRssIncrease;
+	}
+
+	return jo;
+}
+
+QString StageStats::toString() const {
+
+	if (isEmpty())
+		return QString();
+
+	QString msg = " computed in " + QString::number(wallMs(), 'f', 1) + " ms";
+
+	if (mMemory) {
+		msg += " | RSS " + QString::number(toMb(mRssStart), 'f', 0) + " -> " + QString::number(toMb(mRssEnd), 'f', 0) + " MB";
+		msg += " | peak " + QString::number(toMb(mPeakRss), 'f', 0) + " MB (+" + QString::number(toMb(mPeakRssIncrease), 'f', 0) + " MB)";
+	}
+
+	if (mNumAllocs > 0) {
+		msg += " | " + QString::number(mNumAllocs) + " allocations (" + QString::number(toMb(mAllocBytes), 'f', 1) + " MB";
+		msg += ", " + QString::number(mNumLargeAllocs) + " large, peak " + QString::number(toMb(mPeakAllocBytes), 'f', 1) + " MB)";
+	}
+
+	return msg;
+}
+
+// Profiler --------------------------------------------------------------------
+Profiler::Profiler() {
+	mClock.start();
+}
+
+Profiler& Profiler::instance() {
+
+	// function statics are initialized thread-safe (C++11)
+	static Profiler inst;
+	return inst;
+}
+
+/// <summary>
+/// Enables or disables the profiler.
+/// Stages that are open while disabling are still recorded.
+/// </summary>
+void Profiler::setEnabled(bool enabled) {
+	mEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+bool Profiler::isEnabled() const {
+	return mEnabled.loadAcquire() != 0;
+}
+
+/// <summary>
+/// Tracks the resident memory and cv::Mat allocations of stages.
+/// This replaces OpenCV's default allocator - so it should be
+/// called before any processing starts (e.g. in the main).
+/// </summary>
+void Profiler::setMemoryTracking(bool track) {
+
+	// the hook is never deleted since Mats allocated by it might outlive the profiler
+	static MatAllocationHook* hook = 0;
+
+	if (track && !hook)
+		hook = new MatAllocationHook(cv::Mat::getDefaultAllocator());
+
+	if (hook)
+		cv::Mat::setDefaultAllocator(track ? hook : hook->allocator());
+
+	mMemoryTracking.storeRelease(track ? 1 : 0);
+}
+
+bool Profiler::isMemoryTracking() const {
+	return mMemoryTracking.loadAcquire() != 0;
+}
+
+/// <summary>
+/// Removes all recorded stages.
+/// </summary>
+void Profiler::clear() {
+
+	QMutexLocker lock(&mMutex);
+	mEvents.clear();
+	mStages.clear();
+	mNumDroppedEvents = 0;
+}
+
+/// <summary>
+/// Opens a new stage in the current thread.
+/// Prefer ScopedStage which guarantees that the stage is closed.
+/// </summary>
+/// <param name="name">The stage's name.</param>
+void Profiler::begin(const QString & name) {
+
+	ThreadState& ts = currentThread();
+
+	ThreadState::OpenStage s;
+	s.name = name;
+	s.path = ts.stack.isEmpty() ? name : ts.stack.last().path + "/" + name;
+	s.numAllocs = ts.numAllocs;
+	s.allocBytes = ts.allocBytes;
+	s.numLargeAllocs = ts.numLargeAllocs;
+
+	// reset the thread's peak so that we get the peak of this stage
+	s.liveBytes = ts.liveBytes;
+	s.parentPeak = ts.peakBytes;
+	ts.peakBytes = ts.liveBytes;
+
+	if (isMemoryTracking()) {
+		s.memory = true;
+		s.rss = Utils::currentMemory();
+		s.peakRss = Utils::peakMemory();
+	}
+
+	s.cpuNs = threadCpuNs();
+	s.startNs = mClock.nsecsElapsed();
+
+	ts.stack << s;
+}
+
+/// <summary>
+/// Closes the last stage of the current thread.
+/// </summary>
+/// <returns>The stage's measurements.</returns>
+StageStats Profiler::end() {
+
+	qint64 endNs = mClock.nsecsElapsed();
+	qint64 cpuNs = threadCpuNs();
+
+	ThreadState& ts = currentThread();
+
+	if (ts.stack.isEmpty()) {
+		qWarning() << "[Profiler] end() called without an open stage";
+		return StageStats();
+	}
+
+	ThreadState::OpenStage s = ts.stack.takeLast();
+
+	Event e;
+	e.name = s.name;
+	e.path = s.path;
+	e.threadId = ts.threadId;
+	e.depth = ts.stack.size();
+	e.startNs = s.startNs;
+	e.wallNs = endNs - s.startNs;
+	e.cpuNs = cpuNs - s.cpuNs;
+	e.numAllocs = ts.numAllocs - s.numAllocs;
+	e.allocBytes = ts.allocBytes - s.allocBytes;
+	e.numLargeAllocs = ts.numLargeAllocs - s.numLargeAllocs;
+	e.peakAllocBytes = qMax(ts.peakBytes - s.liveBytes, 0LL);
+
+	// propagate the peak to the parent stage
+	ts.peakBytes = qMax(ts.peakBytes, s.parentPeak);
+
+	if (s.memory) {
+		e.memory = true;
+		e.rssStart = s.rss;
+		e.rssEnd = Utils::currentMemory();
+		e.peakRss = Utils::peakMemory();
+		e.peakRssIncrease = e.peakRss - s.peakRss;
+	}
+
+	StageStats stats;
+	stats.mName = e.name;
+	stats.mWallNs = e.wallNs;
+	stats.mCpuNs = e.cpuNs;
+	stats.mNumAllocs = e.numAllocs;
+	stats.mAllocBytes = e.allocBytes;
+	stats.mNumLargeAllocs = e.numLargeAllocs;
+	stats.mPeakAllocBytes = e.peakAllocBytes;
+	stats.mMemory = e.memory;
+	stats.mRssStart = e.rssStart;
+	stats.mRssEnd = e.rssEnd;
+	stats.mPeakRss = e.peakRss;
+	stats.mPeakRssIncrease = e.peakRssIncrease;
+
+	QMutexLocker lock(&mMutex);
+
+	Stage& st = mStages[e.path];
+
+	if (st.calls == 0) {
+		st.path = e.path;
+		st.minNs = e.wallNs;
+		st.maxNs = e.wallNs;
+	}
+
+	st.calls++;
+	st.wallNs += e.wallNs;
+	st.selfNs += e.wallNs;
+	st.cpuNs += e.cpuNs;
+	st.minNs = qMin(st.minNs, e.wallNs);
+	st.maxNs = qMax(st.maxNs, e.wallNs);
+	st.numAllocs += e.numAllocs;
+	st.allocBytes += e.allocBytes;
+	st.numLargeAllocs += e.numLargeAllocs;
+	st.peakAllocBytes = qMax(st.peakAllocBytes, e.peakAllocBytes);
+
+	if (e.memory) {
+		st.memory = true;
+		st.rssDelta = qMax(st.rssDelta, e.rssEnd - e.rssStart);
+		st.peakRss = qMax(st.peakRss, e.peakRss);
+		st.peakRssIncrease += e.peakRssIncrease;
+	}
+
+	// subtract the time from the parent (which is closed later)
+	int pIdx = e.path.lastIndexOf("/");
+	if (pIdx != -1)
+		mStages[e.path.left(pIdx)].selfNs -= e.wallNs;
+
+	if (mEvents.size() < maxEvents)
+		mEvents << e;
+	else if (mNumDroppedEvents++ == 0)
+		qWarning() << "[Profiler] more than" << maxEvents << "events - the trace is truncated";
+
+	return stats;
+}
+
+/// <summary>
+/// Reports an allocation of the current thread.
+/// Allocation hooks (e.g. a cv::MatAllocator) can call this
+/// so that allocations are counted per stage.
+/// </summary>
+/// <param name="numBytes">The number of bytes allocated.</param>
+void Profiler::addAllocation(qint64 numBytes) {
+
+	ThreadState& ts = currentThread();
+	ts.numAllocs++;
+	ts.allocBytes += numBytes;
+
+	if (numBytes >= largeAllocation)
+		ts.numLargeAllocs++;
+
+	ts.liveBytes += numBytes;
+	ts.peakBytes = qMax(ts.peakBytes, ts.liveBytes);
+}
+
+/// <summary>
+/// Reports a deallocation of the current thread.
+/// </summary>
+/// <param name="numBytes">The number of bytes released.</param>
+void Profiler::addDeallocation(qint64 numBytes) {
+
+	ThreadState& ts = currentThread();
+	ts.liveBytes -= numBytes;
+}
+
+/// <summary>
+/// Allocations with at least this size (in bytes) are counted as large allocations.
+/// </summary>
+qint64 Profiler::largeAllocationSize() {
+	return largeAllocation;
+}
+
+/// <summary>
+/// The maximal number of events that are kept for the trace.
+/// Later events are still aggregated (see summary()).
+/// </summary>
+int Profiler::maxTraceEvents() {
+	return maxEvents;
+}
+
+/// <summary>
+/// Returns all stages aggregated w.r.t. their path.
+/// The self time is the wall time without the time of child stages.
+/// </summary>
+QVector<Profiler::Stage> Profiler::stages() const {
+
+	QVector<Stage> stages;
+
+	QMutexLocker lock(&mMutex);
+
+	// QMap sorts parents before their children
+	for (const Stage& s : mStages) {
+
+		// skip parents that are still open
+		if (s.calls > 0)
+			stages << s;
+	}
+
+	return stages;
+}
+
+/// <summary>
+/// Returns the aggregated stages (calls, wall, self and CPU time).
+/// </summary>
+QJsonObject Profiler::summary() const {
+
+	QJsonArray ja;
+
+	for (const Stage& s : stages()) {
+
+		QJsonObject so;
+		so["stage"] = s.path;
+		so["calls"] = s.calls;
+		so["wallMs"] = toMs(s.wallNs);
+		so["selfMs"] = toMs(s.selfNs);
+		so["cpuMs"] = toMs(s.cpuNs);
+		so["minMs"] = toMs(s.minNs);
+		so["maxMs"] = toMs(s.maxNs);
+
+		if (s.numAllocs > 0) {
+			so["allocations"] = (double)s.numAllocs;
+			so["allocatedBytes"] = (double)s.allocBytes;
+			so["largeAllocations"] = (double)s.numLargeAllocs;
+			so["peakAllocatedBytes"] = (double)s.peakAllocBytes;
+		}
+
+		if (s.memory) {
+			so["residentDeltaBytes"] = (double)s.rssDelta;
+			so["peakResidentBytes"] = (double)s.peakRss;
+			so["peakResidentIncreaseBytes"] = (double)s.peakRssIncrease;
+		}
+
+		ja << so;
+	}
+
+	QJsonObject jo;
+	jo["stages"] = ja;
+
+	if (isMemoryTracking())
+		jo["peakResidentBytes"] = (double)Utils::peakMemory();
+
+	return jo;
+}
+
+/// <summary>
+/// Returns all stages in the Chrome trace event format.
+/// The JSON can be loaded with chrome://tracing or https://ui.perfetto.dev.
+/// Only the first maxTraceEvents() events are written.
+/// </summary>
+QJsonObject Profiler::trace() const {
+
+	QJsonArray events;
+	qint64 pid = QCoreApplication::applicationPid();
+
+	QMutexLocker lock(&mMutex);
+
+	for (const Event& e : mEvents) {
+
+		QJsonObject args;
+		args["cpuMs"] = toMs(e.cpuNs);
+		args["path"] = e.path;
+
+		if (e.numAllocs > 0) {
+			args["allocations"] = (double)e.numAllocs;
+			args["allocatedBytes"] = (double)e.allocBytes;
+			args["peakAllocatedBytes"] = (double)e.peakAllocBytes;
+		}
+
+		if (e.memory) {
+			args["residentStartBytes"] = (double)e.rssStart;
+			args["residentEndBytes"] = (double)e.rssEnd;
+			args["peakResidentBytes"] = (double)e.peakRss;
+		}
+
+		// complete events - timestamps are in us
+		QJsonObject eo;
+		eo["name"] = e.name;
+		eo["cat"] = "rdf";
+		eo["ph"] = "X";
+		eo["ts"] = e.startNs / 1e3;
+		eo["dur"] = e.wallNs / 1e3;
+		eo["pid"] = (double)pid;
+		eo["tid"] = e.threadId;
+		eo["args"] = args;
+
+		events << eo;
+	}
+
+	QJsonObject jo;
+	jo["traceEvents"] = events;
+	jo["displayTimeUnit"] = "ms";
+
+	if (mNumDroppedEvents > 0) {
+		QJsonObject od;
+		od["droppedEvents"] = (double)mNumDroppedEvents;
+		jo["otherData"] = od;
+	}
+
+	return jo;
+}
+
+QString Profiler::toString() const {
+
+	bool memory = isMemoryTracking();
+
+	QString msg = "[Profiler] stage | calls | wall ms | self ms | cpu ms | allocations";
+	
+	if (memory)
+		msg += " | alloc MB | peak alloc MB | RSS delta MB | peak RSS MB (+MB)";
+
+	for (const Stage& s : stages()) {
+
+		int depth = s.path.count("/");
+		QString name = s.path.mid(s.path.lastIndexOf("/") + 1);
+
+		msg += "\n" + QString(2 * depth, ' ') + name;
+		msg += " | " + QString::number(s.calls);
+		msg += " | " + QString::number(toMs(s.wallNs), 'f', 1);
+		msg += " | " + QString::number(toMs(s.selfNs), 'f', 1);
+		msg += " | " + QString::number(toMs(s.cpuNs), 'f', 1);
+		msg += " | " + QString::number(s.numAllocs);
+
+		if (memory) {
+			msg += " | " + QString::number(toMb(s.allocBytes), 'f', 1);
+			msg += " | " + QString::number(toMb(s.peakAllocBytes), 'f', 1);
+			msg += " | " + QString::number(toMb(s.rssDelta), 'f', 1);
+			msg += " | " + QString::number(toMb(s.peakRss), 'f', 0) + " (+" + QString::number(toMb(s.peakRssIncrease), 'f', 0) + ")";
+		}
+	}
+
+	return msg;
+}
+
+/// <summary>
+/// Writes the aggregated stages to a JSON file.
+/// </summary>
+bool Profiler::writeSummary(const QString & filePath) const {
+	return write(summary(), filePath);
+}
+
+/// <summary>
+/// Writes a Chrome/Perfetto compatible trace file.
+/// </summary>
+bool Profiler::writeTrace(const QString & filePath) const {
+	return write(trace(), filePath);
+}
+
+bool Profiler::write(const QJsonObject & jo, const QString & filePath) {
+
+	QFile file(filePath);
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "[Profiler] cannot write to" << filePath;
+		return false;
+	}
+
+	file.write(QJsonDocument(jo).toJson(QJsonDocument::Compact));
+
+	return true;
+}
+
+// ScopedStage --------------------------------------------------------------------
+ScopedStage::ScopedStage(const QString & name, StageStats* stats) {
+
+	Profiler& p = Profiler::instance();
+	mStats = stats;
+
+	if (p.isEnabled()) {
+		p.begin(name);
+		mActive = true;
+	}
+}
+
+ScopedStage::~ScopedStage() {
+
+	if (mActive) {
+		StageStats s = Profiler::instance().end();
+
+		if (mStats)
+			*mStats = s;
+	}
+}
+
+}
@@ -0,0 +1,226 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QString>
+#include <QMap>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#pragma warning(pop)
+
+#pragma warning (disable: 4251)	// inlined Qt functions in dll interface
+
+#ifndef DllCoreExport
+#ifdef DLL_CORE_EXPORT
+#define DllCoreExport Q_DECL_EXPORT
+#else
+#define DllCoreExport Q_DECL_IMPORT
+#endif
+#endif
+
+// profiles the current scope (if the Profiler is enabled)
+// the name is only evaluated if the Profiler is enabled
+// e.g. rdfProfileScope("layer " + QString::number(idx));
+#define RDF_PROFILE_CONCAT_INTERN(a, b) a##b
+#define RDF_PROFILE_CONCAT(a, b) RDF_PROFILE_CONCAT_INTERN(a, b)
+#define rdfProfileScope(name) rdf::ScopedStage RDF_PROFILE_CONCAT(rdfStage, __LINE__)(rdf::Profiler::instance().isEnabled() ? QString(name) : QString())
+
+// Qt defines
+
+namespace rdf {
+
+/// <summary>
+/// Measurements of a single stage.
+/// Memory measurements are only available if the
+/// profiler tracks memory (see Profiler::setMemoryTracking).
+/// </summary>
+class DllCoreExport StageStats {
+
+public:
+	StageStats();
+
+	bool isEmpty() const;
+	bool hasMemory() const;
+
+	QString name() const;
+	double wallMs() const;
+	double cpuMs() const;
+
+	qint64 numAllocations() const;
+	qint64 allocatedBytes() const;
+	qint64 numLargeAllocations() const;
+	qint64 peakAllocatedBytes() const;
+
+	qint64 residentStart() const;
+	qint64 residentEnd() const;
+	qint64 peakResident() const;
+	qint64 peakResidentIncrease() const;
+
+	QJsonObject toJson() const;
+	QString toString() const;
+
+private:
+	friend class Profiler;
+
+	QString mName;
+	qint64 mWallNs = -1;
+	qint64 mCpuNs = 0;
+
+	qint64 mNumAllocs = 0;
+	qint64 mAllocBytes = 0;
+	qint64 mNumLargeAllocs = 0;		// allocations >= Profiler::largeAllocationSize
+	qint64 mPeakAllocBytes = 0;		// peak of (live) allocated bytes w.r.t. the stage start
+
+	bool mMemory = false;
+	qint64 mRssStart = 0;			// resident memory at the stage start
+	qint64 mRssEnd = 0;				// resident memory at the stage end
+	qint64 mPeakRss = 0;			// the process' peak resident memory at the stage end
+	qint64 mPeakRssIncrease = 0;	// how much the stage raised the process' peak
+};
+
+/// <summary>
+/// Records named and nested processing stages.
+/// Stages are opened with a ScopedStage (see rdfProfileScope). Nested
+/// stages of the same thread form a hierarchy (e.g. LayoutAnalysis/SuperPixel/MSER).
+/// For each stage the wall time, the thread's CPU time and the
+/// number of allocations (if reported with addAllocation) are stored.
+/// The profiler is disabled by default - then a stage costs one atomic read.
+/// If memory tracking is enabled, the resident memory is sampled at stage
+/// boundaries and cv::Mat allocations are counted per stage.
+/// Stages are aggregated when they are closed. Single events (see trace())
+/// are only kept up to maxTraceEvents() so that long batch runs do not grow
+/// without limit.
+/// </summary>
+class DllCoreExport Profiler {
+
+public:
+	static Profiler& instance();
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const;
+	void setMemoryTracking(bool track);
+	bool isMemoryTracking() const;
+	void clear();
+
+	void begin(const QString& name);
+	StageStats end();
+
+	static void addAllocation(qint64 numBytes);
+	static void addDeallocation(qint64 numBytes);
+	static qint64 largeAllocationSize();
+	static int maxTraceEvents();
+
+	QJsonObject summary() const;
+	QJsonObject trace() const;
+	QString toString() const;
+
+	bool writeSummary(const QString& filePath) const;
+	bool writeTrace(const QString& filePath) const;
+
+private:
+	Profiler();
+	Profiler(const Profiler&);
+
+	struct Event {
+		QString name;
+		QString path;			// e.g. LayoutAnalysis/SuperPixel
+		int threadId = 0;
+		int depth = 0;
+		qint64 startNs = 0;		// w.r.t. the profiler's clock
+		qint64 wallNs = 0;
+		qint64 cpuNs = 0;
+		qint64 numAllocs = 0;
+		qint64 allocBytes = 0;
+		qint64 numLargeAllocs = 0;
+		qint64 peakAllocBytes = 0;
+		bool memory = false;
+		qint64 rssStart = 0;
+		qint64 rssEnd = 0;
+		qint64 peakRss = 0;
+		qint64 peakRssIncrease = 0;
+	};
+
+	struct Stage {
+		QString path;
+		int calls = 0;
+		qint64 wallNs = 0;
+		qint64 selfNs = 0;
+		qint64 cpuNs = 0;
+		qint64 minNs = 0;
+		qint64 maxNs = 0;
+		qint64 numAllocs = 0;
+		qint64 allocBytes = 0;
+		qint64 numLargeAllocs = 0;
+		qint64 peakAllocBytes = 0;		// max
+		bool memory = false;
+		qint64 rssDelta = 0;			// max (end - start)
+		qint64 peakRss = 0;				// max
+		qint64 peakRssIncrease = 0;		// sum
+	};
+
+	QAtomicInt mEnabled;
+	QAtomicInt mMemoryTracking;
+	QElapsedTimer mClock;
+
+	mutable QMutex mMutex;
+	QVector<Event> mEvents;			// capped to maxTraceEvents()
+	QMap<QString, Stage> mStages;	// all events aggregated w.r.t. their path
+	qint64 mNumDroppedEvents = 0;
+
+	QVector<Stage> stages() const;
+	static bool write(const QJsonObject& jo, const QString& filePath);
+};
+
+/// <summary>
+/// Profiles a stage from its construction to its destruction.
+/// If stats are provided, they are updated when the stage is closed.
+/// </summary>
+class DllCoreExport ScopedStage {
+
+public:
+	ScopedStage(const QString& name, StageStats* stats = 0);
+	~ScopedStage();
+
+private:
+	ScopedStage(const ScopedStage&);
+	ScopedStage& operator=(const ScopedStage&);
+
+	bool mActive = false;
+	StageStats* mStats = 0;		// if set, the stage's results are written to it
+};
+
+}
@@ -71,7 +71,7 @@ int ScaleFactoryConfig::dpi() const {
 	return ModuleConfig::checkParam(mDpi, 1, 3000, "dpi");
 }
 
-void ScaleFactoryConfig::load(const QSettings & settings) {
+void ScaleFactoryConfig::load(const ConfigSnapshot & settings) {
 
 	mScaleMode = (ScaleFactoryConfig::ScaleSideMode)settings.value("scaleMode", scaleMode()).toInt();
 	mMaxImageSide = settings.value("maxImageSide", maxImageSide()).toInt();
@@ -128,6 +128,10 @@ cv::Mat ScaleFactory::scaled(cv::Mat & img) {
 
 	double sf = ScaleFactory::scaleFactor();
 
+	// images decoded at reduced resolution (see ImageReader) are already scaled
+	if (sf != 1.0 && img.cols == qRound(mImgSize.x() * sf) && img.rows == qRound(mImgSize.y() * sf))
+		return sImg;
+
 	// resize if necessary
 	if (sf != 1.0) {
 		cv::resize(sImg, sImg, cv::Size(), sf, sf, CV_INTER_LINEAR);
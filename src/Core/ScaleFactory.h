@@ -83,7 +83,7 @@ public:
 
 protected:
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	// 1000px == 100dpi @ A4
@@ -79,7 +79,7 @@ int GlobalConfig::numScales() const {
 	return mNumScales;
 }
 
-void GlobalConfig::load(const QSettings& settings) {
+void GlobalConfig::load(const ConfigSnapshot& settings) {
 
 	mWorkingDir = settings.value("workingDir", workingDir()).toString();
 	mXmlSubDir = settings.value("xmlSubDir", xmlSubDir()).toString();
@@ -124,6 +124,7 @@ void Config::setSettingsFile(const QString& filePath) {
 	if (fileInfo.exists()) {
 		mSettingsPath = fileInfo.absolutePath();
 		mSettingsFileName = fileInfo.fileName();
+		reload();
 	}
 }
 
@@ -149,15 +150,50 @@ QString Config::settingsPath() const {
 
 void Config::load() {
 
-	QSettings s(settingsFilePath(), QSettings::IniFormat);
-	mGlobal.loadSettings(s);
+	reload();
+	mGlobal.loadSettings(*snapshot());
 	qInfo() << "[READ] loading settings from" << settingsFilePath();
 }
 
 void Config::save() const {
 
-	QSettings s(settingsFilePath(), QSettings::IniFormat);
-	mGlobal.saveSettings(s);
+	{
+		QSettings s(settingsFilePath(), QSettings::IniFormat);
+		mGlobal.saveSettings(s);
+	}
+
+	reload();
+}
+
+/// <summary>
+/// Parses the settings file into a new snapshot.
+/// The snapshot is swapped atomically: modules that
+/// are created afterwards see the new values while
+/// readers of the old snapshot are not affected.
+/// </summary>
+void Config::reload() const {
+
+	QSharedPointer<const ConfigSnapshot> cs;
+	
+	// parse without holding the lock
+	{
+		QSettings s(settingsFilePath(), QSettings::IniFormat);
+		cs = QSharedPointer<const ConfigSnapshot>(new ConfigSnapshot(s));
+	}
+
+	QMutexLocker lock(&mSnapshotMutex);
+	mSnapshot = cs;
+}
+
+/// <summary>
+/// Returns the current (immutable) snapshot of the settings file.
+/// Module configs load their parameters from this snapshot
+/// so that the settings file is not parsed for every module.
+/// </summary>
+QSharedPointer<const ConfigSnapshot> Config::snapshot() const {
+
+	QMutexLocker lock(&mSnapshotMutex);
+	return mSnapshot;
 }
 
 }
\ No newline at end of file
@@ -37,6 +37,7 @@
 #pragma warning(push, 0)	// no warnings from includes
 #include <QSharedPointer>
 #include <QSettings>
+#include <QMutex>
 #pragma warning(pop)
 
 #pragma warning (disable: 4251)	// inlined Qt functions in dll interface
@@ -84,7 +85,7 @@ protected:
 	// this value is assigned by ScaleSpaceSuperPixel
 	int mNumScales = 1;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -98,6 +99,9 @@ public:
 	void load();
 	void save() const;
 
+	void reload() const;
+	QSharedPointer<const ConfigSnapshot> snapshot() const;
+
 	bool isPortable() const;
 	void setSettingsFile(const QString& filePath);
 	QString settingsFilePath() const;
@@ -112,6 +116,10 @@ private:
 	QString mSettingsFileName = "rdf-settings.ini";
 	QString mSettingsPath = "";
 
+	// the parsed settings file - swapped on reload()
+	mutable QMutex mSnapshotMutex;
+	mutable QSharedPointer<const ConfigSnapshot> mSnapshot;
+
 };
 
 }
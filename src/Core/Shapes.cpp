@@ -54,6 +54,10 @@ void Polygon::read(const QString & pointList) {
 	mPoly = Converter::stringToPoly(pointList);
 }
 
+void Polygon::read(const QStringRef & pointList) {
+	mPoly = Converter::stringToPoly(pointList);
+}
+
 QString Polygon::write() const {
 	return Converter::polyToString(mPoly.toPolygon());
 }
@@ -236,6 +240,10 @@ void BaseLine::read(const QString & pointList) {
 	mBaseLine = Converter::stringToPoly(pointList);
 }
 
+void BaseLine::read(const QStringRef & pointList) {
+	mBaseLine = Converter::stringToPoly(pointList);
+}
+
 QString BaseLine::write() const {
 	return Converter::polyToString(toPolygon());
 }
@@ -481,6 +481,7 @@ public:
 	void translate(const QPointF& offset);
 
 	void read(const QString& pointList);
+	void read(const QStringRef& pointList);
 	QString write() const;
 
 	QPointF startPoint() const;
@@ -505,6 +506,7 @@ public:
 	bool isEmpty() const;
 
 	void read(const QString& pointList);
+	void read(const QStringRef& pointList);
 	QString write() const;
 
 	void translate(const QPointF& offset);
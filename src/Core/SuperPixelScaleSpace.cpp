@@ -54,7 +54,7 @@ int ScaleSpaceSPConfig::minLayer() const {
 	return checkParam(mMinLayer, 0, numLayers() - 1, "minLayer");
 }
 
-void ScaleSpaceSPConfig::load(const QSettings & settings) {
+void ScaleSpaceSPConfig::load(const ConfigSnapshot & settings) {
 
 	mNumLayers = settings.value("numLayers", numLayers()).toInt();
 	mMinLayer = settings.value("minLayer", minLayer()).toInt();
@@ -37,6 +37,7 @@
 #include "Image.h"
 #include "ImageProcessor.h"
 #include "Settings.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <opencv2/core.hpp>
@@ -70,7 +71,7 @@ protected:
 	int mNumLayers = 3;
 	int mMinLayer = 0;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -94,6 +95,7 @@ public:
 		if (!checkInput())
 			return false;
 
+		rdfProfileScope("ScaleSpaceSuperPixel");
 		Timer dt;
 
 		cv::Mat img = mSrcImg.clone();
@@ -109,6 +111,8 @@ public:
 			// compute super pixel
 			if (config()->minLayer() <= idx) {
 
+				rdfProfileScope("layer " + QString::number(idx));
+
 				SuperPixelModule spm(img);
 				spm.setPyramidLevel(idx);
 				qDebug() << "computing new layer...";
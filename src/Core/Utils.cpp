@@ -48,6 +48,8 @@
 #include <QUrl>
 #include <QDateTime>
 
+#include <limits>
+
 #include <opencv2/core.hpp>
 #include "opencv2/imgproc.hpp"
 #pragma warning(pop)
@@ -56,6 +58,12 @@
 #ifdef WIN32
 #include "shlwapi.h"
 #pragma comment (lib, "shlwapi.lib")
+#include "psapi.h"
+#pragma comment (lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
 #endif
 
 
@@ -268,6 +276,55 @@ QString Utils::timeStampFileName(const QString & attribute, const QString & suff
 	return attribute + " " + ts + suffix;
 }
 
+/// <summary>
+/// Returns the peak resident memory (working set) of the process in bytes.
+/// </summary>
+int64 Utils::peakMemory() {
+
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (int64)pmc.PeakWorkingSetSize;
+#else
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#ifdef __APPLE__
+		return (int64)ru.ru_maxrss;			// bytes
+#else
+		return (int64)ru.ru_maxrss * 1024;	// kB
+#endif
+	}
+#endif
+
+	return 0;
+}
+
+/// <summary>
+/// Returns the current resident memory (working set) of the process in bytes.
+/// On Linux, it is read from /proc/self/statm.
+/// </summary>
+int64 Utils::currentMemory() {
+
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (int64)pmc.WorkingSetSize;
+#elif defined(__linux__)
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (f) {
+
+		long size = 0, resident = 0;
+		int n = fscanf(f, "%ld %ld", &size, &resident);
+		fclose(f);
+
+		if (n == 2)
+			return (int64)resident * sysconf(_SC_PAGESIZE);
+	}
+#endif
+
+	return 0;
+}
+
 /// <summary>
 /// Returns the filePath without suffix.
 /// C:/temp/something.png -> C:/temp/something
@@ -427,28 +484,72 @@ cv::Rect2d Converter::qRectToCv(const QRectF & r) {
 /// <param name="pointList">A string containing the point list.</param>
 /// <returns>A QPolygon parsed from the point list.</returns>
 QPolygon Converter::stringToPoly(const QString& pointList) {
+	return stringToPoly(QStringRef(&pointList));
+}
+
+/// <summary>
+/// Converts a PAGE points attribute to a polygon.
+/// The points are parsed in-place so that no
+/// temporary strings are allocated per point pair.
+/// the format is: p1x,p1y p2x,p2y (for two points p1, p2)
+/// </summary>
+/// <param name="pointList">A string reference (e.g. an XML attribute) containing the point list.</param>
+/// <returns>A QPolygon parsed from the point list.</returns>
+QPolygon Converter::stringToPoly(const QStringRef& pointList) {
+
+	// parses a (signed) integer and moves c behind its last digit
+	auto parseInt = [](const QChar*& c, const QChar* end, int& val) -> bool {
+
+		bool negative = false;
+		if (c < end && (*c == QLatin1Char('-') || *c == QLatin1Char('+'))) {
+			negative = *c == QLatin1Char('-');
+			c++;
+		}
+
+		const QChar* first = c;
+		qint64 v = 0;
+		for (; c < end && c->unicode() >= '0' && c->unicode() <= '9'; c++) {
+			v = v * 10 + (c->unicode() - '0');
+
+			if (v > std::numeric_limits<int>::max())
+				return false;
+		}
+
+		val = negative ? (int)-v : (int)v;
+		return c != first;
+	};
 
 	// we expect point pairs like that: <Coords points="1077,482 1167,482 1167,547 1077,547"/>
-	QStringList pairs = pointList.split(" ");
 	QPolygon poly;
+	const QChar* c = pointList.constData();
+	const QChar* end = c + pointList.size();
 
-	for (const QString pair : pairs) {
-
-		QStringList points = pair.split(",");
+	while (c < end) {
 
-		if (points.size() != 2) {
-			qWarning() << "illegal point string: " << pair;
+		if (c->isSpace()) {
+			c++;
 			continue;
 		}
 
-		bool xok = false, yok = false;
-		int x = points[0].toInt(&xok);
-		int y = points[1].toInt(&yok);
+		const QChar* pairStart = c;
+		int x = 0, y = 0;
 
-		if (xok && yok)
+		bool ok = parseInt(c, end, x) && c < end && *c == QLatin1Char(',');
+		if (ok) {
+			c++;
+			ok = parseInt(c, end, y) && (c == end || c->isSpace());
+		}
+
+		if (ok) {
 			poly.append(QPoint(x, y));
-		else
-			qWarning() << "illegal point string: " << pair;
+			continue;
+		}
+
+		// skip the illegal pair
+		while (c < end && !c->isSpace())
+			c++;
+
+		qWarning() << "illegal point string: " << QString(pairStart, (int)(c - pairStart));
 	}
 
 	return poly;
@@ -85,6 +85,8 @@ public:
 	static QString createFilePath(const QString& filePath, const QString& attribute, const QString& newSuffix = QString());
 	static QString timeStampFileName(const QString& attribute = "", const QString& suffix = ".txt");
 	static QString baseName(const QString& filePath);
+	static int64 peakMemory();
+	static int64 currentMemory();
 
 	static QJsonObject readJson(const QString& filePath);
 	static int64 writeJson(const QString& filePath, const QJsonObject& jo);
@@ -113,6 +115,7 @@ class DllCoreExport Converter {
 
 public:
 	static QPolygon stringToPoly(const QString& pointList);
+	static QPolygon stringToPoly(const QStringRef& pointList);
 	static QString polyToString(const QPolygon& poly);
 
 	static QPointF cvPointToQt(const cv::Point& pt);
@@ -167,6 +167,7 @@ void LayoutTest::testComponents() {
 	//testFeatureCollector(imgCv);
 	//testTrainer();
 	//testClassifier(imgCv);
+	//benchmarkClassifier(imgCv);
 	//pageSegmentation(imgCv);
 	//testLayout(imgCv);
 	layoutToXml();
@@ -178,16 +179,19 @@ void LayoutTest::testComponents() {
 	qInfo() << "total computation time:" << dt;
 }
 
-void LayoutTest::layoutToXml() const {
+bool LayoutTest::layoutToXml() const {
 
-	QImage imgQt(mConfig.imagePath());
-	cv::Mat img = Image::qImage2Mat(imgQt);
-
-	if (img.empty()) {
+	// decode at the resolution the layout analysis works with
+	rdf::ImageReader reader(mConfig.imagePath());
+	
+	if (!reader.read()) {
 		qWarning() << "could not load image from" << mConfig.imagePath();
-		return;
+		return false;
 	}
 
+	cv::Mat img = reader.image();
+	qInfo().noquote() << reader.toString();
+
 	Timer dt;
 	QString loadXmlPath = rdf::PageXmlParser::imagePathToXmlPath(mConfig.imagePath());
 
@@ -199,12 +203,14 @@ void LayoutTest::layoutToXml() const {
 	auto pe = parser.page();
 
 	rdf::LayoutAnalysis la(img);
+	la.setScaleFactory(reader.scaleFactory());
 	la.setRootRegion(pe->rootRegion());
 	la.config()->saveDefaultSettings();	// save default layout settings
 	la.config()->setClassiferPath(mConfig.classifierPath());
 	//la.config()->setRemoveWeakTextLines(false);
 
-	if (!la.compute())
+	bool computed = la.compute();
+	if (!computed)
 		qWarning() << "could not compute layout analysis";
 
 	// drawing --------------------------------------------------------------------
@@ -224,7 +230,7 @@ void LayoutTest::layoutToXml() const {
 
 	// write to XML --------------------------------------------------------------------
 	pe->setCreator(QString("CVL"));
-	pe->setImageSize(QSize(img.cols, img.rows));
+	pe->setImageSize(reader.originalSize());
 	pe->setImageFileName(QFileInfo(mConfig.imagePath()).fileName());
 
 	//pe->setRootRegion(la.textBlockSet().toTextRegion());
@@ -237,9 +243,11 @@ void LayoutTest::layoutToXml() const {
 			pe->rootRegion()->addUniqueChild(r, true);
 	}
 
-	parser.write(mConfig.xmlPath(), pe);
+	bool written = parser.write(mConfig.xmlPath(), pe);
 
 	qInfo() << "layout analysis computed in" << dt;
+
+	return computed && written;
 }
 
 void LayoutTest::layoutToXmlDebug() const {
@@ -539,6 +547,55 @@ void LayoutTest::testClassifier(const cv::Mat & src) const {
 
 }
 
+void LayoutTest::benchmarkClassifier(const cv::Mat & src) const {
+
+	// -------------------------------------------------------------------- Generate Features 
+	rdf::SuperPixel gpm(src);
+
+	if (!gpm.compute())
+		qWarning() << "could not compute" << gpm;
+
+	rdf::SuperPixelFeature spf(src, gpm.pixelSet());
+	if (!spf.compute())
+		qWarning() << "could not compute" << spf;
+
+	cv::Mat features = spf.features();
+
+	QSharedPointer<const rdf::SuperPixelModel> model = rdf::SuperPixelModel::readCached(mConfig.classifierPath());
+
+	if (model->isEmpty()) {
+		qCritical() << "illegal classifier found in" << mConfig.classifierPath();
+		return;
+	}
+
+	// -------------------------------------------------------------------- Benchmark 
+	int numRuns = 10;
+	QVector<PixelLabel> lOpenCV, lBatched;
+
+	Timer dtOpenCV;
+	for (int idx = 0; idx < numRuns; idx++)
+		lOpenCV = model->classifyStatModel(features);
+	int msOpenCV = dtOpenCV.elapsed();
+
+	Timer dtBatched;
+	for (int idx = 0; idx < numRuns; idx++)
+		lBatched = model->classify(features);
+	int msBatched = dtBatched.elapsed();
+
+	// check if both agree
+	int numDiff = 0;
+	for (int idx = 0; idx < lOpenCV.size() && idx < lBatched.size(); idx++) {
+		if (lOpenCV[idx].predicted() != lBatched[idx].predicted())
+			numDiff++;
+	}
+
+	qInfo() << features.rows << "features x" << numRuns << "runs";
+	qInfo() << "OpenCV predict:" << msOpenCV / (double)numRuns << "ms per page";
+	qInfo() << "batched engine:" << msBatched / (double)numRuns << "ms per page" 
+		<< "speed-up:" << (msBatched > 0 ? msOpenCV / (double)msBatched : 0.0);
+	qInfo() << numDiff << "/" << lOpenCV.size() << "labels differ";
+}
+
 void LayoutTest::testLineDetector(const cv::Mat & src) const {
 
 	Timer dt;
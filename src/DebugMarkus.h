@@ -65,13 +65,14 @@ public:
 	LayoutTest(const DebugConfig& config = DebugConfig());
 
 	void testComponents();
-	void layoutToXml() const;
+	bool layoutToXml() const;
 	void layoutToXmlDebug() const;
 
 protected:
 	void testFeatureCollector(const cv::Mat& src) const;
 	void testTrainer();
 	void testClassifier(const cv::Mat& src) const;
+	void benchmarkClassifier(const cv::Mat& src) const;
 	void testLineDetector(const cv::Mat& src) const;
 
 	void testLayout(const cv::Mat& src) const;
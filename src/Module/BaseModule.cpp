@@ -41,27 +41,132 @@
 
 namespace rdf {
 
+// ConfigSnapshot --------------------------------------------------------------------
+ConfigSnapshot::ConfigSnapshot() {
+	mValues = QSharedPointer<const QHash<QString, QVariant> >(new QHash<QString, QVariant>());
+}
+
+/// <summary>
+/// Copies all keys of the settings' current group.
+/// </summary>
+/// <param name="settings">The settings.</param>
+ConfigSnapshot::ConfigSnapshot(const QSettings & settings) {
+
+	QHash<QString, QVariant>* values = new QHash<QString, QVariant>();
+
+	for (const QString& key : settings.allKeys())
+		values->insert(key, settings.value(key));
+
+	mValues = QSharedPointer<const QHash<QString, QVariant> >(values);
+	mFilePath = settings.fileName();
+}
+
+bool ConfigSnapshot::isEmpty() const {
+
+	for (auto it = mValues->constBegin(); it != mValues->constEnd(); it++) {
+		if (it.key().startsWith(mPrefix))
+			return false;
+	}
+
+	return true;
+}
+
+QString ConfigSnapshot::filePath() const {
+	return mFilePath;
+}
+
+bool ConfigSnapshot::contains(const QString & key) const {
+	return mValues->contains(mPrefix + key);
+}
+
+QVariant ConfigSnapshot::value(const QString & key, const QVariant & defaultValue) const {
+	return mValues->value(mPrefix + key, defaultValue);
+}
+
+/// <summary>
+/// Returns a view on the group specified.
+/// Nested groups can be accessed with / (e.g. Module/SubModule).
+/// </summary>
+/// <param name="name">The group name.</param>
+ConfigSnapshot ConfigSnapshot::group(const QString & name) const {
+
+	ConfigSnapshot cs(*this);
+	cs.mPrefix = mPrefix + name + "/";
+
+	return cs;
+}
+
+QString ConfigSnapshot::groupName() const {
+	return mPrefix.isEmpty() ? mPrefix : mPrefix.left(mPrefix.length() - 1);
+}
+
+QStringList ConfigSnapshot::childKeys() const {
+
+	QStringList keys;
+	for (auto it = mValues->constBegin(); it != mValues->constEnd(); it++) {
+
+		if (!it.key().startsWith(mPrefix))
+			continue;
+
+		QString k = it.key().mid(mPrefix.length());
+		if (!k.contains("/"))
+			keys << k;
+	}
+
+	return keys;
+}
+
+QStringList ConfigSnapshot::childGroups() const {
+
+	QStringList groups;
+	for (auto it = mValues->constBegin(); it != mValues->constEnd(); it++) {
+
+		if (!it.key().startsWith(mPrefix))
+			continue;
+
+		QString k = it.key().mid(mPrefix.length());
+		int sIdx = k.indexOf("/");
+		if (sIdx != -1 && !groups.contains(k.left(sIdx)))
+			groups << k.left(sIdx);
+	}
+
+	return groups;
+}
+
 // ModuleConfig --------------------------------------------------------------------
 ModuleConfig::ModuleConfig(const QString& moduleName) {
 	mModuleName = moduleName;
 }
 
+/// <summary>
+/// Loads the settings from the current snapshot of the settings file.
+/// The file is not accessed (see Config::reload).
+/// </summary>
 void ModuleConfig::loadSettings() {
 
-	DefaultSettings s;
-	loadSettings(s);
+	QSharedPointer<const ConfigSnapshot> s = Config::instance().snapshot();
+	loadSettings(*s);
 }
 
 void ModuleConfig::loadSettings(QSettings & settings) {
 	settings.beginGroup(mModuleName);
-	load(settings);
+	load(ConfigSnapshot(settings));
 	settings.endGroup();
 }
 
+void ModuleConfig::loadSettings(const ConfigSnapshot & settings) {
+	load(settings.group(mModuleName));
+}
+
 void ModuleConfig::saveSettings() const {
 
-	DefaultSettings s;
-	saveSettings(s);
+	{
+		DefaultSettings s;
+		saveSettings(s);
+	}
+
+	// make the new values visible to modules created later on
+	Config::instance().reload();
 }
 
 void ModuleConfig::saveSettings(QSettings & settings) const {
@@ -95,7 +200,7 @@ QString ModuleConfig::toString() const {
 	return name();
 }
 
-void ModuleConfig::load(const QSettings&) {
+void ModuleConfig::load(const ConfigSnapshot&) {
 	// dummy
 	qWarning() << "ModuleConfig::load() called - make sure to call the derived method...";
 }
@@ -126,8 +231,17 @@ QString Module::debugName() const {
 	return "[" + mConfig->name() + "]";
 }
 
+/// <summary>
+/// Returns the timing and memory measurements of the last compute().
+/// The stats are empty if the Profiler is disabled or
+/// the module does not profile itself (see rdfProfileModule).
+/// </summary>
+StageStats Module::stats() const {
+	return mStats;
+}
+
 QString Module::toString() const {
-	return debugName();
+	return debugName() + mStats.toString();
 }
 
 QDataStream& operator<<(QDataStream& s, const Module& m) {
@@ -32,10 +32,15 @@
 
 #pragma once
 
+#include "Profiler.h"
+
 #pragma warning(push, 0)	// no warnings from includes
 #include <QObject>
 #include <QSharedPointer>
 #include <QDebug>
+#include <QHash>
+#include <QVariant>
+#include <QStringList>
 #pragma warning(pop)
 
 #include <opencv2/core.hpp>
@@ -60,6 +65,39 @@ namespace rdf {
 #define mWarning	qWarning().noquote()	<< debugName()
 #define mCritical	qCritical().noquote()	<< debugName()
 
+// profiles a module's compute() and keeps the results in the module's stats()
+#define rdfProfileModule()	rdf::ScopedStage rdfModuleStage(name(), &mStats)
+
+/// <summary>
+/// Immutable snapshot of settings (e.g. the settings file).
+/// Keys are stored as paths (Group/key) in a single hash which
+/// is shared between all copies. group() returns a view on a
+/// sub tree without copying it. Since the data is never modified,
+/// snapshots can be read from multiple threads without locking.
+/// </summary>
+class DllCoreExport ConfigSnapshot {
+
+public:
+	ConfigSnapshot();
+	explicit ConfigSnapshot(const QSettings& settings);
+
+	bool isEmpty() const;
+	QString filePath() const;
+
+	bool contains(const QString& key) const;
+	QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+
+	ConfigSnapshot group(const QString& name) const;
+	QString groupName() const;
+	QStringList childKeys() const;
+	QStringList childGroups() const;
+
+private:
+	QSharedPointer<const QHash<QString, QVariant> > mValues;
+	QString mPrefix;		// the group (including a trailing /)
+	QString mFilePath;
+};
+
 class DllCoreExport ModuleConfig {
 
 public:
@@ -70,6 +108,7 @@ public:
 
 	void loadSettings();
 	void loadSettings(QSettings& settings);
+	void loadSettings(const ConfigSnapshot& settings);
 	void saveSettings() const;
 	void saveSettings(QSettings& settings) const;
 	void saveDefaultSettings() const;
@@ -79,7 +118,7 @@ public:
 	virtual QString toString() const;
 
 protected:
-	virtual void load(const QSettings& settings);
+	virtual void load(const ConfigSnapshot& settings);
 	virtual void save(QSettings& settings) const;
 
 	QString mModuleName;						/**< the module's name.**/
@@ -165,8 +204,11 @@ public:
 	virtual void setConfig(QSharedPointer<ModuleConfig> config);
 	QSharedPointer<ModuleConfig> config() const;
 
+	StageStats stats() const;
+
 protected:
 	QSharedPointer<ModuleConfig> mConfig;		/**< the module config **/
+	StageStats mStats;							/**< timing & memory of the last compute() (see rdfProfileModule) **/
 
 	virtual bool checkInput() const = 0;		/**< checks if all input images are in the specified format.**/
 	QString debugName() const;
@@ -97,6 +97,8 @@ bool SimpleBinarization::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileModule();
+
 	mBwImg = mSrcImg > config()->thresh();
 
 	return true;
@@ -110,6 +112,7 @@ QString SimpleBinarization::toString() const {
 	
 	QString msg = debugName();
 	msg += config()->toString();
+	msg += mStats.toString();
 
 	return msg;
 }
@@ -175,6 +178,8 @@ bool BaseBinarizationSu::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileModule();
+
 	cv::Mat erodedMask = IP::erodeImage(mMask, cvRound(config()->erodedMaskSize()), IP::morph_square, 0);
 
 	//Image::imageInfo(erodedMask, "erodedMAsk");
@@ -519,6 +524,7 @@ QString BaseBinarizationSu::toString() const {
 
 	QString msg = debugName();
 	msg += config()->toString();
+	msg += mStats.toString();
 
 	return msg;
 }
@@ -541,6 +547,8 @@ bool BinarizationSuAdapted::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileModule();
+
 	cv::Mat erodedMask = IP::erodeImage(mMask, cvRound(config()->erodedMaskSize()), IP::morph_square);
 
 	mContrastImg = compContrastImg(mSrcImg, erodedMask);
@@ -637,6 +645,7 @@ QString BinarizationSuAdapted::toString() const {
 	QString msg = debugName();
 	msg += " strokeW: " + QString::number(mStrokeW);
 	msg += config()->toString();
+	msg += mStats.toString();
 
 	return msg;
 }
@@ -791,7 +800,7 @@ QString SimpleBinarizationConfig::toString() const {
 	return msg;
 }
 
-void SimpleBinarizationConfig::load(const QSettings& settings) {
+void SimpleBinarizationConfig::load(const ConfigSnapshot& settings) {
 
 	mThresh = settings.value("thresh", mThresh).toInt();
 }
@@ -822,7 +831,7 @@ QString BaseBinarizationSuConfig::toString() const {
 	return msg;
 }
 
-void BaseBinarizationSuConfig::load(const QSettings& settings) {
+void BaseBinarizationSuConfig::load(const ConfigSnapshot& settings) {
 
 	mErodeMaskSize = settings.value("erodeMaskSize", mErodeMaskSize).toInt();
 }
@@ -68,7 +68,7 @@ protected:
 	// parameters
 	int mThresh = 100;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -108,7 +108,7 @@ public:
 	QString toString() const override;
 
 private:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	int mErodeMaskSize = 3 * 6;							//size for the boundary erosion
@@ -58,7 +58,7 @@ QString DeepMergeConfig::labelConfigPath() const {
 	return mLabelConfigPath;
 }
 
-void DeepMergeConfig::load(const QSettings & settings) {
+void DeepMergeConfig::load(const ConfigSnapshot & settings) {
 	
 	mLabelConfigPath = settings.value("LabelConfigPath", mLabelConfigPath).toString();
 }
@@ -117,14 +117,13 @@ bool DeepMerge::compute() {
 		qWarning() << "the labels loaded from" << config()->labelConfigPath() << "do not fit the number of labels we have in DeepMerge:" << channels.size();
 	}
 
-	for (int idx = 0; idx < channels.size(); idx++) {
+	// trace all labels at once
+	QVector<QVector<Polygon> > polys = IP::labelsToPolys(mLabelImg, channels.size(), mScaleFactor);
 
-		cv::Mat cImg = mLabelImg == idx;
+	for (int idx = 0; idx < channels.size(); idx++) {
 
-		auto poly = IP::maskToPoly(cImg, mScaleFactor);
 		LabelInfo l = mManager.find(idx);
-
-		mRegions << DMRegion(poly, l);
+		mRegions << DMRegion(polys[idx], l);
 	}
 
 	mInfo << "computed in" << dt;
@@ -68,7 +68,7 @@ protected:
 
 	QString mLabelConfigPath = "C:/nextcloud/READ/basilis/DeepMerge-config.json";
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -1186,7 +1186,7 @@ namespace rdf {
 		return mTestPath;
 	}
 
-	void FontStyleClassificationConfig::load(const QSettings & settings) {
+	void FontStyleClassificationConfig::load(const ConfigSnapshot & settings) {
 
 		mTestBool = settings.value("testBool", testBool()).toBool();
 		mTestInt = settings.value("testInt", testInt()).toInt();		
@@ -248,7 +248,7 @@ namespace rdf {
 
 	protected:
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		bool mTestBool = true;
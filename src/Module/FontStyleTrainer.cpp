@@ -71,7 +71,7 @@ void FontStyleTrainerConfig::setDefaultK(int defaultK) {
 	mDefaultK = defaultK;
 }
 
-void FontStyleTrainerConfig::load(const QSettings & settings) {
+void FontStyleTrainerConfig::load(const ConfigSnapshot & settings) {
 	mModelPath	= settings.value("modelPath", modelPath()).toString();
 	mModelType	= settings.value("modelType", modelType()).toInt();
 	mDefaultK	= settings.value("defaultK", defaultK()).toInt();
@@ -72,7 +72,7 @@ protected:
 	int mModelType = FontStyleClassifier::classify_bayes;
 	int mDefaultK = 30;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
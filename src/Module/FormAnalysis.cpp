@@ -38,7 +38,6 @@
 #include "PageParser.h"
 #include "Elements.h"
 #include "ImageProcessor.h"
-#include "maxclique/mcqd.h"
 
 //#pragma warning(push, 0)
 //#include "maxclique/cliquer.h"
@@ -50,10 +49,74 @@
 #include <QSettings>
 #include <QFileInfo>
 #include <QDir>
+#include <QtAlgorithms>
 #include <opencv2/imgproc.hpp>
 #pragma warning(pop)
 
 namespace rdf {
+
+	/// <summary>
+	/// Tests all node pairs (i, j > i) of an association graph in parallel.
+	/// </summary>
+	class AssociationGraphBody : public cv::ParallelLoopBody {
+
+	public:
+		AssociationGraphBody(const AssociationGraphBuilder& builder, const std::vector<AssociationGraphBuilder::Geometry>& geoms, std::vector<QVector<int> >& neighbours) :
+			mBuilder(builder), mGeoms(geoms), mNeighbours(neighbours) {
+		}
+
+		void operator()(const cv::Range& r) const override {
+
+			for (int i = r.start; i < r.end; i++) {
+				for (int j = i + 1; j < (int)mGeoms.size(); j++) {
+					if (mBuilder.testAdjacency(mGeoms[i], mGeoms[j]))
+						mNeighbours[i] << j;
+				}
+			}
+		}
+
+	private:
+		const AssociationGraphBuilder& mBuilder;
+		const std::vector<AssociationGraphBuilder::Geometry>& mGeoms;
+		std::vector<QVector<int> >& mNeighbours;
+	};
+
+	/// <summary>
+	/// Solves the maximum clique of several graphs in parallel.
+	/// </summary>
+	class MaxCliqueBody : public cv::ParallelLoopBody {
+
+	public:
+		MaxCliqueBody(const std::vector<QVector<QVector<int> > >& graphs, int timeLimit, int nodeLimit, std::vector<QSet<int> >& cliques) :
+			mGraphs(graphs), mTimeLimit(timeLimit), mNodeLimit(nodeLimit), mCliques(cliques) {
+		}
+
+		void operator()(const cv::Range& r) const override {
+
+			for (int idx = r.start; idx < r.end; idx++) {
+
+				MaxCliqueSolver solver(mGraphs[idx]);
+				solver.setTimeLimit(mTimeLimit);
+				solver.setNodeLimit(mNodeLimit);
+
+				QSet<int> clique;
+				for (int v : solver.solve())
+					clique.insert(v);
+
+				if (!solver.isOptimal())
+					qWarning() << "max clique search stopped by its budget after" << solver.numNodes() << "nodes - the clique (size:" << clique.size() << ") might not be maximal";
+
+				mCliques[idx] = clique;
+			}
+		}
+
+	private:
+		const std::vector<QVector<QVector<int> > >& mGraphs;
+		int mTimeLimit;
+		int mNodeLimit;
+		std::vector<QSet<int> >& mCliques;
+	};
+
 	FormFeatures::FormFeatures(){
 		mConfig = QSharedPointer<FormFeaturesConfig>::create();
 	}
@@ -173,6 +236,8 @@ namespace rdf {
 	{
 		if (!checkInput())
 			return false;
+
+		rdfProfileModule();
 		//rdf::Image::save(mSrcImg, "C:\\tmp\\test1.png");
 		if (mBwImg.empty()) {
 			if (!computeBinaryInput()) {
@@ -1519,28 +1584,18 @@ QVector<QSharedPointer<rdf::AssociationGraphNode>> FormFeatures::mergeColinearNo
 
 void FormFeatures::createAssociationGraph() {
 
-	//create graph for vertical lines
-	for (int currentNodeIdx = 0; currentNodeIdx < mANodesVertical.size(); currentNodeIdx++) {
-		for (int compareNodeIdx = currentNodeIdx + 1; compareNodeIdx < mANodesVertical.size(); compareNodeIdx++) {
+	AssociationGraphBuilder agb(config()->coLinearityThr(), config()->variationThrLower(), config()->variationThrUpper());
 
-			//test if nodes can be associated
-			if (mANodesVertical[currentNodeIdx]->testAdjacency(mANodesVertical[compareNodeIdx], config()->coLinearityThr(), config()->variationThrLower(), config()->variationThrUpper())) {
-				mANodesVertical[currentNodeIdx]->addAdjacencyNode(compareNodeIdx);
-				mANodesVertical[compareNodeIdx]->addAdjacencyNode(currentNodeIdx);
-			}
-		}
+	//create graph for vertical lines
+	for (const QPair<int, int>& e : agb.edges(mANodesVertical)) {
+		mANodesVertical[e.first]->addAdjacencyNode(e.second);
+		mANodesVertical[e.second]->addAdjacencyNode(e.first);
 	}
 
 	//create graph for horizontal lines
-	for (int currentNodeIdx = 0; currentNodeIdx < mANodesHorizontal.size(); currentNodeIdx++) {
-		for (int compareNodeIdx = currentNodeIdx + 1; compareNodeIdx < mANodesHorizontal.size(); compareNodeIdx++) {
-
-			//test if nodes can be associated
-			if (mANodesHorizontal[currentNodeIdx]->testAdjacency(mANodesHorizontal[compareNodeIdx], config()->coLinearityThr(), config()->variationThrLower(), config()->variationThrUpper())) {
-				mANodesHorizontal[currentNodeIdx]->addAdjacencyNode(compareNodeIdx);
-				mANodesHorizontal[compareNodeIdx]->addAdjacencyNode(currentNodeIdx);
-			}
-		}
+	for (const QPair<int, int>& e : agb.edges(mANodesHorizontal)) {
+		mANodesHorizontal[e.first]->addAdjacencyNode(e.second);
+		mANodesHorizontal[e.second]->addAdjacencyNode(e.first);
 	}
 
 	////only debug
@@ -1562,75 +1617,25 @@ void FormFeatures::createAssociationGraph() {
 
 }
 
-bool ** FormFeatures::adjacencyMatrix(const QVector<QSharedPointer<rdf::AssociationGraphNode>>& associationGraphNodes) {
-
-	int numberNodes = associationGraphNodes.size();
-
-	if (numberNodes > 0) {
-
-		bool **ppAdjacencyMatrixVer = new bool*[numberNodes];
-		for (int i = 0; i < numberNodes; i++) {
-			ppAdjacencyMatrixVer[i] = new bool[numberNodes];
-			memset(ppAdjacencyMatrixVer[i], 0, numberNodes * sizeof(bool));
-		}
-		
-		for (int adVer = 0; adVer < numberNodes; adVer++) {
-			QVector<int> neighbours = associationGraphNodes[adVer]->adjacencyNodes();
-			for (int n = 0; n < neighbours.size(); n++) {
-				ppAdjacencyMatrixVer[adVer][neighbours[n]] = true;
-				ppAdjacencyMatrixVer[neighbours[n]][adVer] = true;
-			}
-		}
-
-		return ppAdjacencyMatrixVer;
-	} else
-		return nullptr;
-}
-
 void FormFeatures::findMaxCliques() {
 
 	// --------------------------- unweighted clique version ---------------------------------------------------
-	bool** ppAdjacencyMatrixVertical = 0;
-	bool** ppAdjacencyMatrixHorizontal = 0;
-	int *qmax;
-	int qsize;
+	// the vertical and horizontal association graphs are independent and solved concurrently
+	std::vector<QVector<QVector<int> > > graphs(2);
+	std::vector<QSet<int> > cliques(2);
 
-	qDebug() << "vertical max clique...";
-	ppAdjacencyMatrixVertical = adjacencyMatrix(mANodesVertical);
+	for (const QSharedPointer<rdf::AssociationGraphNode>& n : mANodesVertical)
+		graphs[0] << n->adjacencyNodes();
+	for (const QSharedPointer<rdf::AssociationGraphNode>& n : mANodesHorizontal)
+		graphs[1] << n->adjacencyNodes();
 
-	if (ppAdjacencyMatrixVertical != 0 && mANodesVertical.size() > 0) {
-		Maxclique m(ppAdjacencyMatrixVertical, mANodesVertical.size());
+	qDebug() << "vertical and horizontal max clique...";
+	cv::parallel_for_(cv::Range(0, 2), MaxCliqueBody(graphs, config()->maxCliqueTime(), config()->maxCliqueNodes(), cliques));
 
-		m.mcq(qmax, qsize);
-		QSet<int> mCl;
-		for (int iN = 0; iN < qsize; iN++) {
-			mCl.insert(qmax[iN]);
-		}
-		mMaxCliquesVer.push_back(mCl);
-		////test - faster?
-		//Maxclique m2(ppAdjacencyMatrixVer, sizeVer, 0.025);
-		//m2.mcqdyn(qmax, qsize);
-		delete(qmax);
-		for (int nRows = 0; nRows < mANodesVertical.size(); nRows++)
-			delete(ppAdjacencyMatrixVertical[nRows]);
-	}
-
-	qDebug() << "horizontal max clique...";
-	ppAdjacencyMatrixHorizontal = adjacencyMatrix(mANodesHorizontal);
-
-	if (ppAdjacencyMatrixHorizontal != 0 && mANodesHorizontal.size() > 0) {
-		Maxclique mHor(ppAdjacencyMatrixHorizontal, mANodesHorizontal.size());
-
-		mHor.mcq(qmax, qsize);
-		QSet<int> mClH;
-		for (int iN = 0; iN < qsize; iN++) {
-			mClH.insert(qmax[iN]);
-		}
-		mMaxCliquesHor.push_back(mClH);
-		delete(qmax);
-		for (int nRows = 0; nRows < mANodesHorizontal.size(); nRows++)
-			delete(ppAdjacencyMatrixHorizontal[nRows]);
-	}
+	if (mANodesVertical.size() > 0)
+		mMaxCliquesVer.push_back(cliques[0]);
+	if (mANodesHorizontal.size() > 0)
+		mMaxCliquesHor.push_back(cliques[1]);
 
 	//// --------------------------- weighted clique version ---------------------------------------------------
 	////vertical clique (weighted)
@@ -2238,6 +2243,8 @@ bool FormFeatures::matchTemplate() {
 		qWarning() << "no template provided in matchTemplate";
 		return false;
 	}
+
+	rdfProfileScope("FormMatching");
 	
 	QVector<QSharedPointer<rdf::TableCell>> cells = mTemplateForm->cells();
 	QSharedPointer<rdf::TableRegion> region(new rdf::TableRegion());
@@ -3169,7 +3176,7 @@ cv::Size FormFeatures::sizeImg() const
 
 	QString FormFeatures::toString() const
 	{
-		return QString("Form Features class calculates line and layout features for form classification");
+		return QString("Form Features class calculates line and layout features for form classification") + mStats.toString();
 	}
 
 	void FormFeatures::setFormName(QString s) 	{
@@ -3414,6 +3421,22 @@ cv::Size FormFeatures::sizeImg() const
 		mEvalPath = s;
 	}
 
+	int FormFeaturesConfig::maxCliqueTime() const {
+		return mMaxCliqueTime;
+	}
+
+	void FormFeaturesConfig::setMaxCliqueTime(int ms) {
+		mMaxCliqueTime = ms;
+	}
+
+	int FormFeaturesConfig::maxCliqueNodes() const {
+		return mMaxCliqueNodes;
+	}
+
+	void FormFeaturesConfig::setMaxCliqueNodes(int n) {
+		mMaxCliqueNodes = n;
+	}
+
 	QString FormFeaturesConfig::toString() const	{
 		QString msg;
 		//msg += "  mThreshLineLenRatio: " + QString::number(mThreshLineLenRatio);
@@ -3424,10 +3447,12 @@ cv::Size FormFeatures::sizeImg() const
 		//msg += "  mErrorThr: " + QString::number(mErrorThr);
 		msg += "  mVariationThrLower: " + QString::number(mVariationThrLower);
 		msg += "  mSaveChilds: " + mSaveChilds;
+		msg += "  mMaxCliqueTime: " + QString::number(mMaxCliqueTime);
+		msg += "  mMaxCliqueNodes: " + QString::number(mMaxCliqueNodes);
 		return msg;
 	}
 	
-	void FormFeaturesConfig::load(const QSettings & settings)	{
+	void FormFeaturesConfig::load(const ConfigSnapshot & settings)	{
 		//mThreshLineLenRatio = settings.value("threshLineLenRatio", mThreshLineLenRatio).toDouble();
 		mTemplDatabase = settings.value("formTemplate", mTemplDatabase).toString();
 		mEvalPath = settings.value("evalPath", mEvalPath).toString();
@@ -3437,6 +3462,8 @@ cv::Size FormFeatures::sizeImg() const
 		mVariationThrLower = settings.value("variationThresholdLower", mVariationThrLower).toDouble();
 		mVariationThrUpper = settings.value("variationThresholdUpper", mVariationThrUpper).toDouble();
 		mSaveChilds = settings.value("saveChilds", mSaveChilds).toBool();
+		mMaxCliqueTime = settings.value("maxCliqueTime", mMaxCliqueTime).toInt();
+		mMaxCliqueNodes = settings.value("maxCliqueNodes", mMaxCliqueNodes).toInt();
 	}
 
 	void FormFeaturesConfig::save(QSettings & settings) const	{
@@ -3449,7 +3476,316 @@ cv::Size FormFeatures::sizeImg() const
 		settings.setValue("variationThresholdLower", mVariationThrLower);
 		settings.setValue("variationThresholdUpper", mVariationThrUpper);
 		settings.setValue("saveChilds", mSaveChilds);
+		settings.setValue("maxCliqueTime", mMaxCliqueTime);
+		settings.setValue("maxCliqueNodes", mMaxCliqueNodes);
+
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="MaxCliqueSolver"/> class.
+	/// Vertices are reordered by decreasing degree which tightens the colouring bound.
+	/// </summary>
+	/// <param name="adjacency">The adjacency lists of the (undirected) graph.</param>
+	MaxCliqueSolver::MaxCliqueSolver(const QVector<QVector<int> >& adjacency) {
+
+		mNumVertices = adjacency.size();
+		mNumWords = (mNumVertices + 63) / 64;
+
+		mOrder.resize(mNumVertices);
+		for (int i = 0; i < mNumVertices; i++)
+			mOrder[i] = i;
+
+		std::stable_sort(mOrder.begin(), mOrder.end(), [&](int a, int b) {
+			return adjacency[a].size() > adjacency[b].size();
+		});
+
+		std::vector<int> newIdx(mNumVertices);
+		for (int i = 0; i < mNumVertices; i++)
+			newIdx[mOrder[i]] = i;
+
+		mAdjacency.assign(mNumVertices, Bitset(mNumWords, 0));
+		for (int v = 0; v < mNumVertices; v++) {
+			for (int n : adjacency[v]) {
+				if (n < 0 || n >= mNumVertices || n == v)
+					continue;
+
+				int a = newIdx[v];
+				int b = newIdx[n];
+				mAdjacency[a][b >> 6] |= 1ULL << (b & 63);
+				mAdjacency[b][a >> 6] |= 1ULL << (a & 63);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Sets the time budget in ms (<= 0: unlimited).
+	/// </summary>
+	void MaxCliqueSolver::setTimeLimit(int ms) {
+		mTimeLimit = ms;
+	}
+
+	/// <summary>
+	/// Sets the maximal number of search nodes (<= 0: unlimited).
+	/// </summary>
+	void MaxCliqueSolver::setNodeLimit(qint64 numNodes) {
+		mNodeLimit = numNodes;
+	}
+
+	/// <summary>
+	/// Searches the maximum clique.
+	/// </summary>
+	/// <returns>The (sorted) vertex indexes of the clique.</returns>
+	QVector<int> MaxCliqueSolver::solve() {
+
+		mMaxClique.clear();
+		mNumNodes = 0;
+		mAborted = false;
+		mTimer.start();
+
+		QVector<int> clique;
+		if (mNumVertices == 0)
+			return clique;
+
+		Bitset p(mNumWords, ~0ULL);
+		if (mNumVertices & 63)
+			p[mNumWords - 1] = (1ULL << (mNumVertices & 63)) - 1;
+
+		std::vector<int> c;
+		expand(p, c);
+
+		for (int v : mMaxClique)
+			clique << mOrder[v];
+		std::sort(clique.begin(), clique.end());
+
+		return clique;
+	}
+
+	/// <summary>
+	/// Returns true if the search was not stopped by the budget.
+	/// </summary>
+	bool MaxCliqueSolver::isOptimal() const {
+		return !mAborted;
+	}
+
+	qint64 MaxCliqueSolver::numNodes() const {
+		return mNumNodes;
+	}
+
+	void MaxCliqueSolver::expand(Bitset& p, std::vector<int>& clique) {
+
+		if (budgetExceeded())
+			return;
+
+		std::vector<int> vertices, colors;
+		colorSort(p, vertices, colors);
+
+		Bitset np(mNumWords);
+
+		// vertices with the highest colour first
+		for (int i = (int)vertices.size() - 1; i >= 0; i--) {
+
+			// the colour is an upper bound of the clique size in p
+			if (clique.size() + colors[i] <= mMaxClique.size())
+				return;
+
+			int v = vertices[i];
+			clique.push_back(v);
+
+			bool empty = true;
+			for (int w = 0; w < mNumWords; w++) {
+				np[w] = p[w] & mAdjacency[v][w];
+				if (np[w])
+					empty = false;
+			}
 
+			if (empty) {
+				if (clique.size() > mMaxClique.size())
+					mMaxClique = clique;
+			}
+			else
+				expand(np, clique);
+
+			clique.pop_back();
+			p[v >> 6] &= ~(1ULL << (v & 63));
+
+			if (mAborted)
+				return;
+		}
+	}
+
+	/// <summary>
+	/// Greedy colouring of the vertices in p (bit-parallel).
+	/// The vertices are returned with non-decreasing colours.
+	/// </summary>
+	void MaxCliqueSolver::colorSort(const Bitset& p, std::vector<int>& vertices, std::vector<int>& colors) const {
+
+		Bitset q = p;
+		Bitset qk(mNumWords);
+		int k = 0;
+		int first = 0;	// first non-empty word of q
+
+		while (first < mNumWords) {
+
+			k++;
+			qk = q;
+
+			for (int w = first; w < mNumWords; w++) {
+				while (qk[w]) {
+					int v = (w << 6) + qCountTrailingZeroBits(qk[w]);
+					quint64 bit = ~(1ULL << (v & 63));
+					q[w] &= bit;
+					qk[w] &= bit;
+
+					// neighbours of v cannot have the same colour
+					for (int w2 = w; w2 < mNumWords; w2++)
+						qk[w2] &= ~mAdjacency[v][w2];
+
+					vertices.push_back(v);
+					colors.push_back(k);
+				}
+			}
+
+			while (first < mNumWords && !q[first])
+				first++;
+		}
+	}
+
+	bool MaxCliqueSolver::budgetExceeded() {
+
+		mNumNodes++;
+
+		// always finish the first (greedy) descent so that a clique is found
+		if (mAborted || mMaxClique.empty())
+			return mAborted;
+
+		if (mNodeLimit > 0 && mNumNodes > mNodeLimit)
+			mAborted = true;
+		else if (mTimeLimit > 0 && (mNumNodes & 255) == 0 && mTimer.elapsed() > mTimeLimit)
+			mAborted = true;
+
+		return mAborted;
+	}
+
+	AssociationGraphBuilder::AssociationGraphBuilder(double distThreshold, double variationThrLower, double variationThrUpper) {
+		mDistThreshold = distThreshold;
+		mVariationThrLower = variationThrLower;
+		mVariationThrUpper = variationThrUpper;
+	}
+
+	/// <summary>
+	/// Extracts the geometry of a node needed for the adjacency test.
+	/// </summary>
+	/// <param name="node">The node.</param>
+	/// <param name="horizontal">If true, endpoints are sorted w.r.t. x, otherwise w.r.t. y.</param>
+	/// <returns>The node's geometry.</returns>
+	AssociationGraphBuilder::Geometry AssociationGraphBuilder::geometry(const AssociationGraphNode& node, bool horizontal) {
+
+		Geometry g;
+		g.cellIdx = node.cellIdx();
+		g.linePos = node.linePosition();
+		g.rowIdx = node.getRowIdx();
+		g.colIdx = node.getColIdx();
+		g.rowSpan = node.rowSpan();
+		g.colSpan = node.colSpan();
+		g.horizontal = horizontal;
+
+		g.referenceLine = node.referenceLine();
+		g.matchedLine = node.matchedLine();
+		g.referenceLine.sortEndpoints(horizontal);
+		g.matchedLine.sortEndpoints(horizontal);
+		g.referenceCenter = g.referenceLine.center();
+		g.matchedCenter = g.matchedLine.center();
+
+		return g;
+	}
+
+	/// <summary>
+	/// Returns the edges (i < j) of the association graph of nodes.
+	/// </summary>
+	/// <param name="nodes">The association graph nodes (all horizontal or all vertical).</param>
+	/// <returns>A sparse edge list.</returns>
+	QVector<QPair<int, int> > AssociationGraphBuilder::edges(const QVector<QSharedPointer<AssociationGraphNode> >& nodes) const {
+
+		std::vector<Geometry> geoms;
+		geoms.reserve(nodes.size());
+		for (const QSharedPointer<AssociationGraphNode>& n : nodes) {
+			bool horizontal = n->linePosition() == AssociationGraphNode::pos_top || n->linePosition() == AssociationGraphNode::pos_bottom;
+			geoms.push_back(geometry(*n, horizontal));
+		}
+
+		std::vector<QVector<int> > neighbours(geoms.size());
+		cv::parallel_for_(cv::Range(0, (int)geoms.size()), AssociationGraphBody(*this, geoms, neighbours));
+
+		QVector<QPair<int, int> > e;
+		for (int i = 0; i < (int)neighbours.size(); i++) {
+			for (int j : neighbours[i])
+				e << qMakePair(i, j);
+		}
+
+		return e;
+	}
+
+	/// <summary>
+	/// Tests if two nodes can be associated (i.e. both line matches can co-exist).
+	/// g2 must be sorted w.r.t. g1's orientation.
+	/// </summary>
+	bool AssociationGraphBuilder::testAdjacency(const Geometry& g1, const Geometry& g2) const {
+
+		bool horizontal = g1.horizontal;
+		const Line& m1 = g1.matchedLine;
+		const Line& m2 = g2.matchedLine;
+
+		//same reference line (same cell and same line position for the reference line - two different matched lines)
+		if (g1.cellIdx == g2.cellIdx && g1.linePos == g2.linePos) {
+
+			//match only, if there is no overlap and lines have the same vertical position
+			double overlap = horizontal ? m1.horizontalOverlap(m2) : m1.verticalOverlap(m2);
+			if (overlap != 0)
+				return false;
+
+			//no overlap and same vertical position -> line is split
+			//can co-exist
+			double distance = std::min(m1.distance(g2.matchedCenter), m2.distance(g1.matchedCenter));
+			return distance < mDistThreshold;
+		}
+
+		// line position must be the same and row (col) position must be the same for top (left) line
+		// or for bottom (right) line rowIdx + rowSpan must be the same
+		bool colinear;
+		if (horizontal)
+			colinear = g1.linePos == g2.linePos && 
+				((g1.rowIdx == g2.rowIdx && g1.linePos == AssociationGraphNode::pos_top) || g1.rowIdx + g1.rowSpan == g2.rowIdx + g2.rowSpan);
+		else
+			colinear = g1.linePos == g2.linePos && 
+				((g1.colIdx == g2.colIdx && g1.linePos == AssociationGraphNode::pos_left) || g1.colIdx + g1.colSpan == g2.colIdx + g2.colSpan);
+
+		if (colinear) {
+			//reference line has same position (colinear lines), but belongs to a different cell
+			//matched lines must also be "colinear"
+			double lineDtmp;
+			if (horizontal)
+				lineDtmp = m1.p1().x() < m2.p1().x() ? m1.distance(m2.p1()) : m2.distance(m1.p1());
+			else
+				lineDtmp = m1.p1().y() < m2.p1().y() ? m1.distance(m2.p1()) : m2.distance(m1.p1());
+
+			return lineDtmp < mDistThreshold * 3;
+		}
+
+		//reference lines have a different position - the order of the
+		//reference lines must be the same as the order of the matched lines
+		double r1 = horizontal ? g1.referenceCenter.y() : g1.referenceCenter.x();
+		double r2 = horizontal ? g2.referenceCenter.y() : g2.referenceCenter.x();
+		double c1 = horizontal ? g1.matchedCenter.y() : g1.matchedCenter.x();
+		double c2 = horizontal ? g2.matchedCenter.y() : g2.matchedCenter.x();
+
+		if (!((r1 < r2 && c1 < c2) || (r1 > r2 && c1 > c2)))
+			return false;
+
+		//allow only a certain variation of the distances
+		double dref = std::abs(r1 - r2);
+		double dm = std::min(m1.distance(g2.matchedCenter), m2.distance(g1.matchedCenter));
+
+		return dref*(1.0 - mVariationThrLower) < dm && dm < dref*(1.0 + mVariationThrUpper);
 	}
 
 	AssociationGraphNode::AssociationGraphNode() {
@@ -3630,157 +3966,9 @@ cv::Size FormFeatures::sizeImg() const
 	bool AssociationGraphNode::testAdjacency(QSharedPointer<AssociationGraphNode> neighbour, double distThreshold, double variationThrLower, double variationThrUpper) {
 
 		bool horizontal = mLinePos == LinePosition::pos_top || mLinePos == LinePosition::pos_bottom ? true : false;
-		
-		//same reference line (same cell and same line position for the reference line - two different matched lines)
-		if (mCellIdx == neighbour->cellIdx() && mLinePos == neighbour->linePosition()) {
-
-			//match only, if there is no overlap and lines have the same vertical position
-			//rdf::Line m1 = mReferenceLine;			//error?
-			rdf::Line m1 = mMatchedLine;
-			rdf::Line m2 = neighbour->matchedLine(); 
-			m1.sortEndpoints(horizontal);
-			m2.sortEndpoints(horizontal);
-			double overlap = horizontal ? m1.horizontalOverlap(m2) : m1.verticalOverlap(m2);
-			double distance = std::min(m1.distance(m2.center()), m2.distance(m1.center()));
-			//no overlap and same vertical position -> line is split
-			//can co-exist
-			if (overlap == 0 && distance < distThreshold) {
-				//qDebug() << "TEST!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
-				return true;
-			}
-
-		} else {
-			//not the same reference line
-			rdf::Line ref1 = mReferenceLine;
-			rdf::Line ref2 = neighbour->referenceLine();
-			rdf::Line m1 = mMatchedLine;
-			rdf::Line m2 = neighbour->matchedLine();
-
-			if (!horizontal) {
-				//line is vertical
-				ref1.sortEndpoints(horizontal);
-				ref2.sortEndpoints(horizontal);
-				m1.sortEndpoints(horizontal);
-				m2.sortEndpoints(horizontal);
-				//horizontal distances
-				//double dm = std::abs(m1.center().x() - m2.center().x()); //-> can cause too much variation
-				double dm = std::min(m1.distance(m2.center()), m2.distance(m1.center()));
-				double dref = std::abs(ref1.center().x() - ref2.center().x()); 
-				//double dref = std::min(ref1.distance(ref2.center()), ref2.distance(ref1.center()));
-
-				//reference line has same horizontal position (colinear lines), but belongs to a different cell
-
-				// line position must be the same and row position must be the same for top line
-				// or for bottom line rowIdx + rowSpan must be the same
-				if ((mLinePos == neighbour->linePosition() && mRefColIdx == neighbour->getColIdx() && mLinePos==rdf::AssociationGraphNode::LinePosition::pos_left) ||
-					(mLinePos == neighbour->linePosition() && (mRefColIdx + mColSpan) == (neighbour->getColIdx() + neighbour->colSpan()))) {
-				//if (mLinePos == neighbour->linePosition() && mRefColIdx == neighbour->getColIdx()) {
-				//problem with distance by non straight lines....
-				//if (dref < distThreshold) {
-				//alternatively use:
-				//if (ref1.distance(ref2.p1()) < distThreshold) {
-
-					double lineDtmp = m1.p1().y() < m2.p1().y() ? m1.distance(m2.p1()) : m2.distance(m1.p1());
-					//colinear lines
-					if (lineDtmp < distThreshold*3) {
-						//matched lines are also "colinear"
-						//check if reference line is above or not, same must apply to matched lines
-						//really? matched line can be line of entire row... test only with true...
-						return true;
-						//if (ref1.p1().y() <= ref2.p1().y() && m1.p1().y() <= m2.p1().y()) {
-						//	return true;
-						//}
-						//else if (ref1.p1().y() > ref2.p1().y() && m1.p1().y() > m2.p1().y()) {
-						//	return true;
-						//}
-					}
 
-				}
-				else {
-					if (dref*(1.0 - variationThrLower) < dm && dm < dref*(1.0 + variationThrUpper)) {
-						//bool overlapRef = ref1.verticalOverlap(ref2) > 10 ? true : false;
-						//bool overlapM = m1.verticalOverlap(m2) > 10 ? true : false;
-						//reference line is left from second reference line, same must apply to matched lines
-						if (ref1.center().x() < ref2.center().x() && m1.center().x() < m2.center().x()) {
-							//if reference lines have an overlap, same must apply to matched lines
-							//if ((overlapM && overlapRef) || (!overlapM && !overlapRef))
-							return true;
-						}
-						//reference line is right from second reference line, same must apply to matched lines
-						else if (ref1.center().x() > ref2.center().x() && m1.center().x() > m2.center().x()) {
-							//if reference lines have an overlap, same must apply to matched lines
-							//if ((overlapM && overlapRef) || (!overlapM && !overlapRef))
-							return true;
-						}
-					}
-				}
-			} else {
-				//--------------------------------------------------------------------------------------------------------------
-				//line is horizontal
-				//--------------------------------------------------------------------------------------------------------------
-				ref1.sortEndpoints(horizontal);
-				ref2.sortEndpoints(horizontal);
-				m1.sortEndpoints(horizontal);
-				m2.sortEndpoints(horizontal);
-				//vertical distances
-				//double dm = std::abs(m1.center().y() - m2.center().y()); //can cause too much variation
-				double dm = std::min(m1.distance(m2.center()), m2.distance(m1.center()));
-				double dref = std::abs(ref1.center().y() - ref2.center().y());
-				//double dref = std::min(ref1.distance(ref2.center()), ref2.distance(ref1.center()));
-
-				//reference line has same vertical position (colinear), but belongs to a different cell
-								
-				// line position must be the same and row position must be the same for top line
-				// or for bottom line rowIdx + rowSpan must be the same
-				if ((mLinePos == neighbour->linePosition() && mRefRowIdx == neighbour->getRowIdx() && mLinePos==rdf::AssociationGraphNode::LinePosition::pos_top) || 
-					(mLinePos == neighbour->linePosition() && (mRefRowIdx+mRowSpan == neighbour->getRowIdx()+neighbour->rowSpan()))) {
-				//if (mLinePos == neighbour->linePosition() && mRefRowIdx == neighbour->getRowIdx()) {
-				//-> problem with distance if lines are not straight... 
-				//if (dref < distThreshold) {
-				//alternatively use:
-				//if (ref1.distance(ref2.p1()) < distThreshold) {
-					
-					double lineDtmp = m1.p1().x() < m2.p1().x() ? m1.distance(m2.p1()) : m2.distance(m1.p1());
-					if (lineDtmp < distThreshold*3) {
-						//matched lines are also "colinear"
-						//check if reference line is left or not, same must apply to matched lines
-						//really? matched line can be line of entire row... test only with true...
-						return true;
-						//if (ref1.p1().x() <= ref2.p1().x() && m1.p1().x() <= m2.p1().x()) {
-						//	return true;
-						//}
-						//else if (ref1.p1().x() > ref2.p1().x() && m1.p1().x() > m2.p1().x()) {
-						//	return true;
-						//}
-					}
-					
-				}
-				else {
-					//reference line has different vertical position
-					//allow only a certain variation
-					if (dref*(1.0 - variationThrLower) < dm && dm < dref*(1.0 + variationThrUpper)) {
-						//bool overlapRef = ref1.horizontalOverlap(ref2) > 10 ? true : false;
-						//bool overlapM = m1.horizontalOverlap(m2) > 10 ? true : false;
-						//reference line is above from second reference line, same must apply to matched lines
-						if (ref1.center().y() < ref2.center().y() && m1.center().y() < m2.center().y()) {
-							//if reference lines have an overlap, same must apply to matched lines
-							//if ((overlapM && overlapRef) || (!overlapM && !overlapRef))
-							return true;
-						}
-						//reference line is beneath from second reference line, same must apply to matched lines
-						else if (ref1.center().y() > ref2.center().y() && m1.center().y() > m2.center().y()) {
-							//if reference lines have an overlap, same must apply to matched lines
-							//if ((overlapM && overlapRef) || (!overlapM && !overlapRef))
-							return true;
-						}
-					}
-				}
-			}
-
-		}
-
-		//no association possible
-		return false;
+		AssociationGraphBuilder agb(distThreshold, variationThrLower, variationThrUpper);
+		return agb.testAdjacency(AssociationGraphBuilder::geometry(*this, horizontal), AssociationGraphBuilder::geometry(*neighbour, horizontal));
 	}
 
 	void AssociationGraphNode::clearAdjacencyList() 	{
@@ -35,6 +35,7 @@
 #include "BaseModule.h"
 #include "LineTrace.h"
 #include "Elements.h"
+#include "Utils.h"
 #pragma warning(push, 0)	// no warnings from includes
 #include <QObject>
 //#include <QJsonObject>
@@ -43,6 +44,8 @@
 //#include <QJsonDocument>
 
 #include <opencv2/core.hpp>
+
+#include <vector>
 #pragma warning(pop)
 
 // TODO: add DllExport magic
@@ -86,10 +89,16 @@ namespace rdf {
 		QString evalPath() const;
 		void setevalPath(QString s);
 
+		int maxCliqueTime() const;
+		void setMaxCliqueTime(int ms);
+
+		int maxCliqueNodes() const;
+		void setMaxCliqueNodes(int n);
+
 		QString toString() const override;
 
 	private:
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		//QString mTemplDatabase;
@@ -106,6 +115,12 @@ namespace rdf {
 
 		bool mSaveChilds = false;
 
+		// max clique search budget: by default the search is exact (unlimited).
+		// if a budget is set and exceeded, the best clique found so far is used - it may not be maximal and a warning is logged.
+		// the node budget is deterministic, whereas results limited by the time budget depend on the machine's speed and load.
+		int mMaxCliqueTime = 0;					//time budget (ms) of the max clique search (<= 0: unlimited)
+		int mMaxCliqueNodes = 0;				//node budget of the max clique search (<= 0: unlimited)
+
 		//int mSearchXOffset = 200;
 		//int mSearchYOffset = 200;
 
@@ -200,6 +215,88 @@ namespace rdf {
 
 	};
 
+	/// <summary>
+	/// Creates the edges of an association graph.
+	/// The geometry of all nodes (sorted lines, centers, cell indexes) is
+	/// extracted once and node pairs are tested in parallel. Nodes of the
+	/// same reference line and nodes with colinear reference lines are
+	/// identified by their cell keys, all other pairs are rejected
+	/// by their position order before distances are computed.
+	/// NOTE: all pairs are enumerated on purpose. Nodes of consistent
+	/// matches must be adjacent irrespective of their distance (e.g. the
+	/// top and bottom line of a table) - otherwise they cannot form a clique.
+	/// The graph of a matched table therefore has O(N^2) edges and a
+	/// distance window (spatial index) would remove edges of the solution.
+	/// </summary>
+	class DllCoreExport AssociationGraphBuilder {
+
+	public:
+		AssociationGraphBuilder(double distThreshold = 20, double variationThrLower = 0.2, double variationThrUpper = 0.2);
+
+		struct Geometry {
+			int cellIdx = -1;
+			int linePos = 0;
+			int rowIdx = -1;
+			int colIdx = -1;
+			int rowSpan = 0;
+			int colSpan = 0;
+			bool horizontal = true;
+			Line referenceLine;			// endpoints sorted w.r.t. horizontal
+			Line matchedLine;			// endpoints sorted w.r.t. horizontal
+			Vector2D referenceCenter;
+			Vector2D matchedCenter;
+		};
+
+		static Geometry geometry(const AssociationGraphNode& node, bool horizontal);
+
+		QVector<QPair<int, int> > edges(const QVector<QSharedPointer<AssociationGraphNode> >& nodes) const;
+		bool testAdjacency(const Geometry& g1, const Geometry& g2) const;
+
+	private:
+		double mDistThreshold = 20;
+		double mVariationThrLower = 0.2;
+		double mVariationThrUpper = 0.2;
+	};
+
+	/// <summary>
+	/// Exact maximum clique search (branch and bound) using packed 64-bit
+	/// adjacency bitsets and bit-parallel greedy colouring as upper bound.
+	/// The search can be limited by a time or node budget. If the budget
+	/// is exceeded, the best clique found so far is returned.
+	/// </summary>
+	class DllCoreExport MaxCliqueSolver {
+
+	public:
+		MaxCliqueSolver(const QVector<QVector<int> >& adjacency = QVector<QVector<int> >());
+
+		void setTimeLimit(int ms);
+		void setNodeLimit(qint64 numNodes);
+
+		QVector<int> solve();
+
+		bool isOptimal() const;
+		qint64 numNodes() const;
+
+	protected:
+		typedef std::vector<quint64> Bitset;
+
+		void expand(Bitset& p, std::vector<int>& clique);
+		void colorSort(const Bitset& p, std::vector<int>& vertices, std::vector<int>& colors) const;
+		bool budgetExceeded();
+
+		int mNumVertices = 0;
+		int mNumWords = 0;
+		std::vector<Bitset> mAdjacency;		// adjacency bitsets (reordered vertices)
+		std::vector<int> mOrder;				// reordered vertex -> original vertex
+
+		std::vector<int> mMaxClique;
+		qint64 mNumNodes = 0;
+		qint64 mNodeLimit = 0;
+		int mTimeLimit = 0;
+		bool mAborted = false;
+		Timer mTimer;
+	};
+
 	class DllCoreExport FormEvaluation {
 
 	public:
@@ -282,7 +379,6 @@ namespace rdf {
 		void createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf::TableCellRaw>> cellsR);
 		QVector<QSharedPointer<rdf::AssociationGraphNode>> mergeColinearNodes(QVector<QSharedPointer<rdf::AssociationGraphNode>> &tmpNodes);
 		void createAssociationGraph();
-		bool** adjacencyMatrix(const QVector<QSharedPointer<rdf::AssociationGraphNode>> &associationGraphNodes);
 		void findMaxCliques();
 		void createTableFromMaxClique(const QVector<QSharedPointer<rdf::TableCell>> &cells);
 		void createTableFromMaxCliqueReduced(const QVector<QSharedPointer<rdf::TableCell>> &cells);
@@ -399,7 +495,7 @@ namespace rdf {
 
 		//only for drawing
 		QVector<QSharedPointer<rdf::TableCellRaw>> mCellsR;
-		//void load(const QSettings& settings) override;
+		//void load(const ConfigSnapshot& settings) override;
 		//void save(QSettings& settings) const override;
 	};
 
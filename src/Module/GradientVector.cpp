@@ -41,12 +41,102 @@ related links:
 #include <QSettings>
 #include <qmath.h>
 #include <opencv2/imgproc.hpp>
+
+#include <cfloat>
 #pragma warning(pop)
 
 
 
 namespace rdf {
 
+	/// <summary>
+	/// Computes dx, dy, the gradient magnitude and orientation of a row range.
+	/// If differentiate is true, dx and dy are computed from the gaussian image
+	/// with central differences (the default { 1, 0, -1 } kernels). Otherwise dx
+	/// and dy need to be computed already.
+	/// Gradients outside the mask are set to 0 and all others are scaled by factor.
+	/// </summary>
+	class GradientBody : public cv::ParallelLoopBody {
+
+	public:
+		GradientBody(const cv::Mat& gaussImg, const cv::Mat& mask, bool differentiate, float factor, bool perpendAngle,
+			cv::Mat& dxImg, cv::Mat& dyImg, cv::Mat& magImg, cv::Mat& radImg) :
+			mGaussImg(gaussImg), mMask(mask), mDifferentiate(differentiate), mFactor(factor), mPerpendAngle(perpendAngle),
+			mDxImg(dxImg), mDyImg(dyImg), mMagImg(magImg), mRadImg(radImg) {
+		}
+
+		void operator()(const cv::Range& r) const override {
+
+			int rows = mDxImg.rows;
+			int cols = mDxImg.cols;
+
+			for (int rIdx = r.start; rIdx < r.end; rIdx++) {
+
+				float* dxPtr = mDxImg.ptr<float>(rIdx);
+				float* dyPtr = mDyImg.ptr<float>(rIdx);
+				const unsigned char* mPtr = mMask.ptr<unsigned char>(rIdx);
+
+				if (mDifferentiate) {
+
+					// with BORDER_REFLECT_101 the central difference is 0 at the image borders
+					if (rIdx == 0 || rIdx == rows - 1) {
+						for (int cIdx = 0; cIdx < cols; cIdx++)
+							dyPtr[cIdx] = 0.0f;
+					}
+					else {
+						const float* uPtr = mGaussImg.ptr<float>(rIdx - 1);
+						const float* lPtr = mGaussImg.ptr<float>(rIdx + 1);
+
+						for (int cIdx = 0; cIdx < cols; cIdx++)
+							dyPtr[cIdx] = uPtr[cIdx] - lPtr[cIdx];
+					}
+
+					const float* gPtr = mGaussImg.ptr<float>(rIdx);
+
+					dxPtr[0] = 0.0f;
+					dxPtr[cols - 1] = 0.0f;
+
+					for (int cIdx = 1; cIdx < cols - 1; cIdx++)
+						dxPtr[cIdx] = gPtr[cIdx - 1] - gPtr[cIdx + 1];
+				}
+
+				for (int cIdx = 0; cIdx < cols; cIdx++) {
+					float f = mPtr[cIdx] ? mFactor : 0.0f;
+					dxPtr[cIdx] *= f;
+					dyPtr[cIdx] *= f;
+				}
+			}
+
+			// magnitude and orientation of the whole block
+			cv::Mat dx = mDxImg.rowRange(r.start, r.end);
+			cv::Mat dy = mDyImg.rowRange(r.start, r.end);
+			cv::Mat mag = mMagImg.rowRange(r.start, r.end);
+			cv::Mat rad = mRadImg.rowRange(r.start, r.end);
+
+			cv::magnitude(dx, dy, mag);
+
+			// NOTE: cv::phase returns [0 2pi) - the accuracy is about 0.3 degrees
+			if (mPerpendAngle) {
+				cv::Mat ndy = -dy;
+				cv::phase(ndy, dx, rad);
+			}
+			else
+				cv::phase(dx, dy, rad);
+		}
+
+	private:
+		const cv::Mat& mGaussImg;
+		const cv::Mat& mMask;
+		bool mDifferentiate;
+		float mFactor;
+		bool mPerpendAngle;
+
+		cv::Mat& mDxImg;
+		cv::Mat& mDyImg;
+		cv::Mat& mMagImg;
+		cv::Mat& mRadImg;
+	};
+
 	GradientVectorConfig::GradientVectorConfig() {
 		mModuleName = "GradientVector";
 	}
@@ -75,24 +165,35 @@ namespace rdf {
 		mPerpendAngle = p;
 	}
 
+	bool GradientVectorConfig::singlePrecision() const {
+		return mSinglePrecision;
+	}
+
+	void GradientVectorConfig::setSinglePrecision(bool sp) {
+		mSinglePrecision = sp;
+	}
+
 
 
 	QString GradientVectorConfig::toString() const {
 		QString msg;
 		msg += "  mSigma: " + QString::number(mSigma);
+		msg += "  mSinglePrecision: " + QString(mSinglePrecision ? "true" : "false");
 		return msg;
 	}
 
-	void GradientVectorConfig::load(const QSettings & settings) {
+	void GradientVectorConfig::load(const ConfigSnapshot & settings) {
 		mSigma = settings.value("sigma", mSigma).toDouble();
 		mNormGrad = settings.value("normGrad", mNormGrad).toBool();
 		mPerpendAngle = settings.value("perpendAngle", mPerpendAngle).toBool();
+		mSinglePrecision = settings.value("singlePrecision", mSinglePrecision).toBool();
 	}
 
 	void GradientVectorConfig::save(QSettings & settings) const {
 		settings.setValue("sigma", mSigma);
 		settings.setValue("normGrad", mNormGrad);
 		settings.setValue("perpendAngle", mPerpendAngle);
+		settings.setValue("singlePrecision", mSinglePrecision);
 	}
 
 	GradientVector::GradientVector(const cv::Mat & img, const cv::Mat & mask)	{
@@ -158,6 +259,11 @@ namespace rdf {
 		if (!checkInput())
 			return false;
 
+		if (config()->singlePrecision()) {
+			computeGradientsFloat();
+			return true;
+		}
+
 		computeGradients();
 
 		//denormalize gradient image?
@@ -346,4 +452,69 @@ namespace rdf {
 		}
 	}
 
+	/// <summary>
+	/// Computes the gradient images with single precision.
+	/// The image is normalized while it is converted to CV_32F,
+	/// then it is smoothed with a separable gaussian. dx, dy, 
+	/// magnitude and orientation are then computed in one row-parallel pass.
+	/// The results correspond to computeGradients(), computeGradMag() and computeGradAngle().
+	/// </summary>
+	void GradientVector::computeGradientsFloat() {
+
+		// get the minimum & maximum for de-normalization
+		minMaxLoc(mSrcImg, &mMinVal, &mMaxVal, 0, 0, mMask);
+
+		// convert & normalize to [0 1] (same as cv::normalize with NORM_MINMAX)
+		double minV = 0, maxV = 0;
+		minMaxLoc(mSrcImg, &minV, &maxV);
+		double scale = (maxV - minV > DBL_EPSILON) ? 1.0 / (maxV - minV) : 0.0;
+		mSrcImg.convertTo(mGaussImg, CV_32F, scale, -minV * scale);
+
+		// compute gaussian image
+		if (config()->sigma() > 1 / 6.0f) {
+			int kSize = cvRound(cvCeil(config()->sigma() * 3) * 2 + 1);
+			cv::Mat gk = cv::getGaussianKernel(kSize, config()->sigma(), CV_32F);
+			cv::sepFilter2D(mGaussImg, mGaussImg, CV_32F, gk, gk);
+		}
+
+		// remove borders if the mask was assigned
+		cv::Mat maskEr;
+		if (!mMask.empty()) {
+			maskEr = rdf::IP::erodeImage(mMask, (int)(config()->sigma()*12.0f), rdf::IP::morph_square, 0);
+			mMask = maskEr;
+		}
+		else
+			maskEr = cv::Mat(mGaussImg.size(), CV_8UC1, cv::Scalar(255));
+
+		if (maskEr.depth() != CV_8U)
+			maskEr.convertTo(maskEr, CV_8U);
+
+		// custom kernels are applied with filter2D - the default kernels are fused with the gradient pass
+		bool differentiate = mDxKernel.empty() && mDyKernel.empty() && mAnchor == cv::Point(-1, -1);
+
+		if (differentiate) {
+			mDxImg.create(mGaussImg.size(), CV_32FC1);
+			mDyImg.create(mGaussImg.size(), CV_32FC1);
+		}
+		else {
+			float diffData[] = { 1, 0, -1 };
+			cv::Mat dxKernel = mDxKernel.empty() ? cv::Mat(1, 3, CV_32F, &diffData) : mDxKernel;
+			cv::Mat dyKernel = mDyKernel.empty() ? cv::Mat(3, 1, CV_32F, &diffData) : mDyKernel;
+
+			filter2D(mGaussImg, mDxImg, CV_32F, dxKernel, mAnchor);
+			filter2D(mGaussImg, mDyImg, CV_32F, dyKernel, mAnchor);
+		}
+
+		mMagImg.create(mGaussImg.size(), CV_32FC1);
+		mRadImg.create(mGaussImg.size(), CV_32FC1);
+
+		//denormalize gradient image?
+		float factor = config()->normGrad() ? 1.0f : (float)(mMaxVal - mMinVal);
+
+		if (config()->perpendAngle()) qDebug() << "WARNING: gradient orientation is perpendicular according setting...";
+
+		GradientBody body(mGaussImg, maskEr, differentiate, factor, config()->perpendAngle(), mDxImg, mDyImg, mMagImg, mRadImg);
+		cv::parallel_for_(cv::Range(0, mGaussImg.rows), body);
+	}
+
 }
@@ -69,17 +69,27 @@ class DllCoreExport GradientVectorConfig : public ModuleConfig {
 		bool perpendAngle() const;
 		void setPerpendAngle(bool p);
 
+		bool singlePrecision() const;
+		void setSinglePrecision(bool sp);
+
 		QString toString() const override;
 
 	private:
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		double mSigma = 1.75;	//filter parameter: maximal difference of line orientation compared to the result of the Rotation module (default: 5 deg)
 		bool mNormGrad = true;
 		bool mPerpendAngle = false;	//if you want to get perpendicular angles compared to the gradient orientation
+		bool mSinglePrecision = true;	//if false, the (slower) CV_64F reference implementation is used
 };
 
+/// <summary>
+/// Computes the gradient magnitude and orientation of an image.
+/// By default all images are CV_32F and dx, dy, magnitude and angle
+/// are computed in a single row-parallel pass. If singlePrecision
+/// is turned off, the original CV_64F implementation is used (e.g. for reference checks).
+/// </summary>
 class DllCoreExport GradientVector : public Module {
 
 
@@ -113,6 +123,7 @@ protected:
 	void computeGradients();
 	void computeGradMag(bool norm);
 	void computeGradAngle();
+	void computeGradientsFloat();
 
 
 private:
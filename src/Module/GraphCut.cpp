@@ -60,7 +60,7 @@ int GraphCutConfig::numIter() const {
 	return mGcIter;
 }
 
-void GraphCutConfig::load(const QSettings & settings) {
+void GraphCutConfig::load(const ConfigSnapshot & settings) {
 
 	mGcIter = settings.value("numIter", mGcIter).toInt();
 	mScaleFactor = settings.value("scaleFactor", mScaleFactor).toDouble();
@@ -111,19 +111,25 @@ QSharedPointer<GCoptimizationGeneralGraph> GraphCutPixel::graphCut(const PixelGr
 	gc->setSmoothCost(sm.ptr<int>());
 	
 	// create neighbors
-	const QVector<QSharedPointer<PixelEdge> >& edges = graph.edges();
+	// NOTE: we do not need edge objects here - a temporary edge (with a constant id) is enough to compute the weights
+	const QVector<IndexEdge> edges = graph.indexEdges();
+	const QString edgeId("gc-edge");
+
 	for (int idx = 0; idx < pixel.size(); idx++) {
 
-		for (int edgeIdx : graph.edgeIndexes(pixel.at(idx)->id())) {
+		for (int edgeIdx : graph.edgeIndexes(idx)) {
 
-			assert(edgeIdx != -1);
+			assert(edgeIdx >= 0 && edgeIdx < edges.size());
 
 			// get vertex ID
-			const QSharedPointer<PixelEdge>& pe = edges[edgeIdx];
-			int sVtxIdx = graph.pixelIndex(pe->second()->id());
+			int sVtxIdx = edges[edgeIdx].second();
+
+			if (sVtxIdx < 0)
+				continue;
 
 			// compute weight
-			double rawWeight = mWeightFnc(pe.data());
+			PixelEdge pe(pixel[idx], pixel[sVtxIdx], edgeId);
+			double rawWeight = mWeightFnc(&pe);
 			int w = qRound(rawWeight * config()->scaleFactor());
 
 			gc->setNeighbors(idx, sVtxIdx, w);
@@ -176,7 +182,7 @@ bool GraphCutOrientation::compute() {
 	}
 
 	// create graph
-	PixelGraph graph(mSet);
+	PixelGraph graph(mSet, PixelGraph::storage_compact);
 	graph.connect(*mConnector);
 
 	// perform graphcut
@@ -292,7 +298,7 @@ bool GraphCutPixelLabel::compute() {
 	}
 
 	// create graph
-	PixelGraph graph(mSet);
+	PixelGraph graph(mSet, PixelGraph::storage_compact);
 	graph.connect(*mConnector);
 
 	// perform graphcut
@@ -425,7 +431,7 @@ bool GraphCutTextLine::compute() {
 	);
 
 	// create graph & perform energy minimization
-	PixelGraph graph(mSet);
+	PixelGraph graph(mSet, PixelGraph::storage_compact);
 	graph.connect(*mConnector);
 	auto gc = graphCut(graph);
 
@@ -764,7 +770,7 @@ bool GraphCutLineSpacing::compute() {
 		return true;
 
 	// create graph
-	PixelGraph graph(mSet);
+	PixelGraph graph(mSet, PixelGraph::storage_compact);
 	graph.connect(*mConnector);
 
 	// perform graphcut
@@ -932,7 +938,7 @@ int GraphCutLineSpacingConfig::numLabels() const {
 	return mNumLabels;
 }
 
-void GraphCutLineSpacingConfig::load(const QSettings & settings) {
+void GraphCutLineSpacingConfig::load(const ConfigSnapshot & settings) {
 	
 	GraphCutConfig::load(settings);
 	mNumLabels = settings.value("numLabels", mNumLabels).toInt();
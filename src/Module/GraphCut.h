@@ -66,7 +66,7 @@ public:
 	int numIter() const;
 
 protected:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	double mScaleFactor = 1000.0;	// scale factor to use (faster) int instead of double
@@ -184,7 +184,7 @@ public:
 	int numLabels() const;
 
 protected:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	int mNumLabels = 15;		// number of scale bins (empirically set to 15)
@@ -43,6 +43,7 @@
 #include "ElementsHelper.h"
 #include "PageParser.h"
 #include "LineTrace.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 
@@ -102,7 +103,7 @@ QString LayoutAnalysisConfig::classifierPath() const {
 	return mClassifierPath;
 }
 
-void LayoutAnalysisConfig::load(const QSettings & settings) {
+void LayoutAnalysisConfig::load(const ConfigSnapshot & settings) {
 
 	mMinSuperPixelsPerBlock	= settings.value("minSuperPixelsPerBlock", minSuperixelsPerBlock()).toInt();
 	mRemoveWeakTextLines	= settings.value("removeWeakTextLines", removeWeakTextLines()).toBool();
@@ -141,6 +142,7 @@ bool LayoutAnalysis::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileScope("LayoutAnalysis");
 	Timer dt;
 
 	cv::Mat img = mImg;
@@ -197,7 +199,7 @@ bool LayoutAnalysis::compute() {
 
 	if (QFileInfo(config()->classifierPath()).exists()) {
 		// classify pixel
-		QSharedPointer<SuperPixelModel> model = SuperPixelModel::read(config()->classifierPath());
+		QSharedPointer<const SuperPixelModel> model = SuperPixelModel::readCached(config()->classifierPath());
 
 		auto f = model->model();
 		if (f->isTrained())
@@ -289,6 +291,11 @@ cv::Mat LayoutAnalysis::draw(const cv::Mat & img, const QColor& col) const {
 	QPainter p(&qImg);
 	p.setPen(ColorManager::blue());
 
+	// results are in original coordinates - draw them on reduced images too
+	Vector2D os = mScaleFactory ? mScaleFactory->imgSize() : Vector2D();
+	if (!os.isNull() && (img.cols != qRound(os.x()) || img.rows != qRound(os.y())))
+		p.scale(img.cols / os.x(), img.rows / os.y());
+
 	for (auto l : mStopLines) {
 		l.setThickness(3);
 		l.draw(p);
@@ -360,6 +367,19 @@ QSharedPointer<ScaleFactory> LayoutAnalysis::scaleFactory() const {
 	return mScaleFactory;
 }
 
+/// <summary>
+/// Sets the scale factory of the original image.
+/// Use this if the image was decoded at the processing
+/// resolution (see ImageReader) - results are then
+/// mapped to the original image size.
+/// </summary>
+/// <param name="sf">The scale factory of the original image.</param>
+void LayoutAnalysis::setScaleFactory(const QSharedPointer<ScaleFactory>& sf) {
+
+	if (sf)
+		mScaleFactory = sf;
+}
+
 bool LayoutAnalysis::checkInput() const {
 
 	return !isEmpty();
@@ -414,6 +434,8 @@ QVector<Line> LayoutAnalysis::createStopLines() const {
 
 bool LayoutAnalysis::computeLocalStats(PixelSet & pixels) const {
 
+	rdfProfileScope("LocalStats");
+
 	// find local orientation per pixel
 	rdf::LocalOrientation lo(pixels);
 	lo.config()->setScaleFactory(mScaleFactory);
@@ -84,7 +84,7 @@ public:
 
 protected:
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	bool mRemoveWeakTextLines = true;		// if true, unstable text lines are removed
@@ -113,6 +113,7 @@ public:
 	PixelSet pixels() const;
 	
 	QSharedPointer<ScaleFactory> scaleFactory() const;
+	void setScaleFactory(const QSharedPointer<ScaleFactory>& sf);
 
 private:
 	bool checkInput() const override;
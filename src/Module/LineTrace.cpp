@@ -95,7 +95,7 @@ namespace rdf {
 		return msg;
 	}
 
-	void LineFilterConfig::load(const QSettings & settings) {
+	void LineFilterConfig::load(const ConfigSnapshot & settings) {
 
 		mMaxSlopeRotat = settings.value("maxSlopeRotat", mMaxSlopeRotat).toFloat();
 		mMinLength = settings.value("minLength", mMinLength).toInt();
@@ -674,7 +674,7 @@ namespace rdf {
 		return msg;
 	}
 
-	void LineTraceConfig::load(const QSettings & settings) 	{
+	void LineTraceConfig::load(const ConfigSnapshot & settings) 	{
 
 		mMaxAspectRatio = settings.value("maxAspectRatio", mMaxAspectRatio).toFloat();
 		mMinWidth = settings.value("minWidth", mMinWidth).toInt();
@@ -722,7 +722,7 @@ namespace rdf {
 		return ModuleConfig::toString();
 	}
 
-	void LineTraceLSDConfig::load(const QSettings & settings) {
+	void LineTraceLSDConfig::load(const ConfigSnapshot & settings) {
 
 		mScale = settings.value("scale", scale()).toDouble();
 	}
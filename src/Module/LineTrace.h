@@ -74,7 +74,7 @@ public:
 	QString toString() const override;
 
 private:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	double mMaxSlopeRotat = 10.0;	//filter parameter: maximal difference of line orientation compared to the result of the Rotation module (default: 10°)
@@ -129,7 +129,7 @@ public:
 	QString toString() const override;
 
 private:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	int mMinLenSecondRun = 60;    //min len to filter after merge lines; was 60
@@ -207,7 +207,7 @@ public:
 	QString toString() const override;
 
 private:
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	double mScale = 0.5;		// initial downscaling of the image
@@ -66,7 +66,7 @@ protected:
 
 	int mMaxSide = 200;
 
-	//void load(const QSettings& settings) override;
+	//void load(const ConfigSnapshot& settings) override;
 	//void save(QSettings& settings) const override;
 };
 
@@ -691,7 +691,7 @@ namespace rdf {
 		return msg;
 	}
 
-	void BaseSkewEstimationConfig::load(const QSettings & settings)	{
+	void BaseSkewEstimationConfig::load(const ConfigSnapshot & settings)	{
 			mW = settings.value("sepW", mW).toInt();	
 			mH = settings.value("sepH", mH).toInt();
 			mThr = settings.value("thr", mThr).toDouble();
@@ -734,7 +734,7 @@ namespace rdf {
 		return mMaxAngle;
 	}
 
-	void TextLineSkewConfig::load(const QSettings & settings) {
+	void TextLineSkewConfig::load(const ConfigSnapshot & settings) {
 
 		mMinAngle = settings.value("minAngle", minAngle()).toDouble();
 		mMaxAngle = settings.value("maxAngle", maxAngle()).toDouble();
@@ -98,7 +98,7 @@ namespace rdf {
 		QString toString() const override;
 
 	private:
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		int mW = 168; //49 according to the paper, best for document: 60
@@ -179,7 +179,7 @@ namespace rdf {
 
 	protected:
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		double mMinAngle = -CV_PI;			// minimum angle expected in radians
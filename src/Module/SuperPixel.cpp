@@ -38,6 +38,7 @@
 #include "Utils.h"
 #include "LineTrace.h"
 #include "ScaleFactory.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
@@ -180,6 +181,8 @@ bool SuperPixel::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileModule();
+	rdfProfileScope("MSER");
 	Timer dt;
 
 	cv::Mat img = mSrcImg.clone();
@@ -227,6 +230,7 @@ bool SuperPixel::compute() {
 QString SuperPixel::toString() const {
 
 	QString msg = debugName();
+	msg += mStats.toString();
 
 	return msg;
 }
@@ -361,7 +365,7 @@ int SuperPixelConfig::numErosionLayers() const {
 	return checkParam(mNumErosionLayers, 0, 20, "numErosionLayers");
 }
 
-void SuperPixelConfig::load(const QSettings & settings) {
+void SuperPixelConfig::load(const ConfigSnapshot & settings) {
 
 	// add parameters
 	mMserMinArea = settings.value("mserMinArea", mserMinArea()).toInt();
@@ -448,7 +452,7 @@ void LocalOrientationConfig::setMinScale(int minScale) {
 	mMinScale = minScale;
 }
 
-void LocalOrientationConfig::load(const QSettings & settings) {
+void LocalOrientationConfig::load(const ConfigSnapshot & settings) {
 
 	// add parameters
 	mMaxScale = settings.value("MaxScale", mMaxScale).toInt();
@@ -802,7 +806,7 @@ int LinePixelConfig::minLineLength() const {
 	return checkParam(mMinLineLength, 0, 1000, "minLineLength");
 }
 
-void LinePixelConfig::load(const QSettings & settings) {
+void LinePixelConfig::load(const ConfigSnapshot & settings) {
 
 	mMinLineLength = settings.value("minLineLength", minLineLength()).toInt();
 }
@@ -822,6 +826,8 @@ bool GridSuperPixel::compute() {
 	if (!checkInput())
 		return false;
 
+	rdfProfileModule();
+
 	Timer dt;
 
 	// estimate the window size from the source image?
@@ -1062,6 +1068,7 @@ cv::Mat GridSuperPixel::lineMask(const cv::Mat & src) const {
 QString GridSuperPixel::toString() const {
 
 	QString msg = debugName();
+	msg += mStats.toString();
 
 	return msg;
 }
@@ -1144,7 +1151,7 @@ bool GridPixelConfig::applyLineMask() const {
 	return mLineMask;
 }
 
-void GridPixelConfig::load(const QSettings & settings) {
+void GridPixelConfig::load(const ConfigSnapshot & settings) {
 
 	// add parameters
 	mAutoWinSize = settings.value("autoWinSize", autoWindowSize()).toBool();
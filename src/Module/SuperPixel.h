@@ -114,7 +114,7 @@ protected:
 	int mErosionStep = 4;
 	int mNumErosionLayers = 3;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -187,7 +187,7 @@ public:
 protected:
 	int mMinLineLength = 5;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -240,7 +240,7 @@ protected:
 	double mMinEnergy = 0.07;		// minimum energy per cell
 	bool mLineMask = true;			// if true, straight lines are removed
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -342,7 +342,7 @@ protected:
 	int mNumOr = 32;		// number of orientation histograms
 	int mHistSize = 64;		// size of the orientation histogram
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -36,6 +36,7 @@
 #include "Image.h"
 #include "Drawer.h"
 #include "ImageProcessor.h"
+#include "Profiler.h"
 
 #include "Elements.h"
 #include "ElementsHelper.h"
@@ -74,7 +75,7 @@ QString SuperPixelClassifierConfig::classifierPath() const {
 	return mClassifierPath;
 }
 
-void SuperPixelClassifierConfig::load(const QSettings & settings) {
+void SuperPixelClassifierConfig::load(const ConfigSnapshot & settings) {
 	mClassifierPath = settings.value("classifierPath", mClassifierPath).toString();
 }
 
@@ -98,9 +99,14 @@ bool SuperPixelClassifier::isEmpty() const {
 
 bool SuperPixelClassifier::compute() {
 
+	// fall back to the (shared) model specified in the settings
+	if (!mModel && !config()->classifierPath().isEmpty())
+		mModel = SuperPixelModel::readCached(config()->classifierPath());
+
 	if (!checkInput())
 		return false;
 
+	rdfProfileScope("SuperPixelClassifier");
 	Timer dt;
 
 	// compute features
@@ -164,7 +170,7 @@ QString SuperPixelClassifier::toString() const {
 	return Module::toString();
 }
 
-void SuperPixelClassifier::setModel(const QSharedPointer<SuperPixelModel>& model) {
+void SuperPixelClassifier::setModel(const QSharedPointer<const SuperPixelModel>& model) {
 	mModel = model;
 }
 
@@ -214,22 +220,24 @@ bool SuperPixelFeature::compute() {
 
 	assert(cImg.type() == CV_8UC1);
 
+	QVector<QSharedPointer<Pixel> > pixels = mSet.pixels();
 	std::vector<cv::KeyPoint> keypoints;
-	for (const QSharedPointer<const Pixel>& px : mSet.pixels()) {
-		assert(px);
-		keypoints.push_back(px->toKeyPoint());
+	keypoints.reserve(pixels.size());
+
+	for (int idx = 0; idx < pixels.size(); idx++) {
+		assert(pixels[idx]);
+		cv::KeyPoint kp = pixels[idx]->toKeyPoint();
+		kp.class_id = idx;	// remember the pixel for syncing
+		keypoints.push_back(kp);
 	}
 
 	mInfo << "# keypoints before ORB" << keypoints.size();
 
-
-	std::vector<cv::KeyPoint> kptsIn(keypoints.begin(), keypoints.end());
-
 	cv::Ptr<cv::ORB> features = cv::ORB::create();
 	features->compute(cImg, keypoints, mDescriptors);
 
 	// remove SuperPixels that were removed during feature creation
-	syncSuperPixels(kptsIn, keypoints);
+	syncSuperPixels(keypoints);
 
 	mInfo << mDescriptors.rows << "features computed in" << dt;
 
@@ -285,31 +293,67 @@ bool SuperPixelFeature::checkInput() const {
 /// Synchronizes the super pixels with the features.
 /// This function removes SuperPixels from the PixelSet.
 /// This is needed since OpenCV removes keypoints that could
-/// not be computed. Using this function guarantees that the
-/// ith SuperPixel corresponds with the ith row of the feature
-/// matrix. NOTE: if we use descriptors such as SIFT which
+/// not be computed (and ORB might re-order them w.r.t. their octave). 
+/// Using this function guarantees that the ith SuperPixel 
+/// corresponds with the ith row of the feature matrix. 
+/// Each keypoint's class_id must hold the index of the pixel
+/// it was created from. The original order of the pixels is kept.
+/// NOTE: if we use descriptors such as SIFT which
 /// _add_ KeyPoints we're again out-of-sync.
 /// </summary>
-/// <param name="keyPointsOld">The key points before feature computation.</param>
-/// <param name="keyPointsNew">The key points after feature computation (less than keyPointsOld).</param>
-void SuperPixelFeature::syncSuperPixels(const std::vector<cv::KeyPoint>& keyPointsOld, const std::vector<cv::KeyPoint>& keyPointsNew) {
+/// <param name="keyPoints">The key points after feature computation (class_id = pixel index).</param>
+void SuperPixelFeature::syncSuperPixels(const std::vector<cv::KeyPoint>& keyPoints) {
+
+	QVector<QSharedPointer<Pixel> > pixels = mSet.pixels();
+
+	// descriptor row of each pixel (-1 if the pixel was removed)
+	QVector<int> rowIdx(pixels.size(), -1);
+	bool inOrder = (int)keyPoints.size() == mDescriptors.rows;
+
+	for (int rIdx = 0; rIdx < (int)keyPoints.size() && rIdx < mDescriptors.rows; rIdx++) {
 
-	// sync keypoints
-	QVector<cv::KeyPoint> kptsOut = QVector<cv::KeyPoint>::fromStdVector(keyPointsNew);
+		int pIdx = keyPoints[rIdx].class_id;
 
-	QList<int> removeIdx;
-	for (size_t idx = 0; idx < keyPointsOld.size(); idx++) {
+		if (pIdx < 0 || pIdx >= pixels.size() || rowIdx[pIdx] != -1) {
+			mWarning << "illegal keypoint id" << pIdx << "- ignoring its descriptor";
+			inOrder = false;
+			continue;
+		}
 
+		if (rIdx > 0 && pIdx < keyPoints[rIdx - 1].class_id)
+			inOrder = false;
 
-		int kIdx = kptsOut.indexOf(keyPointsOld[idx]);
-		if (kIdx == -1)
-			removeIdx << (int)idx;
+		rowIdx[pIdx] = rIdx;
 	}
 
-	qSort(removeIdx.begin(), removeIdx.end(), qGreater<int>());
-	for (int ri : removeIdx) 
-		mSet.remove(mSet.pixels()[ri]);
+	// compact the pixels (and descriptors if needed) in one pass
+	QVector<QSharedPointer<Pixel> > syncedPixels;
+	syncedPixels.reserve((int)keyPoints.size());
+	cv::Mat syncedDesc;
 
+	if (!inOrder)
+		syncedDesc.create((int)keyPoints.size(), mDescriptors.cols, mDescriptors.type());
+
+	for (int pIdx = 0; pIdx < pixels.size(); pIdx++) {
+
+		int rIdx = rowIdx[pIdx];
+		if (rIdx == -1)
+			continue;
+
+		if (!inOrder)
+			mDescriptors.row(rIdx).copyTo(syncedDesc.row(syncedPixels.size()));
+
+		syncedPixels << pixels[pIdx];
+	}
+
+	if (!inOrder)
+		mDescriptors = syncedDesc.rowRange(0, syncedPixels.size());
+
+	if (syncedPixels.size() != pixels.size()) {
+		PixelSet set(syncedPixels);
+		set.setId(mSet.id());
+		mSet = set;
+	}
 }
 
 }
\ No newline at end of file
@@ -60,7 +60,7 @@ public:
 
 protected:
 
-	//void load(const QSettings& settings) override;
+	//void load(const ConfigSnapshot& settings) override;
 	//void save(QSettings& settings) const override;
 };
 
@@ -87,7 +87,7 @@ private:
 	cv::Mat mDescriptors;
 
 	bool checkInput() const override;
-	void syncSuperPixels(const std::vector<cv::KeyPoint>& keyPointsOld, const std::vector<cv::KeyPoint>& keyPointsNew);
+	void syncSuperPixels(const std::vector<cv::KeyPoint>& keyPoints);
 };
 
 class DllCoreExport SuperPixelClassifierConfig : public ModuleConfig {
@@ -104,7 +104,7 @@ protected:
 
 	QString mClassifierPath;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -120,13 +120,13 @@ public:
 	cv::Mat draw(const cv::Mat& img) const;
 	QString toString() const override;
 
-	void setModel(const QSharedPointer<SuperPixelModel>& model);
+	void setModel(const QSharedPointer<const SuperPixelModel>& model);
 	PixelSet pixelSet() const;
 
 private:
 	cv::Mat mImg;
 	PixelSet mSet;
-	QSharedPointer<SuperPixelModel> mModel;
+	QSharedPointer<const SuperPixelModel> mModel;
 
 	bool checkInput() const override;
 };
@@ -120,7 +120,7 @@ QString SuperPixelLabelerConfig::toString() const {
 	return ModuleConfig::toString();
 }
 
-void SuperPixelLabelerConfig::load(const QSettings & settings) {
+void SuperPixelLabelerConfig::load(const ConfigSnapshot & settings) {
 	
 	mFeatureFilePath = settings.value("featureFilePath", mFeatureFilePath).toString();
 	mLabelConfigFilePath = settings.value("labelConfigFilePath", mLabelConfigFilePath).toString();
@@ -452,23 +452,24 @@ bool operator==(const FeatureCollection& fcl, const FeatureCollection& fcr) {
 	return fcl.label() == fcr.label();
 }
 
-QJsonObject FeatureCollection::toJson(const QString& filePath) const {
+/// <summary>
+/// Returns the collection's JSON.
+/// If a (writable) binary container is specified, the descriptors
+/// are appended to it and the JSON only keeps their meta data.
+/// Otherwise the descriptors are embedded.
+/// </summary>
+/// <param name="matFile">An optional binary container.</param>
+/// <returns></returns>
+QJsonObject FeatureCollection::toJson(MatFile* matFile) const {
 
 	QJsonObject jo;
 	mLabel.toJson(jo);
 
 	// embed features
-	if (filePath == "")
+	if (!matFile)
 		jo.insert("descriptors", Image::matToJson(mDesc));
-	else {
-
-		// write data to external file
-		QString fp = Utils::createFilePath(filePath, "-" + Utils::timeStampFileName(mLabel.name(), ""), "rdf");
-		Image::writeMat(mDesc, fp);
-
-		QFileInfo fi(fp);
-		jo.insert("descriptors", Image::matToJsonExtern(mDesc, fi.fileName()));
-	}
+	else
+		jo.insert("descriptors", matFile->append(mDesc));
 
 	return jo;
 }
@@ -552,11 +553,19 @@ bool FeatureCollectionManager::isEmpty() const {
 
 QJsonObject FeatureCollectionManager::toJson(const QString & filePath) const {
 	
-	QJsonArray ja;
+	quint64 numBytes = 0;
+	for (const FeatureCollection& fc : mCollection)
+		numBytes += (quint64)fc.descriptors().total() * fc.descriptors().elemSize();
+
+	// large descriptors are stored in a binary container next to the JSON
+	// this way, the JSON does not hit its size limit (~40MB)
+	bool binary = !filePath.isEmpty() && numBytes >= MatFile::embedLimit();
+	MatFile mf(binary ? Utils::createFilePath(filePath, "-features", MatFile::suffix()) : "");
+	binary = binary && mf.open(QIODevice::WriteOnly);
 
-	// NOTE: JSON objects have a size limit ~40MB
+	QJsonArray ja;
 	for (const FeatureCollection& fc : mCollection) {
-		ja << fc.toJson(filePath);
+		ja << fc.toJson(binary ? &mf : 0);
 	}
 
 	QJsonObject jo;
@@ -588,17 +597,7 @@ FeatureCollectionManager FeatureCollectionManager::fromJson(const QJsonObject &
 
 void FeatureCollectionManager::write(const QString & filePath) const {
 
-	QJsonArray ja;
-
-	// NOTE: JSON objects have a size limit ~40MB
-	for (const FeatureCollection& fc : mCollection) {
-		ja << fc.toJson(filePath);
-	}
-	
-	QJsonObject jo;
-	jo.insert(FeatureCollection::jsonKey(), ja);
-
-	Utils::writeJson(filePath, jo);
+	Utils::writeJson(filePath, toJson(filePath));
 }
 
 FeatureCollectionManager FeatureCollectionManager::read(const QString & filePath) {
@@ -889,7 +888,7 @@ int SuperPixelTrainerConfig::numTrees() const {
 	return mNumTrees;
 }
 
-void SuperPixelTrainerConfig::load(const QSettings & settings) {
+void SuperPixelTrainerConfig::load(const ConfigSnapshot & settings) {
 
 	QString paths = settings.value("featureCachePaths", mFeatureCachePaths.join(",")).toString();
 	mFeatureCachePaths = paths.split(",");
@@ -62,6 +62,7 @@ namespace rdf {
 class Region;
 class RootRegion;
 class PageElement;
+class MatFile;
 
 /// <summary>
 /// FeatureCollection maps one LabelInfo to its features.
@@ -73,7 +74,7 @@ public:
 	FeatureCollection(const cv::Mat& descriptors = cv::Mat(), const LabelInfo& label = LabelInfo());
 	friend DllCoreExport bool operator==(const FeatureCollection& fcl, const FeatureCollection& fcr);
 
-	QJsonObject toJson(const QString& filePath = "") const;
+	QJsonObject toJson(MatFile* matFile = 0) const;
 	static FeatureCollection read(QJsonObject& jo, const QString& filePath = "");
 
 	void append(const cv::Mat& descriptor);
@@ -154,7 +155,7 @@ public:
 
 protected:
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 
 	QString mFeatureFilePath;
@@ -232,7 +233,7 @@ protected:
 	QString mModelPath;
 	int mNumTrees = 150;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
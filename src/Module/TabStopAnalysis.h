@@ -63,7 +63,7 @@ public:
 
 protected:
 
-	//void load(const QSettings& settings) override;
+	//void load(const ConfigSnapshot& settings) override;
 	//void save(QSettings& settings) const override;
 };
 
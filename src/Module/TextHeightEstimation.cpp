@@ -45,6 +45,32 @@ related links:
 
 namespace rdf {
 
+	/// <summary>
+	/// Computes the spectrum peaks of the vertical profiles of all patches of a layer.
+	/// </summary>
+	class PatchSpectrumBody : public cv::ParallelLoopBody {
+
+	public:
+		PatchSpectrumBody(const cv::Mat& img, const std::vector<cv::Rect>& patches, std::vector<double>& maxVals, std::vector<cv::Point>& maxLocs) :
+			mImg(img), mPatches(patches), mMaxVals(maxVals), mMaxLocs(maxLocs) {
+		}
+
+		void operator()(const cv::Range& r) const override {
+
+			for (int idx = r.start; idx < r.end; idx++) {
+				cv::Mat vPP = TextHeightEstimation::verticalProfileAcf(mImg(mPatches[idx]));
+				TextHeightEstimation::spectrumPeak(vPP, mMaxVals[idx], mMaxLocs[idx]);
+			}
+		}
+
+	private:
+		const cv::Mat& mImg;
+		const std::vector<cv::Rect>& mPatches;
+		std::vector<double>& mMaxVals;
+		std::vector<cv::Point>& mMaxLocs;
+	};
+
+
 
 	// LayoutAnalysisConfig --------------------------------------------------------------------
 	TextHeightEstimationConfig::TextHeightEstimationConfig() : ModuleConfig("Text Height Estimation Module") {
@@ -78,7 +104,7 @@ namespace rdf {
 		return mDebugPath;
 	}
 
-	void TextHeightEstimationConfig::load(const QSettings & settings) {
+	void TextHeightEstimationConfig::load(const ConfigSnapshot & settings) {
 
 		mDebugDraw = settings.value("debugDraw", debugDraw()).toBool();
 		mNumSplitLevels = settings.value("numSplitLevels", numSplitLevels()).toInt();
@@ -214,35 +240,21 @@ namespace rdf {
 			cv::Mat maxMagHist = cv::Mat::zeros(100, 1, CV_32F);
 			cv::Mat maxMagCount = cv::Mat::zeros(100, 1, CV_8U);
 			
-			//process each patch of the current layer
-			for (auto pi : layer) {
-
-				cv::Mat patch = img(pi->yRange, pi->xRange).clone();
-				cv::Mat nacImg = nacf(patch); //compute normalized auto correlation
-				cv::Mat vPP, vPPdft, mag;
-
-				//compute vertical projection profile of nac image
-				reduce(nacImg, vPP, 1, CV_REDUCE_SUM, CV_32F);
+			//process the patches (ROIs - no copies) of the current layer in parallel
+			std::vector<cv::Rect> patches;
+			for (auto pi : layer)
+				patches.push_back(cv::Rect(pi->xRange.start, pi->yRange.start, pi->xRange.size(), pi->yRange.size()));
 
-				//compute DFT of PP and magnitudes of the DFT coefficients
-				cv::dft(vPP, vPPdft, cv::DFT_COMPLEX_OUTPUT);
+			std::vector<double> maxVals(patches.size(), 0.0);
+			std::vector<cv::Point> maxLocs(patches.size());
+			cv::parallel_for_(cv::Range(0, (int)patches.size()), PatchSpectrumBody(img, patches, maxVals, maxLocs));
 
-				std::vector<cv::Mat> planes;
-				split(vPPdft, planes);
-				magnitude(planes[0], planes[1], mag);
-
-				//find index of coefficient with max magnitude
-				mag.at<float>(0, 0) = 0;	//discard constant component (0 index coefficient)
-				mag = mag(cv::Range(0, std::min(mag.rows / 2, 100)), cv::Range(0, 1));	//ignore coefficients with index > 100 (assumption -> max 100 lines per page)
-
-				double maxVal;
-				cv::Point maxLoc;
-				cv::minMaxLoc(mag, NULL, &maxVal, NULL, &maxLoc);
+			for (int pIdx = 0; pIdx < layer.size(); pIdx++) {
 
 				//save max magnitude to magnitude histogram of this patch layer
-				if (maxLoc.y > 1) {	//outlier pruning: index <= 1 likely to be figure or sparse patch
-					maxMagHist.at<float>(maxLoc) += (float)maxVal;
-					maxMagCount.at<uchar>(maxLoc) += 1;
+				if (maxLocs[pIdx].y > 1) {	//outlier pruning: index <= 1 likely to be figure or sparse patch
+					maxMagHist.at<float>(maxLocs[pIdx]) += (float)maxVals[pIdx];
+					maxMagCount.at<uchar>(maxLocs[pIdx]) += 1;
 				}
 			}
 
@@ -298,27 +310,12 @@ namespace rdf {
 
 			for (auto pi : layer) {
 
-				cv::Mat patch = img(pi->yRange, pi->xRange).clone();
-				cv::Mat nacImg = nacf(patch); //compute normalize auto correlation
-				cv::Mat vPP, vPPdft, mag;
-
-				//compute vertical projection profile of nac image
-				reduce(nacImg, vPP, 1, CV_REDUCE_SUM, CV_32F);
-
-				//compute DFT of PP and magnitudes of the DFT coefficients
-				cv::dft(vPP, vPPdft, cv::DFT_COMPLEX_OUTPUT);
-
-				std::vector<cv::Mat> planes;
-				split(vPPdft, planes);
-				magnitude(planes[0], planes[1], mag);
-
-				//find index of coefficient with max magnitude
-				mag.at<float>(0, 0) = 0;	//discard constant component (0 index coefficient)
-				mag = mag(cv::Range(0, std::min(mag.rows / 2, 100)), cv::Range(0, 1));	//ignore coefficients with index > 100 (assumption -> max 100 lines per page)
+				cv::Mat patch = img(pi->yRange, pi->xRange);
+				cv::Mat vPP = verticalProfileAcf(patch);	//same auto correlation as processImagePatches
 
 				double maxVal;
 				cv::Point maxLoc;
-				cv::minMaxLoc(mag, NULL, &maxVal, NULL, &maxLoc);
+				spectrumPeak(vPP, maxVal, maxLoc);
 
 				//save max magnitude to magnitude histogram of this patch layer
 				if (maxLoc.y > 1) {	//outlier pruning: index <= 1 likely to be figure or sparse patch
@@ -327,8 +324,8 @@ namespace rdf {
 				}
 
 				//debug draw-------------------------------------------------------------------------------------------------------------------------
-				//draw vertical projection profile within nac image
-				nacImg.convertTo(nacImg, CV_8U, 255);
+				//draw vertical projection profile (normalized auto correlation) within the patch
+				cv::Mat nacImg = patch.clone();
 
 				int max_x = nacImg.cols - 1;
 				for (int j = 1; j < vPP.rows; j++) {
@@ -337,22 +334,6 @@ namespace rdf {
 					cv::line(nacImg, p1, p2, cv::Scalar(255), 2, 8, 0);
 				}
 
-				//draw magnitudes
-				//normalize(mag, mag, 0, nacImg.cols/2.0, CV_MINMAX);
-				//for (int j = 0; j < mag.rows; j++) {
-				//	cv::Point p1 = cv::Point(0, j);
-				//	cv::Point p2 = cv::Point((int)round(mag.at<float>(j)), j);
-				//	cv::line(nacImg, p1, p2, cv::Scalar(255), 1, 8, 0);
-				//}
-
-				//draw patch and result values in original image
-				QImage qImg = Image::mat2QImage(nacImg, true);
-				QPainter painter(&qImg);
-				//painter.setPen(QColor(150,150,150,255));
-				//QString outText = "maxMagIndex=" + QString::number(maxLoc.y) + "\n" + "maxMag=" + QString::number(maxVal);
-				//painter.drawText(qImg.rect(), QTextOption::WrapAtWordBoundaryOrAnywhere || Qt::AlignTop || Qt::AlignLeft, outText);
-				nacImg = Image::qImage2Mat(qImg);
-				cv::cvtColor(nacImg, nacImg, cv::COLOR_BGR2GRAY);
 				nacImg.copyTo(nacLayer(pi->yRange, pi->xRange));
 				//debug draw-------------------------------------------------------------------------------------------------------------------------
 			}
@@ -436,23 +417,80 @@ namespace rdf {
 		return accPMF;
 	}
 
-	cv::Mat TextHeightEstimation::nacf(const cv::Mat patchImg) {
+	/// <summary>
+	/// Computes the vertical projection profile of the patch's normalized auto correlation.
+	/// The row sums of the (circular) 2D auto correlation equal the auto correlation of the
+	/// patch's row profile. Hence, it is computed with a 1D DFT of the zero padded row profile
+	/// (at an optimal DFT size) - circular lags are folded back afterwards.
+	/// Like the former 2D version, it is normalized by the range of the 2D auto correlation:
+	/// its maximum is the patch's energy (zero lag) and its minimum is approximated by the
+	/// profile's minimum / patch.cols. On text fixtures, the layer weights differ by less
+	/// than 7% from the 2D version (see TextHeightTest). Patch can be a ROI (no data is copied).
+	/// </summary>
+	/// <param name="patch">The gray scale image patch.</param>
+	/// <returns>The vertical projection profile (rows x 1, CV_32F).</returns>
+	cv::Mat TextHeightEstimation::verticalProfileAcf(const cv::Mat& patch) {
+
+		int n = patch.rows;
+		cv::Mat vPP = cv::Mat::zeros(n, 1, CV_32F);
+
+		if (n < 2)
+			return vPP;
+
+		//row profile - zero padded to an optimal DFT size >= 2n-1 (linear auto correlation)
+		int dftSize = cv::getOptimalDFTSize(2 * n - 1);
+		cv::Mat profile = cv::Mat::zeros(dftSize, 1, CV_64F);
+		cv::reduce(patch, profile.rowRange(0, n), 1, CV_REDUCE_SUM, CV_64F);
+
+		cv::Mat spec, acf;
+		cv::dft(profile, spec, cv::DFT_COMPLEX_OUTPUT);
+		cv::Mat power;
+		cv::mulSpectrums(spec, spec, power, 0, true);
+		cv::dft(power, acf, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+
+		//fold negative lags to get the circular auto correlation
+		const double* ap = acf.ptr<double>();
+		cv::Mat cacf(n, 1, CV_64F);
+		double* cp = cacf.ptr<double>();
+		cp[0] = ap[0];
+		for (int d = 1; d < n; d++)
+			cp[d] = ap[d] + ap[dftSize - n + d];
+
+		double minVal;
+		cv::minMaxLoc(cacf, &minVal);
+
+		//range of the 2D auto correlation
+		double range = cv::norm(patch, cv::NORM_L2SQR) - minVal / patch.cols;
+
+		if (range > 0)
+			cacf.convertTo(vPP, CV_32F, 1.0 / range, -minVal / range);
+
+		return vPP;
+	}
+
+	/// <summary>
+	/// Finds the DFT coefficient with maximal magnitude of the vertical projection profile.
+	/// The constant component and coefficients with index > 100 are ignored.
+	/// </summary>
+	/// <param name="vPP">The vertical projection profile.</param>
+	/// <param name="maxVal">The maximal magnitude.</param>
+	/// <param name="maxLoc">The coefficient index (maxLoc.y).</param>
+	void TextHeightEstimation::spectrumPeak(const cv::Mat& vPP, double& maxVal, cv::Point& maxLoc) {
 
-		cv::Mat dftInput, dftResult, autoCorr, normAutoCorr;
-		patchImg.convertTo(dftInput, CV_32F);
+		cv::Mat vPPdft, mag;
 
-		//compute auto correlation
-		dft(dftInput, dftResult, cv::DFT_COMPLEX_OUTPUT);
-		cv::mulSpectrums(dftResult, dftResult, autoCorr, 0, true);
-		dft(autoCorr, autoCorr, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+		//compute DFT of PP and magnitudes of the DFT coefficients
+		cv::dft(vPP, vPPdft, cv::DFT_COMPLEX_OUTPUT);
 
-		//normalize result		
-		normalize(autoCorr, normAutoCorr, 0, 1, CV_MINMAX);
+		std::vector<cv::Mat> planes;
+		split(vPPdft, planes);
+		magnitude(planes[0], planes[1], mag);
 
-		//shift result image (since zero frequency comp was not centered)
-		fftShift(normAutoCorr);
+		//find index of coefficient with max magnitude
+		mag.at<float>(0, 0) = 0;	//discard constant component (0 index coefficient)
+		mag = mag(cv::Range(0, std::max(std::min(mag.rows / 2, 100), 1)), cv::Range(0, 1));	//ignore coefficients with index > 100 (assumption -> max 100 lines per page)
 
-		return normAutoCorr;
+		cv::minMaxLoc(mag, NULL, &maxVal, NULL, &maxLoc);
 	}
 
 	cv::Mat TextHeightEstimation::computePMF(int tMax, double w, double m, double sig) {
@@ -467,74 +505,6 @@ namespace rdf {
 		return pmf;
 	}
 
-	//shifting zero frequency components to center of image, using code from opencv phase correlation function
-	//https://github.com/opencv/opencv/blob/2da96be217ab437de854aca7f7670c2048fb554b/modules/imgproc/src/phasecorr.cpp
-	void TextHeightEstimation::fftShift(cv::Mat out){
-
-		if (out.rows == 1 && out.cols == 1)
-			return;
-
-		std::vector<cv::Mat> planes;
-		split(out, planes);
-
-		int xMid = out.cols >> 1;
-		int yMid = out.rows >> 1;
-
-		bool is_1d = xMid == 0 || yMid == 0;
-
-		if (is_1d){
-			int is_odd = (xMid > 0 && out.cols % 2 == 1) || (yMid > 0 && out.rows % 2 == 1);
-			xMid = xMid + yMid;
-
-			for (size_t i = 0; i < planes.size(); i++){
-				cv::Mat tmp;
-				cv::Mat half0(planes[i], cv::Rect(0, 0, xMid + is_odd, 1));
-				cv::Mat half1(planes[i], cv::Rect(xMid + is_odd, 0, xMid, 1));
-
-				half0.copyTo(tmp);
-				half1.copyTo(planes[i](cv::Rect(0, 0, xMid, 1)));
-				tmp.copyTo(planes[i](cv::Rect(xMid, 0, xMid + is_odd, 1)));
-			}
-		}
-		else{
-			int isXodd = out.cols % 2 == 1;
-			int isYodd = out.rows % 2 == 1;
-			for (size_t i = 0; i < planes.size(); i++){
-				// perform quadrant swaps...
-				cv::Mat q0(planes[i], cv::Rect(0, 0, xMid + isXodd, yMid + isYodd));
-				cv::Mat q1(planes[i], cv::Rect(xMid + isXodd, 0, xMid, yMid + isYodd));
-				cv::Mat q2(planes[i], cv::Rect(0, yMid + isYodd, xMid + isXodd, yMid));
-				cv::Mat q3(planes[i], cv::Rect(xMid + isXodd, yMid + isYodd, xMid, yMid));
-
-				if (!(isXodd || isYodd)){
-					cv::Mat tmp;
-					q0.copyTo(tmp);
-					q3.copyTo(q0);
-					tmp.copyTo(q3);
-
-					q1.copyTo(tmp);
-					q2.copyTo(q1);
-					tmp.copyTo(q2);
-				}
-				else{
-					cv::Mat tmp0, tmp1, tmp2, tmp3;
-					q0.copyTo(tmp0);
-					q1.copyTo(tmp1);
-					q2.copyTo(tmp2);
-					q3.copyTo(tmp3);
-
-					tmp0.copyTo(planes[i](cv::Rect(xMid, yMid, xMid + isXodd, yMid + isYodd)));
-					tmp3.copyTo(planes[i](cv::Rect(0, 0, xMid, yMid)));
-
-					tmp1.copyTo(planes[i](cv::Rect(0, yMid, xMid, yMid + isYodd)));
-					tmp2.copyTo(planes[i](cv::Rect(xMid, 0, xMid + isXodd, yMid)));
-				}
-			}
-		}
-
-		merge(planes, out);
-	}
-
 	void TextHeightEstimation::computeConfidence(cv::Mat accPMF){
 
 		//compute standard deviation of accumulated PMF -> giving approximate confidence of THE results
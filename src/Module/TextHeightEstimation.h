@@ -71,7 +71,7 @@ namespace rdf {
 
 	protected:
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		bool mDebugDraw = false;
@@ -92,6 +92,9 @@ namespace rdf {
 		double confidence();
 		QSharedPointer<TextHeightEstimationConfig> config() const;
 
+		static cv::Mat verticalProfileAcf(const cv::Mat& patch);
+		static void spectrumPeak(const cv::Mat& vPP, double& maxVal, cv::Point& maxLoc);
+
 		cv::Mat draw(const cv::Mat& img, const QColor& col = QColor()) const;
 		void drawDebugImages(QString input_path) const;
 		QString toString() const override;
@@ -107,9 +110,7 @@ namespace rdf {
 		QVector<cv::Range> splitRange(const cv::Range range) const;
 		cv::Mat processImagePatches(cv::Mat img);
 		cv::Mat processImagePatchesDebug(cv::Mat img);
-		cv::Mat nacf(const cv::Mat img);
 		cv::Mat computePMF(int tMax, double w, double m, double sig);
-		void fftShift(cv::Mat _out);
 		void computeConfidence(cv::Mat accPMF);
 
 		// input
@@ -38,6 +38,7 @@
 #include "Algorithms.h"
 #include "ImageProcessor.h"
 #include "ScaleFactory.h"
+#include "Profiler.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
@@ -92,7 +93,7 @@ QString TextLineConfig::debugPath() const {
 	return mDebugPath;
 }
 
-void TextLineConfig::load(const QSettings & settings) {
+void TextLineConfig::load(const ConfigSnapshot & settings) {
 
 	mMinLineLength = settings.value("minLineLength", mMinLineLength).toInt();
 	mMinPointDist = settings.value("minPointDistance", mMinPointDist).toDouble();
@@ -128,6 +129,8 @@ bool TextLineSegmentation::compute() {
 
 bool TextLineSegmentation::compute(const cv::Mat& img) {
 
+	rdfProfileScope("TextLineSegmentation");
+
 	//Timer dt;
 
 	if (!checkInput())
@@ -590,7 +593,7 @@ double SimpleTextLineConfig::maxEdgeTrhesh() const {
 	return mMaxEdgeThresh*mScaleFactory->scaleFactorDpi();
 }
 
-void SimpleTextLineConfig::load(const QSettings & settings) {
+void SimpleTextLineConfig::load(const ConfigSnapshot & settings) {
 	
 	mMaxEdgeThresh = settings.value("maxEdgeThresh", maxEdgeTrhesh()).toDouble();
 }
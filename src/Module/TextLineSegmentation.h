@@ -70,7 +70,7 @@ protected:
 	double mMaxEdgeThresh = 20;			// maximum edge in px
 	QSharedPointer<ScaleFactory> mScaleFactory;
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
@@ -131,7 +131,7 @@ protected:
 	double mErrorMultiplier = 1.4;		// maximal increase of error when merging two lines
 	QString mDebugPath = "C:/temp/cluster/";	// TODO: remove
 
-	void load(const QSettings& settings) override;
+	void load(const ConfigSnapshot& settings) override;
 	void save(QSettings& settings) const override;
 };
 
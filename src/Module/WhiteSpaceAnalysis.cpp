@@ -45,6 +45,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <map>
+#include <queue>
+#include <functional>
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QSettings>
@@ -130,7 +133,7 @@ namespace rdf {
 		return mDebugPath;
 	}
 	
-	void WhiteSpaceAnalysisConfig::load(const QSettings & settings) {
+	void WhiteSpaceAnalysisConfig::load(const ConfigSnapshot & settings) {
 
 		mNumErosionLayers		= settings.value("numErosionLayers", numErosionLayers()).toInt();
 		mMaxImgSide				= settings.value("maxImgSide", maxImgSide()).toInt();
@@ -188,6 +191,8 @@ bool WhiteSpaceAnalysis::compute() {
 	//TODO minor improvements:	merge horizontally aligned line fragments that are isolated or at top/bottom of text block
 	//							try to simplify/smooth polygon regions of TBs
 
+	rdfProfileModule();
+
 	qInfo()<< "Computing white space layout analysis...";
 	Timer dt;
 
@@ -1232,7 +1237,7 @@ QString TextLineHypothesizerConfig::debugPath() const {
 	return mDebugPath;
 }
 
-void TextLineHypothesizerConfig::load(const QSettings & settings) {
+void TextLineHypothesizerConfig::load(const ConfigSnapshot & settings) {
 	mMinLineLength = settings.value("minLineLength", minLineLength()).toInt();
 	mErrorMultiplier = settings.value("errorMultiplier", errorMultiplier()).toDouble();
 	mDebugPath = settings.value("debugPath", debugPath()).toString();
@@ -1259,6 +1264,8 @@ bool TextLineHypothesizer::compute() {
 	if (mSet.isEmpty())
 		return false;
 
+	rdfProfileModule();
+
 	RightNNConnector rnnpc;
 	rnnpc.setStopLines(mStopLines);
 
@@ -1506,78 +1513,25 @@ void TextLineHypothesizer::extractWhiteSpaces(QSharedPointer<WSTextLineSet>& tex
 		textRects << p->bbox();
 	}
 
-	QVector<Rect> mergedRects;
-	QVector<int> processedIdx;
-	
-	//merge text region rects that are overlapping (needed for white space extraction)
-	for (int i = 0; i < textRects.size(); ++i) {
-		if (processedIdx.contains(i))
-			continue;
-
-		Rect tr1 = textRects[i];
-		bool merged = false;
-
-		if (!mergedRects.isEmpty()) {
-			for (int j = 0; j < mergedRects.size(); ++j) {
-				Rect tr2 = mergedRects[j];
-
-				if (tr1.left() <= tr2.right() && tr2.left() <= tr1.right()) {
-					processedIdx << i;
-					mergedRects[j] = tr1.joined(tr2);
-					merged = true;
-					break;
-				}
-			}
-		}
-
-		if (!merged) {
-			for (int j = 0; j < textRects.size(); ++j) {
-
-				if (i == j || processedIdx.contains(j))
-					continue;
-
-				Rect tr2 = textRects[j];
-
-				if (tr1.left() <= tr2.right() && tr2.left() <= tr1.right()) {
-					processedIdx << i;
-					processedIdx << j;
-
-					mergedRects << tr1.joined(tr2);
-					merged = true; 
-					break;
-				}
-			}
-		}
-
-		if (!merged) {
-			processedIdx << i;
-			mergedRects << textRects[i];
-		}
-	}
-
 	//sort text rects according to their x coordinates
-	std::sort(mergedRects.begin(), mergedRects.end(), [](const auto& lhs, const auto& rhs) {
+	std::sort(textRects.begin(), textRects.end(), [](const auto& lhs, const auto& rhs) {
 		return lhs.left() < rhs.left();
 	});
-	
-	//remove overlapping rects
-	for (int i = 0; i < mergedRects.size(); ++i) {
-		Rect m1 = mergedRects[i];
-		for (int j = 0; j < mergedRects.size(); ++j) {
-			Rect m2 = mergedRects[j];
-			if (i != j) {
-				if (m2.left() <= m1.right() && m1.left() <= m2.right()) {
-					mergedRects[i] = m1.joined(m2);
-					mergedRects.remove(j);
-				}
-			}
-		}
+
+	//merge text region rects that are overlapping in x direction (needed for white space extraction)
+	//since the rects are sorted, a rect can only overlap with the last merged rect
+	QVector<Rect> mergedRects;
+	mergedRects.reserve(textRects.size());
+
+	for (const Rect& r : textRects) {
+
+		if (!mergedRects.isEmpty() && r.left() <= mergedRects.last().right())
+			mergedRects.last() = mergedRects.last().joined(r);
+		else
+			mergedRects << r;
 	}
 
-	//sort text rects according to their x coordinates
-	std::sort(mergedRects.begin(), mergedRects.end(), [](const auto& lhs, const auto& rhs) {
-		return lhs.right() < rhs.right();
-	});
+	//NOTE: the merged rects do not overlap - so they are sorted w.r.t. left & right coordinates
 
 	////debug draw------------------------------------------
 	//QImage qImg = Image::mat2QImage(mImg, true);
@@ -2370,7 +2324,7 @@ bool WhiteSpaceSegmentationConfig::findWhiteSpaceGaps() const{
 	return mFindWhiteSpaceGaps;
 }
 
-void WhiteSpaceSegmentationConfig::load(const QSettings & settings) {
+void WhiteSpaceSegmentationConfig::load(const ConfigSnapshot & settings) {
 	mSlicingSizeMultiplier = settings.value("minLengthMultiplier", minLengthMultiplier()).toDouble();
 	mMinLengthMultiplier = settings.value("slicingSizeMultiplier", slicingSizeMultiplier()).toDouble();
 	mFindWhiteSpaceGaps = settings.value("findWhiteSpaceGaps", findWhiteSpaceGaps()).toBool();
@@ -2400,6 +2354,8 @@ bool WhiteSpaceSegmentation::isEmpty() const {
 
 bool WhiteSpaceSegmentation::compute() {
 
+	rdfProfileModule();
+
 	//TODO consider incorporating white separators at the beginning of the segmentation process
 
 	if (mInitialTls.isEmpty()) {
@@ -3543,7 +3499,7 @@ int TextBlockFormationConfig::polygonType() const{
 	return ModuleConfig::checkParam(mPolygonType, 0, INT_MAX, "polygonType");
 }
 
-void TextBlockFormationConfig::load(const QSettings & settings){
+void TextBlockFormationConfig::load(const ConfigSnapshot & settings){
 	mPolygonType = settings.value("polygonType", polygonType()).toInt();
 }
 
@@ -3578,6 +3534,8 @@ bool TextBlockFormation::compute() {
 	if (mTextLines.isEmpty())
 		return false;
 
+	rdfProfileModule();
+
 	//sort text lines according to y_max coordinate for more efficient computation
 	std::sort(mTextLines.begin(), mTextLines.end(), [](const auto& lhs, const auto& rhs) {
 		return lhs->boundingBox().top() < rhs->boundingBox().top();
@@ -4253,6 +4211,14 @@ TextBlockSet TextBlockFormation::textBlockSet() {
 RightNNConnector::RightNNConnector() : PixelConnector() {
 }
 
+/// <summary>
+/// Connects each pixel with (up to 3) nearest pixels to its right which overlap vertically.
+/// A sweep line (from top to bottom) keeps the active set of pixels that overlap with the
+/// current line. The active set is indexed by the pixels' left and right coordinates so that
+/// horizontal neighbors are found with range queries. Hence, the candidates are found in O(N log N).
+/// </summary>
+/// <param name="pixels">The pixels.</param>
+/// <returns>The edges from each pixel to its right neighbors.</returns>
 QVector<QSharedPointer<PixelEdge>> RightNNConnector::connect(const QVector<QSharedPointer<Pixel>>& pixels) const{
 
 	//TODO check parameter choice
@@ -4280,74 +4246,118 @@ QVector<QSharedPointer<PixelEdge>> RightNNConnector::connect(const QVector<QShar
 	}
 
 	double medianTextHeight = Algorithms::statMoment(spacings, 0.5);
+	double maxDist = medianTextHeight*distMultiplier;
 
-	//TODO speed up this process by doing undirected linking and computing a RNN look up table
-	for (const QSharedPointer<Pixel>& p1 : mPixels) {
+	// cache the bounding boxes & centers
+	QVector<Rect> boxes;
+	QVector<double> centers;
+	boxes.reserve(mPixels.size());
+	centers.reserve(mPixels.size());
+	for (const QSharedPointer<Pixel>& p : mPixels) {
+		boxes << p->bbox();
+		centers << p->center().x();
+	}
 
-		QVector<QSharedPointer<Pixel>> rnn;
+	typedef std::multimap<double, int> ActiveIndex;
+	ActiveIndex activeLeft;		// active pixels w.r.t. their left coordinate
+	ActiveIndex activeRight;	// active pixels w.r.t. their right coordinate
+	std::vector<ActiveIndex::iterator> leftIt(mPixels.size());
+	std::vector<ActiveIndex::iterator> rightIt(mPixels.size());
 
-		for (const QSharedPointer<Pixel>& p2 : mPixels) {
+	// active pixels w.r.t. their bottom (smallest first)
+	typedef std::pair<double, int> BottomEntry;
+	std::priority_queue<BottomEntry, std::vector<BottomEntry>, std::greater<BottomEntry> > activeBottom;
 
-			if (p1->id() == p2->id())
-				continue;
+	// candidates of right nearest neighbors
+	QVector<QVector<int> > rnnIdx(mPixels.size());
 
-			Rect p1R = p1->bbox();
-			Rect p2R = p2->bbox();
+	auto isDuplicate = [&](int i1, int i2) {
+		return mPixels[i1]->id() == mPixels[i2]->id();
+	};
 
-			if (p1R.top() > p2R.bottom())
-				continue;
+	for (int idx = 0; idx < mPixels.size(); idx++) {
 
-			if (p2R.top() > p1R.bottom())
-				break;
+		const Rect& r = boxes[idx];
 
-			if (p2R.right() > p1R.right() && p2R.left() > p1R.left()) {
+		// remove pixels that end above the sweep line
+		while (!activeBottom.empty() && activeBottom.top().first < r.top()) {
+			
+			int rIdx = activeBottom.top().second;
+			activeBottom.pop();
 
-				//filter pixels according to the x-distance between them
-				double xDist = p2R.left() - p1R.right();
-				
-				if(xDist < medianTextHeight*distMultiplier){
-					rnn << p2;
-				}
+			activeLeft.erase(leftIt[rIdx]);
+			activeRight.erase(rightIt[rIdx]);
+		}
+
+		// all active pixels overlap vertically with the current pixel 
+		// active pixels to the right of the current pixel: left in (r.left, r.right + maxDist)
+		if (r.right() + maxDist > r.left()) {
+
+			auto lEnd = activeLeft.lower_bound(r.right() + maxDist);
+			for (auto it = activeLeft.upper_bound(r.left()); it != lEnd; ++it) {
+
+				int aIdx = it->second;
+				if (boxes[aIdx].right() > r.right() && !isDuplicate(idx, aIdx))
+					rnnIdx[idx] << aIdx;
 			}
 		}
-		
+
+		// active pixels to the left of the current pixel: right in (r.left - maxDist, r.right)
+		if (r.left() - maxDist < r.right()) {
+
+			auto rEnd = activeRight.lower_bound(r.right());
+			for (auto it = activeRight.upper_bound(r.left() - maxDist); it != rEnd; ++it) {
+
+				int aIdx = it->second;
+				if (boxes[aIdx].left() < r.left() && !isDuplicate(idx, aIdx))
+					rnnIdx[aIdx] << idx;
+			}
+		}
+
+		// add the current pixel to the active set
+		leftIt[idx] = activeLeft.insert(std::make_pair(r.left(), idx));
+		rightIt[idx] = activeRight.insert(std::make_pair(r.right(), idx));
+		activeBottom.push(std::make_pair(r.bottom(), idx));
+	}
+
+	for (int pIdx = 0; pIdx < mPixels.size(); pIdx++) {
+
+		QVector<int>& rnn = rnnIdx[pIdx];
+
 		//sort neighboring pixels from left to right (according to center)
-		std::sort(rnn.begin(), rnn.end(), [](const auto& lhs, const auto& rhs) {
-			return lhs->center().x() < rhs->center().x();
-			//return lhs->bbox().left() < rhs->bbox().left();
-			//return lhs->bbox().right() < rhs->bbox().right();
+		std::sort(rnn.begin(), rnn.end(), [&](int lhs, int rhs) {
+			return centers[lhs] < centers[rhs];
 		});
 
+		const Rect& p1R = boxes[pIdx];
+
 		//add edges after filtering according to parameters
-		int maxIdx = std::min(rnn.size(), maxRnnCount);
-		int newEdgeCount = edges.size()+ maxIdx;
-		for (int idx = 0; idx < rnn.size(); idx++) {
+		int numEdges = 0;
+		for (int idx : rnn) {
 
-			if (edges.size() == newEdgeCount)
+			if (numEdges == maxRnnCount)
 				break;
 
 			if (filterEdges) {
 
 				//filter pixel according to x/y overlap
-				Rect p1R = p1->bbox();
-				Rect p2R = rnn.at(idx)->bbox();
+				const Rect& p2R = boxes[idx];
 
 				double heightRatio = std::max(p1R.height(), p2R.height())  / std::min(p1R.height(), p2R.height());
 
-				if(heightRatio < maxHeightRatio){
+				if (heightRatio >= maxHeightRatio)
+					continue;
 
-					//check if relative y-overlap is bigger than 1/3 of bigger component
-					double yOverlap = std::min(p1R.bottom(), p2R.bottom()) - std::max(p1R.top(), p2R.top());
-					double relYoverlap = yOverlap / std::max(p1R.height(), p2R.height());
+				//check if relative y-overlap is bigger than 1/3 of bigger component
+				double yOverlap = std::min(p1R.bottom(), p2R.bottom()) - std::max(p1R.top(), p2R.top());
+				double relYoverlap = yOverlap / std::max(p1R.height(), p2R.height());
 
-					if (yOverlap > 0 && relYoverlap > (minVertOverlapRatio)) {
-						edges << QSharedPointer<PixelEdge>::create(p1, rnn.at(idx));	//add edge for remaining pair
-					}
-				}
-			}
-			else {
-				edges << QSharedPointer<PixelEdge>::create(p1, rnn.at(idx));
+				if (yOverlap <= 0 || relYoverlap <= minVertOverlapRatio)
+					continue;
 			}
+
+			edges << QSharedPointer<PixelEdge>::create(mPixels[pIdx], mPixels[idx]);	//add edge for remaining pair
+			numEdges++;
 		}
 	}
 
@@ -95,7 +95,7 @@ namespace rdf {
 
 	protected:
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		int mPolygonType = 0;
@@ -215,7 +215,7 @@ namespace rdf {
 		int mMinLineLength = 3;				// minimum text line length when clustering
 		double mErrorMultiplier = 1.2;		// maximal increase of error when merging two lines
 		QString mDebugPath = "E:/data/test/HBR2013_training";
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 	};
 
@@ -281,7 +281,7 @@ namespace rdf {
 
 		bool mFindWhiteSpaceGaps = true;
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 	};
 
@@ -368,7 +368,7 @@ namespace rdf {
 
 	protected:
 
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 		//MSER & super pixel parameters
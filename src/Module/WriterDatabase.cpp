@@ -34,15 +34,19 @@
 #include "WriterRetrieval.h"
 #include "Image.h"
 #include "Utils.h"
+#include "ModelRegistry.h"
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <limits>
 
 #pragma warning(push, 0)	// no warnings from includes
 // Qt Includes
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QDataStream>
 #include <opencv2/ml.hpp>
 #include <opencv2/features2d.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
@@ -235,50 +239,25 @@ namespace rdf {
 
 		
 		cv::Mat avgPrec(0, 0, CV_32F);
-		cv::Mat dist = mVocabulary.calcualteDistanceMatrix(hists);
+
+		// distances are computed per query, so memory is linear in the number of pages
+		WriterIndex index(WriterIndex::metricOf(mVocabulary.type()));
+		index.add(hists, classLabels);
+
 		for(int i = 0; i < hists.rows; i++) {
-			cv::Mat distances = dist.row(i).t();
-			//cv::Mat distances(hists.rows, 1, CV_32FC1);
-			//distances.setTo(0);
-
-			//for(int j = 0; j < hists.length(); j++) {
-			//	if(mVocabulary.type() == WriterVocabulary::WI_GMM) {
-			//		distances.at<float>(j) = (float)(1 - hists[i].dot(hists[j]) / (cv::norm(hists[i])*cv::norm(hists[j]) + DBL_EPSILON)); // 1-dist ... 0 is equal 2 is orthogonal
-			//	} else if(mVocabulary.type() == WriterVocabulary::WI_BOW) {
-			//		cv::Mat tmp;
-			//		pow(hists[i] - hists[j], 2, tmp);
-			//		cv::Scalar scal = cv::sum(tmp);
-			//		distances.at<float>(j) = (float)sqrt(scal[0]);
-			//	}
-			//}
-			cv::Mat idxs;
-			//writeMatToFile(distances, "c:\\tmp\\distances-unsorted.txt");
-			cv::sortIdx(distances, idxs, CV_SORT_EVERY_COLUMN| CV_SORT_ASCENDING);
-			cv::sort(distances, distances, CV_SORT_EVERY_COLUMN | CV_SORT_ASCENDING);
-
-			//writeMatToFile(distances, "c:\\tmp\\distances.txt");
-			//writeMatToFile(idxs, "c:\\tmp\\distances-idxs.txt");
-			//QFile file("c:\\tmp\\distances-idxs.txt");
-			//file.open(QIODevice::ReadWrite);
-			//QTextStream stream(&file);
-			//QString out;
-			//for(int i = 0; i < idxs.rows; i++) {
-			//	out += QString::number(idxs.at<int>(i)) + "\n";
-			//}
-			//stream << out;
-			//file.close();
-
-			//QFile file2(filePaths[i].append("-hist.txt"));
-			//file2.open(QIODevice::ReadWrite | QIODevice::Truncate);
-			//QTextStream stream2(&file2);
-			//QString out2;
-			//for(int j = 0; j < hists[i].cols; j++) {
-			//	out2 += QString::number(hists[i].at<float>(j));
-			//	out2 += " ";
-			//}
-			//stream2 << out2 << "\n";
-			//file2.close();
+			cv::Mat distances = index.distances(hists.row(i));
+			const float* dp = distances.ptr<float>();
+
+			// the eval file needs the full ranking - otherwise the top 12 are sufficient
+			QVector<int> idxs(distances.rows);
+			for(int j = 0; j < idxs.size(); j++)
+				idxs[j] = j;
 
+			int numRanks = evalFilePath.isEmpty() ? qMin(12, idxs.size()) : idxs.size();
+			std::partial_sort(idxs.begin(), idxs.begin() + numRanks, idxs.end(), [&](int a, int b) {
+				return dp[a] < dp[b] || (dp[a] == dp[b] && a < b);
+			});
+			idxs.resize(numRanks);
 
 			if(!evalFilePath.isEmpty()) {
 				QFile file(evalFilePath);
@@ -287,25 +266,24 @@ namespace rdf {
 					QFileInfo fi = QFileInfo(filePaths[i]);
 					// eval file: file path , real label
 					stream << "'" << fi.baseName() << "',' " << fi.absoluteFilePath() << "', " << classLabels[i] << ",";
-					for(int k = 0; k < idxs.rows; k++) {
+					for(int k = 0; k < idxs.size(); k++) {
 						// eval file: real writer id, distance, number of page
-						QString out = classLabels[idxs.at<int>(k)] + "," + QString::number(distances.at<float>(k)) + "," + QString::number(idxs.at<int>(k)) + ",";
+						QString out = classLabels[idxs[k]] + "," + QString::number(dp[idxs[k]]) + "," + QString::number(idxs[k]) + ",";
 						stream << out;
 					}
 					stream << "\n";
 				}
 				file.close();
 			}
-			//qDebug() << "classLabels[i].toInt():" << classLabels[i].toInt() << " idxs.at<int>(1):" << idxs.at<int>(1) << " classLabels[idxs.at<int>(1)]:" << classLabels[idxs.at<int>(1)];
-			if(classLabels[i] == classLabels[idxs.at<int>(1)])
+			if(classLabels[i] == classLabels[idxs[1]])
 				tp++;
 			else
 				fp++;
-			if(idxs.rows > 11) {
+			if(idxs.size() > 11) {
 				bool allCorrect = true;
 				bool oneCorrect = false;
 				for(int j = 1; j <= 11; j++) { // 1 because idx 0 is the original file
-					if(classLabels[i] == classLabels[idxs.at<int>(j)]) 
+					if(classLabels[i] == classLabels[idxs[j]]) 
 						oneCorrect = true;
 					else
 						allCorrect = false;
@@ -318,12 +296,28 @@ namespace rdf {
 			}
 
 			// calculating mean average precession
+			// the rank of a page of the same writer is 1 + the number of other pages which are closer
+			std::vector<float> writerDists;
+			for(int j = 0; j < distances.rows; j++) {
+				if(j != i && classLabels[i] == classLabels[j])
+					writerDists.push_back(dp[j]);
+			}
+			std::sort(writerDists.begin(), writerDists.end());
+
+			std::vector<int> closer(writerDists.size() + 1, 0);
+			for(int j = 0; j < distances.rows; j++) {
+				if(j != i)
+					closer[std::upper_bound(writerDists.begin(), writerDists.end(), dp[j]) - writerDists.begin()]++;
+			}
+
 			float sum = 0;
 			int pageOfWriter = 0;
-			for(int j = 1; j < idxs.rows; j++) { // 1 because idx 0 is the original file
-				if(classLabels[i] == classLabels[idxs.at<int>(j)]) {
-					sum += (float)++pageOfWriter / j; // ++ before so that the first page is one
-				}
+			int numCloser = 0;
+			int rank = 0;
+			for(int j = 0; j < (int)writerDists.size(); j++) {
+				numCloser += closer[j];
+				rank = qMax(numCloser + 1, rank + 1);	// pages with equal distances get consecutive ranks
+				sum += (float)++pageOfWriter / rank; // ++ before so that the first page is one
 			}
 			avgPrec.push_back(sum / pageOfWriter);
 		}
@@ -383,13 +377,14 @@ namespace rdf {
 		writeCompetitionEvaluationFile(hists, imageNames, outputPath);
 	}
 	void WriterDatabase::writeCompetitionEvaluationFile(cv::Mat hists, QStringList imageNames, QString outputPath) const {
-		cv::Mat dist = mVocabulary.calcualteDistanceMatrix(hists);
+		WriterIndex index(WriterIndex::metricOf(mVocabulary.type()));
+		index.add(hists, imageNames);
+
 		QString outputString;
 		for(int i = 0; i < hists.rows; i++) {
-			cv::Mat distances = dist.row(i).t();
+			cv::Mat distances = index.distances(hists.row(i));
 			cv::Mat idxs;
 			cv::sortIdx(distances, idxs, CV_SORT_EVERY_COLUMN | CV_SORT_ASCENDING);
-			cv::sort(distances, distances, CV_SORT_EVERY_COLUMN | CV_SORT_ASCENDING);
 
 			for(int j = 0; j < idxs.rows; j++) {
 				if(j != 0)
@@ -586,8 +581,11 @@ namespace rdf {
 		std::string note;
 		fs["note"] >> note;
 		mNote = QString::fromStdString(note);
-		if(mType == WI_BOW)
-			fs["Vocabulary"] >> mVocabulary;
+		if(mType == WI_BOW) {
+			cv::Mat voc;
+			fs["Vocabulary"] >> voc;
+			setVocabulary(voc);
+		}
 		else {
 			std::string gmmPath;
 			fs["GmmPath"] >> gmmPath;
@@ -600,6 +598,7 @@ namespace rdf {
 #else
 				mEM = cv::ml::EM::load<cv::ml::EM>(gmmPath);
 #endif
+				mEncoder = QSharedPointer<FisherVectorEncoder>::create(mEM);
 			}
 			else
 				mWarning << "gmm file " << QString::fromStdString(gmmPath) << " (stored in the vocabulary) not found!";
@@ -612,6 +611,22 @@ namespace rdf {
 		mVocabularyPath = filePath;
 	}
 	/// <summary>
+	/// Returns the vocabulary stored at filePath.
+	/// The vocabulary (and its GMM) is loaded once and shared
+	/// by all callers (see ModelRegistry).
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <returns>the shared vocabulary or NULL if it could not be loaded</returns>
+	QSharedPointer<const WriterVocabulary> WriterVocabulary::loadCachedVocabulary(const QString filePath) {
+		auto load = [](const QString& fp) {
+			QSharedPointer<WriterVocabulary> voc(new WriterVocabulary());
+			voc->loadVocabulary(fp);
+			return voc->isEmpty() ? QSharedPointer<WriterVocabulary>() : voc;
+		};
+
+		return ModelRegistry::instance().model<WriterVocabulary>(filePath, load);
+	}
+	/// <summary>
 	/// Saves the vocabulary to the given file path.
 	/// updates the mVocabularyPath, thus this method is not const
 	/// </summary>
@@ -664,22 +679,13 @@ namespace rdf {
 	/// <param name="hists">a matrix with the feature vectors of different images stored in the rows</param>
 	/// <returns>a RxR matrix of the distances between the feature vectors in the rows of the input matrix.</returns>
 	cv::Mat WriterVocabulary::calcualteDistanceMatrix(cv::Mat hists) const {
+		WriterIndex index(WriterIndex::metricOf(type()));
+		index.add(hists);
+
 		cv::Mat distances = cv::Mat(hists.rows, hists.rows, CV_32F);
-		distances.setTo(0);
 		for(int i = 0; i < hists.rows; i++) {
-			for(int j = i; j < hists.rows; j++) {
-				if(mVocabulary.type() == WriterVocabulary::WI_GMM) {
-					distances.at<float>(i, j) = (float)(1 - hists.row(i).dot(hists.row(j)) / (cv::norm(hists.row(i))*cv::norm(hists.row(j)) + DBL_EPSILON)); // 1-dist ... 0 is equal 2 is orthogonal
-					distances.at<float>(j, i) = distances.at<float>(i, j);
-				}
-				else if(mVocabulary.type() == WriterVocabulary::WI_BOW) {
-					cv::Mat tmp;
-					pow(hists.row(i) - hists.row(j), 2, tmp);
-					cv::Scalar scal = cv::sum(tmp);
-					distances.at<float>(i,j) = (float)sqrt(scal[0]);
-					distances.at<float>(j, i) = distances.at<float>(i, j);
-				}
-			}
+			cv::Mat d = index.distances(hists.row(i)).t();
+			d.copyTo(distances.row(i));
 		}
 		return distances;
 	}
@@ -704,6 +710,8 @@ namespace rdf {
 	/// <param name="voc">The voc.</param>
 	void WriterVocabulary::setVocabulary(cv::Mat voc) {
 		mVocabulary = voc;
+		mVocabularyIndex = QSharedPointer<WriterIndex>::create(WriterIndex::WI_EUCLIDEAN);
+		mVocabularyIndex->add(mVocabulary);
 	}
 	/// <summary>
 	/// BOW vocabulary of this instance
@@ -718,6 +726,7 @@ namespace rdf {
 	/// <param name="em">The em.</param>
 	void WriterVocabulary::setEM(cv::Ptr<cv::ml::EM> em) {
 		mEM = em;
+		mEncoder = QSharedPointer<FisherVectorEncoder>::create(mEM);
 	}
 	/// <summary>
 	/// the EM of this instance.
@@ -1030,22 +1039,14 @@ namespace rdf {
 		if(numberOfPCA() > 0) {
 			d = applyPCA(d);
 		}
-		cv::Mat dists, idx;
-
-		cv::flann::Index flann_index(mVocabulary, cv::flann::LinearIndexParams());
+		// the cluster centers are indexed once per vocabulary
+		QVector<int> idx = mVocabularyIndex ? mVocabularyIndex->nearest(d) : QVector<int>();
 		cv::Mat hist = cv::Mat(1, (int)mVocabulary.rows, CV_32FC1);
 		hist.setTo(0);
 
-		flann_index.knnSearch(d, idx, dists, 1, cv::flann::SearchParams(64));
-
 		float *ptrHist = hist.ptr<float>(0);
-		int *ptrLabels = idx.ptr<int>(0);		//float?
-
-		for(int i = 0; i < idx.rows; i++) {
-
-			ptrHist[(int)*ptrLabels]++;
-			ptrLabels++;
-		}
+		for(int i : idx)
+			ptrHist[i]++;
 
 		hist /= (float)d.rows;
 
@@ -1075,32 +1076,44 @@ namespace rdf {
 		if(mNumberPCA > 0) {
 			d = applyPCA(d);
 		}
-		cv::Mat fisher(mNumberOfClusters, d.cols, CV_32F);
-		fisher.setTo(0);
+		cv::Mat fisher;
+		if(mEncoder && !mEncoder->isEmpty()) {
+			fisher = mEncoder->encode(d);
+		}
+		else {
+			// fallback for GMMs with generic covariance matrices
+			fisher = cv::Mat(mNumberOfClusters, d.cols, CV_32F);
+			fisher.setTo(0);
 
-		cv::Ptr<cv::ml::EM> em = mEM;
-		for(int i = 0; i < d.rows; i++) {
-			cv::Mat feature = d.row(i);
-			cv::Mat probs, means;
+			cv::Ptr<cv::ml::EM> em = mEM;
+			cv::Mat means = em->getMeans();
+			means.convertTo(means, CV_32F);
 			std::vector<cv::Mat> covs;
-
-			cv::Vec2d emOut = em->predict2(feature, probs);
-			probs.convertTo(probs, CV_32F);
 			em->getCovs(covs);
-			means = em->getMeans();
-			means.convertTo(means, CV_32F);
+
+			std::vector<cv::Mat> diags;
 			for(int j = 0; j < em->getClustersNumber(); j++) {
-				cv::Mat cov = covs[j];
-				cv::Mat diag = cov.diag(0).t();
+				cv::Mat diag = covs[j].diag(0).t();
 				diag.convertTo(diag, CV_32F);
-				fisher.row(j) += probs.at<float>(j) * ((feature - means.row(j)) / diag);
+				diags.push_back(diag);
+			}
+
+			for(int i = 0; i < d.rows; i++) {
+				cv::Mat feature = d.row(i);
+				cv::Mat probs;
+
+				em->predict2(feature, probs);
+				probs.convertTo(probs, CV_32F);
+				for(int j = 0; j < em->getClustersNumber(); j++) {
+					fisher.row(j) += probs.at<float>(j) * ((feature - means.row(j)) / diags[j]);
+				}
+			}
+			cv::Mat weights = em->getWeights();
+			weights.convertTo(weights, CV_32F);
+			for(int j = 0; j < em->getClustersNumber(); j++) {
+				//fisher.row(j) *= 1.0f / (d.rows* sqrt(weights.at<float>(j)) + DBL_EPSILON);
+				fisher.row(j) *= 1.0f / (sqrt(weights.at<float>(j)) + DBL_EPSILON);
 			}
-		}
-		cv::Mat weights = em->getWeights();
-		weights.convertTo(weights, CV_32F);
-		for(int j = 0; j < em->getClustersNumber(); j++) {
-			//fisher.row(j) *= 1.0f / (d.rows* sqrt(weights.at<float>(j)) + DBL_EPSILON);
-			fisher.row(j) *= 1.0f / (sqrt(weights.at<float>(j)) + DBL_EPSILON);
 		}
 		cv::Mat hist = fisher.reshape(0, 1);
 
@@ -1166,6 +1179,642 @@ namespace rdf {
 		return d;
 	}
 
+	// FisherVectorEncoder ----------------------------------------------------------------------------------
+	/// <summary>
+	/// Computes the posteriors and the sufficient statistics of a chunk of descriptors (see cv::parallel_for_).
+	/// Each chunk writes to its own statistics which are reduced afterwards.
+	/// </summary>
+	class FisherStatsBody : public cv::ParallelLoopBody {
+
+	public:
+		FisherStatsBody(const FisherVectorEncoder& encoder, const cv::Mat& desc, int chunkSize, bool secondOrder,
+			std::vector<cv::Mat>& s0, std::vector<cv::Mat>& s1, std::vector<cv::Mat>& s2) :
+			mEncoder(encoder), mDesc(desc), mChunkSize(chunkSize), mSecondOrder(secondOrder), mS0(s0), mS1(s1), mS2(s2) {}
+
+		void operator()(const cv::Range& r) const override {
+			for(int c = r.start; c < r.end; c++) {
+				int end = std::min((c + 1) * mChunkSize, mDesc.rows);
+				cv::Mat chunk = mDesc.rowRange(c * mChunkSize, end);
+				cv::Mat p = mEncoder.posteriors(chunk);
+
+				cv::reduce(p, mS0[c], 0, CV_REDUCE_SUM, CV_32F);
+				cv::gemm(p, chunk, 1.0, cv::noArray(), 0.0, mS1[c], cv::GEMM_1_T);
+				if(mSecondOrder)
+					cv::gemm(p, chunk.mul(chunk), 1.0, cv::noArray(), 0.0, mS2[c], cv::GEMM_1_T);
+			}
+		}
+
+	private:
+		const FisherVectorEncoder& mEncoder;
+		const cv::Mat& mDesc;
+		int mChunkSize;
+		bool mSecondOrder;
+		std::vector<cv::Mat>& mS0;
+		std::vector<cv::Mat>& mS1;
+		std::vector<cv::Mat>& mS2;
+	};
+
+	/// <summary>
+	/// Caches the parameters of the (diagonal) GMM.
+	/// The encoder is empty if em is not trained or if it has generic covariance matrices.
+	/// </summary>
+	/// <param name="em">The trained GMM.</param>
+	FisherVectorEncoder::FisherVectorEncoder(const cv::Ptr<cv::ml::EM> em) {
+		if(em.empty() || !em->isTrained() || em->getCovarianceMatrixType() == cv::ml::EM::COV_MAT_GENERIC)
+			return;
+
+		int k = em->getClustersNumber();
+		std::vector<cv::Mat> covs;
+		em->getCovs(covs);
+		em->getMeans().convertTo(mMeans, CV_32F);
+		em->getWeights().convertTo(mWeights, CV_32F);
+
+		int dims = mMeans.cols;
+		mInvVars = cv::Mat(k, dims, CV_32F);
+		mLogConst = cv::Mat(1, k, CV_32F);
+
+		for(int j = 0; j < k; j++) {
+			cv::Mat var = covs[j].diag(0).t();
+			var.convertTo(var, CV_32F);
+			cv::Mat iv = mInvVars.row(j);
+			cv::divide(1.0, cv::max(var, FLT_EPSILON), iv);
+
+			// log(w) - 0.5 * (D log(2pi) + sum(log(var)) + sum(mu^2/var))
+			cv::Mat logVar;
+			cv::log(cv::max(var, FLT_EPSILON), logVar);
+			cv::Mat mu2 = mMeans.row(j).mul(mMeans.row(j));
+			double muTerm = mu2.dot(iv);
+			mLogConst.at<float>(j) = (float)(std::log(mWeights.at<float>(j) + DBL_EPSILON) 
+				- 0.5 * (dims * std::log(2.0 * CV_PI) + cv::sum(logVar)[0] + muTerm));
+		}
+
+		mMeansInvVars = mMeans.mul(mInvVars);
+	}
+	/// <summary>
+	/// Returns true if no GMM parameters are cached.
+	/// </summary>
+	/// <returns></returns>
+	bool FisherVectorEncoder::isEmpty() const {
+		return mMeans.empty();
+	}
+	/// <summary>
+	/// The number of GMM components (K).
+	/// </summary>
+	/// <returns></returns>
+	int FisherVectorEncoder::numberOfClusters() const {
+		return mMeans.rows;
+	}
+	/// <summary>
+	/// The dimension of the descriptors (D).
+	/// </summary>
+	/// <returns></returns>
+	int FisherVectorEncoder::dimensions() const {
+		return mMeans.cols;
+	}
+	/// <summary>
+	/// Computes the posteriors of all descriptors.
+	/// </summary>
+	/// <param name="desc">The descriptors N x D (CV_32F).</param>
+	/// <returns>The posteriors N x K (CV_32F).</returns>
+	cv::Mat FisherVectorEncoder::posteriors(const cv::Mat& desc) const {
+		// log likelihood: -0.5 * x^2/var + x*mu/var + const
+		cv::Mat ll, xm;
+		cv::gemm(desc.mul(desc), mInvVars, -0.5, cv::repeat(mLogConst, desc.rows, 1), 1.0, ll, cv::GEMM_2_T);
+		cv::gemm(desc, mMeansInvVars, 1.0, cv::noArray(), 0.0, xm, cv::GEMM_2_T);
+		ll += xm;
+
+		// soft-max for each descriptor
+		for(int i = 0; i < ll.rows; i++) {
+			float* p = ll.ptr<float>(i);
+			float maxVal = *std::max_element(p, p + ll.cols);
+			float sum = 0;
+			for(int j = 0; j < ll.cols; j++) {
+				p[j] = std::exp(p[j] - maxVal);
+				sum += p[j];
+			}
+			for(int j = 0; j < ll.cols; j++)
+				p[j] /= sum;
+		}
+
+		return ll;
+	}
+	/// <summary>
+	/// Accumulates the zero (1 x K), first (K x D) and second order (K x D) statistics of all descriptors.
+	/// The descriptors are split into chunks which are processed in parallel.
+	/// </summary>
+	/// <param name="desc">The descriptors N x D.</param>
+	/// <param name="s0">The sum of posteriors.</param>
+	/// <param name="s1">The posterior weighted sum of descriptors.</param>
+	/// <param name="s2">The posterior weighted sum of squared descriptors (only if secondOrder is true).</param>
+	/// <param name="secondOrder">If true, s2 is computed.</param>
+	void FisherVectorEncoder::accumulate(const cv::Mat& desc, cv::Mat& s0, cv::Mat& s1, cv::Mat& s2, bool secondOrder) const {
+		int k = numberOfClusters();
+		s0 = cv::Mat(1, k, CV_32F, cv::Scalar(0));
+		s1 = cv::Mat(k, dimensions(), CV_32F, cv::Scalar(0));
+		s2 = secondOrder ? cv::Mat(k, dimensions(), CV_32F, cv::Scalar(0)) : cv::Mat();
+
+		if(desc.empty())
+			return;
+
+		cv::Mat d = desc;
+		if(d.type() != CV_32F)
+			desc.convertTo(d, CV_32F);
+
+		int chunkSize = 512;
+		int numChunks = (d.rows + chunkSize - 1) / chunkSize;
+		std::vector<cv::Mat> cs0(numChunks), cs1(numChunks), cs2(numChunks);
+
+		cv::parallel_for_(cv::Range(0, numChunks), FisherStatsBody(*this, d, chunkSize, secondOrder, cs0, cs1, cs2));
+
+		// reduce
+		for(int c = 0; c < numChunks; c++) {
+			s0 += cs0[c];
+			s1 += cs1[c];
+			if(secondOrder)
+				s2 += cs2[c];
+		}
+	}
+	/// <summary>
+	/// Encodes the descriptors as Fisher vector.
+	/// The first order gradients are (s1 - s0*mu) / var / sqrt(w) (no normalization w.r.t. the number of descriptors).
+	/// If secondOrder is true, (s2 - 2*mu*s1 + s0*mu^2) / var - s0) / sqrt(2w) is appended.
+	/// </summary>
+	/// <param name="desc">The descriptors N x D.</param>
+	/// <param name="secondOrder">If true, second order gradients are appended.</param>
+	/// <returns>The Fisher vector as K x D (2K x D) matrix.</returns>
+	cv::Mat FisherVectorEncoder::encode(const cv::Mat& desc, bool secondOrder) const {
+		if(isEmpty()) {
+			qWarning() << "FisherVectorEncoder: no GMM parameters ... aborting";
+			return cv::Mat();
+		}
+
+		cv::Mat s0, s1, s2;
+		accumulate(desc, s0, s1, s2, secondOrder);
+
+		int k = numberOfClusters();
+		cv::Mat fisher(secondOrder ? 2 * k : k, dimensions(), CV_32F);
+
+		for(int j = 0; j < k; j++) {
+			float n = s0.at<float>(j);
+			float w = mWeights.at<float>(j);
+			cv::Mat mu = mMeans.row(j);
+			cv::Mat iv = mInvVars.row(j);
+
+			cv::Mat f1 = s1.row(j) - n * mu;
+			f1 = f1.mul(iv) * (1.0f / (std::sqrt(w) + DBL_EPSILON));
+			f1.copyTo(fisher.row(j));
+
+			if(secondOrder) {
+				cv::Mat mus1 = mu.mul(s1.row(j));
+				cv::Mat mu2 = mu.mul(mu);
+				cv::Mat f2 = s2.row(j) - 2 * mus1 + n * mu2;
+				f2 = (f2.mul(iv) - n) * (1.0f / (std::sqrt(2 * w) + DBL_EPSILON));
+				f2.copyTo(fisher.row(k + j));
+			}
+		}
+
+		return fisher;
+	}
+
+	// WriterIndex --------------------------------------------------------------------
+	namespace {
+
+		// QDataStream's raw data functions take int lengths - so large matrices are written in chunks
+		const qint64 rawChunkSize = 1 << 26;	// 64 MB
+
+		bool writeRaw(QDataStream& s, const char* data, qint64 numBytes) {
+
+			for (qint64 offset = 0; offset < numBytes; offset += rawChunkSize) {
+
+				int len = (int)qMin(rawChunkSize, numBytes - offset);
+
+				if (s.writeRawData(data + offset, len) != len)
+					return false;
+			}
+
+			return true;
+		}
+
+		bool readRaw(QDataStream& s, char* data, qint64 numBytes) {
+
+			for (qint64 offset = 0; offset < numBytes; offset += rawChunkSize) {
+
+				int len = (int)qMin(rawChunkSize, numBytes - offset);
+
+				if (s.readRawData(data + offset, len) != len)
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new (empty) instance of the <see cref="WriterIndex"/> class.
+	/// </summary>
+	/// <param name="metric">The distance metric (WI_COSINE or WI_EUCLIDEAN).</param>
+	WriterIndex::WriterIndex(int metric) {
+		mMetric = (metric >= 0 && metric < WI_METRIC_END) ? metric : WI_COSINE;
+	}
+	/// <summary>
+	/// Returns the metric used by the evaluation for the vocabulary type.
+	/// GMM (Fisher) vectors are compared with the cosine, BOW histograms with the euclidean distance.
+	/// </summary>
+	/// <param name="vocabularyType">The vocabulary type (WriterVocabulary::type).</param>
+	/// <returns>the index metric</returns>
+	int WriterIndex::metricOf(int vocabularyType) {
+		return vocabularyType == WriterVocabulary::WI_BOW ? WI_EUCLIDEAN : WI_COSINE;
+	}
+
+	bool WriterIndex::isEmpty() const {
+		return mFeatures.empty();
+	}
+
+	int WriterIndex::size() const {
+		return mFeatures.rows;
+	}
+
+	int WriterIndex::dimensions() const {
+		return mFeatures.cols;
+	}
+
+	int WriterIndex::metric() const {
+		return mMetric;
+	}
+	/// <summary>
+	/// Adds feature vectors (one per row) to the index.
+	/// If a coarse quantizer is trained, the features are appended to their inverted lists.
+	/// </summary>
+	/// <param name="features">The features N x D.</param>
+	/// <param name="labels">The labels (e.g. writer ids) of the features.</param>
+	/// <returns>the index of the first added feature or -1 if the dimensions do not match</returns>
+	int WriterIndex::add(const cv::Mat& features, const QStringList& labels) {
+		if(features.empty())
+			return size();
+
+		if(!isEmpty() && features.cols != dimensions()) {
+			qWarning() << "WriterIndex: cannot add features with" << features.cols << "dimensions to an index with" << dimensions();
+			return -1;
+		}
+
+		cv::Mat f = prepare(features);
+		int first = size();
+		mFeatures.push_back(f);
+
+		for(int r = 0; r < f.rows; r++) {
+			mSqNorms << (float)f.row(r).dot(f.row(r));
+			mLabels << (r < labels.size() ? labels[r] : QString());
+
+			if(isApproximate())
+				mLists[closestList(f.row(r))] << first + r;
+		}
+
+		return first;
+	}
+	/// <summary>
+	/// Returns the feature (as stored in the index) with index idx.
+	/// </summary>
+	cv::Mat WriterIndex::feature(int idx) const {
+		if(idx < 0 || idx >= size())
+			return cv::Mat();
+		return mFeatures.row(idx);
+	}
+
+	QString WriterIndex::label(int idx) const {
+		return mLabels.value(idx);
+	}
+	/// <summary>
+	/// Trains the coarse quantizer (k-means) on all features in the index
+	/// and distributes them to numLists inverted lists.
+	/// If numLists <= 0, the quantizer is removed and all queries are exact.
+	/// </summary>
+	/// <param name="numLists">The number of inverted lists.</param>
+	void WriterIndex::train(int numLists) {
+		mCentroids = cv::Mat();
+		mLists.clear();
+
+		numLists = qMin(numLists, size());
+		if(numLists <= 0)
+			return;
+
+		cv::Mat labels;
+		cv::TermCriteria tc(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 1e-3);
+		cv::kmeans(mFeatures, numLists, labels, tc, 1, cv::KMEANS_PP_CENTERS, mCentroids);
+
+		mLists.resize(numLists);
+		for(int i = 0; i < labels.rows; i++)
+			mLists[labels.at<int>(i)] << i;
+	}
+
+	bool WriterIndex::isApproximate() const {
+		return !mLists.empty();
+	}
+
+	void WriterIndex::setNumProbes(int numProbes) {
+		mNumProbes = qMax(numProbes, 1);
+	}
+
+	int WriterIndex::numProbes() const {
+		return mNumProbes;
+	}
+	/// <summary>
+	/// Computes the (exact) distances of the query to all features in the index.
+	/// Dot products are computed with a single matrix multiplication.
+	/// </summary>
+	/// <param name="query">The query feature vector 1 x D.</param>
+	/// <returns>the distances N x 1 (CV_32F)</returns>
+	cv::Mat WriterIndex::distances(const cv::Mat& query) const {
+		if(isEmpty() || query.cols != dimensions())
+			return cv::Mat();
+
+		cv::Mat q = prepare(query.row(0));
+		cv::Mat dists;
+		cv::gemm(mFeatures, q, 1.0, cv::noArray(), 0.0, dists, cv::GEMM_2_T);
+
+		float* dp = dists.ptr<float>();
+		float qn = (float)q.dot(q);
+		for(int i = 0; i < dists.rows; i++) {
+			if(mMetric == WI_COSINE)
+				dp[i] = 1.0f - dp[i];	// 0 is equal 2 is opposite
+			else
+				dp[i] = std::sqrt(qMax(mSqNorms[i] - 2.0f * dp[i] + qn, 0.0f));
+		}
+
+		return dists;
+	}
+	/// <summary>
+	/// Searches the k nearest features of the query.
+	/// If the index is approximate and exact is false, only the features of the
+	/// numProbes closest inverted lists are compared. The results are sorted by distance.
+	/// </summary>
+	/// <param name="query">The query feature vector 1 x D.</param>
+	/// <param name="k">The number of neighbors.</param>
+	/// <param name="indexes">The indexes of the k nearest features.</param>
+	/// <param name="dists">Their distances.</param>
+	/// <param name="exact">If true, the query is compared to all features.</param>
+	void WriterIndex::search(const cv::Mat& query, int k, QVector<int>& indexes, QVector<float>& dists, bool exact) const {
+		indexes.clear();
+		dists.clear();
+
+		if(isEmpty() || query.cols != dimensions() || k <= 0)
+			return;
+
+		QVector<int> candidates;
+		QVector<float> cDists;
+
+		if(!exact && isApproximate()) {
+			cv::Mat q = prepare(query.row(0));
+
+			QVector<QPair<double, int> > lists;
+			for(int l = 0; l < mCentroids.rows; l++)
+				lists << qMakePair(cv::norm(q, mCentroids.row(l), cv::NORM_L2SQR), l);
+
+			int np = qMin(mNumProbes, lists.size());
+			std::partial_sort(lists.begin(), lists.begin() + np, lists.end());
+
+			for(int l = 0; l < np; l++)
+				candidates += mLists[lists[l].second];
+
+			cDists = candidateDistances(q, candidates);
+		}
+		else {
+			cv::Mat d = distances(query);
+			const float* dp = d.ptr<float>();
+			candidates.resize(d.rows);
+			cDists.resize(d.rows);
+			for(int i = 0; i < d.rows; i++) {
+				candidates[i] = i;
+				cDists[i] = dp[i];
+			}
+		}
+
+		// partial selection of the top k
+		QVector<int> order(candidates.size());
+		for(int i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		int kk = qMin(k, order.size());
+		std::partial_sort(order.begin(), order.begin() + kk, order.end(), [&](int a, int b) {
+			return cDists[a] < cDists[b] || (cDists[a] == cDists[b] && candidates[a] < candidates[b]);
+		});
+
+		for(int i = 0; i < kk; i++) {
+			indexes << candidates[order[i]];
+			dists << cDists[order[i]];
+		}
+	}
+	/// <summary>
+	/// Returns the index of the nearest feature for each row of queries.
+	/// This is used to assign descriptors to BOW clusters.
+	/// </summary>
+	/// <param name="queries">The queries M x D.</param>
+	/// <returns>M indexes of the nearest features</returns>
+	QVector<int> WriterIndex::nearest(const cv::Mat& queries) const {
+		QVector<int> idx;
+		if(isEmpty() || queries.empty() || queries.cols != dimensions())
+			return idx;
+
+		cv::Mat q = prepare(queries);
+		cv::Mat dots;
+		cv::gemm(q, mFeatures, 1.0, cv::noArray(), 0.0, dots, cv::GEMM_2_T);
+
+		idx.resize(q.rows);
+		for(int r = 0; r < dots.rows; r++) {
+			const float* dp = dots.ptr<float>(r);
+			int best = 0;
+			float bestScore = std::numeric_limits<float>::max();
+
+			for(int c = 0; c < dots.cols; c++) {
+				// the query norm is constant per row
+				float s = (mMetric == WI_COSINE) ? -dp[c] : mSqNorms[c] - 2.0f * dp[c];
+				if(s < bestScore) {
+					bestScore = s;
+					best = c;
+				}
+			}
+			idx[r] = best;
+		}
+
+		return idx;
+	}
+	/// <summary>
+	/// Saves the index to a single binary file.
+	/// Features are written as raw floats in native byte order.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <returns>true on success</returns>
+	bool WriterIndex::save(const QString& filePath) const {
+		QFile file(filePath);
+		if(!file.open(QIODevice::WriteOnly)) {
+			qWarning() << "WriterIndex: cannot write to" << filePath;
+			return false;
+		}
+
+		QDataStream s(&file);
+		s << (quint32)0x52444649 << (qint32)1;	// magic (RDFI) & version
+		s << (qint32)mMetric << (qint32)mFeatures.rows << (qint32)mFeatures.cols;
+		if(!mFeatures.empty() && !writeRaw(s, (const char*)mFeatures.ptr<float>(), (qint64)mFeatures.total() * (qint64)sizeof(float))) {
+			qWarning() << "WriterIndex: could not write features to" << filePath;
+			return false;
+		}
+		s << mLabels;
+
+		s << (qint32)mCentroids.rows << (qint32)mNumProbes;
+		if(!mCentroids.empty() && !writeRaw(s, (const char*)mCentroids.ptr<float>(), (qint64)mCentroids.total() * (qint64)sizeof(float))) {
+			qWarning() << "WriterIndex: could not write centroids to" << filePath;
+			return false;
+		}
+		s << mLists;
+
+		return s.status() == QDataStream::Ok;
+	}
+	/// <summary>
+	/// Loads an index which was written by WriterIndex::save.
+	/// The header, the matrix dimensions and all inverted list entries are
+	/// validated so that a truncated or corrupted file is rejected.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <returns>the index (empty if it could not be loaded)</returns>
+	WriterIndex WriterIndex::load(const QString& filePath) {
+		QFile file(filePath);
+		if(!file.open(QIODevice::ReadOnly)) {
+			qWarning() << "WriterIndex: cannot read" << filePath;
+			return WriterIndex();
+		}
+
+		QDataStream s(&file);
+		quint32 magic;
+		qint32 version, metric, rows, cols;
+		s >> magic >> version;
+		if(magic != 0x52444649 || version != 1) {
+			qWarning() << "WriterIndex:" << filePath << "is not a writer index";
+			return WriterIndex();
+		}
+
+		// the matrices must fit into the remaining file
+		auto fits = [&file](qint64 r, qint64 c) {
+			return r * c * (qint64)sizeof(float) <= file.size() - file.pos();
+		};
+
+		s >> metric >> rows >> cols;
+		if(s.status() != QDataStream::Ok || metric < 0 || metric >= WI_METRIC_END || 
+			rows < 0 || cols < 0 || (rows > 0 && cols == 0) || !fits(rows, cols)) {
+			qWarning() << "WriterIndex:" << filePath << "is corrupted (header)";
+			return WriterIndex();
+		}
+
+		WriterIndex index(metric);
+
+		if(rows > 0) {
+			index.mFeatures.create(rows, cols, CV_32F);
+			if(!readRaw(s, (char*)index.mFeatures.ptr<float>(), (qint64)index.mFeatures.total() * (qint64)sizeof(float))) {
+				qWarning() << "WriterIndex:" << filePath << "is truncated (features)";
+				return WriterIndex();
+			}
+		}
+		s >> index.mLabels;
+
+		qint32 numLists, numProbes;
+		s >> numLists >> numProbes;
+		if(s.status() != QDataStream::Ok || numLists < 0 || numLists > rows || !fits(numLists, cols)) {
+			qWarning() << "WriterIndex:" << filePath << "is corrupted (quantizer)";
+			return WriterIndex();
+		}
+
+		index.setNumProbes(numProbes);
+		if(numLists > 0) {
+			index.mCentroids.create(numLists, cols, CV_32F);
+			if(!readRaw(s, (char*)index.mCentroids.ptr<float>(), (qint64)index.mCentroids.total() * (qint64)sizeof(float))) {
+				qWarning() << "WriterIndex:" << filePath << "is truncated (centroids)";
+				return WriterIndex();
+			}
+		}
+		s >> index.mLists;
+
+		if(s.status() != QDataStream::Ok || index.mLabels.size() != index.size() || index.mLists.size() != index.mCentroids.rows) {
+			qWarning() << "WriterIndex:" << filePath << "is corrupted";
+			return WriterIndex();
+		}
+
+		// each feature must be in exactly one inverted list
+		if(index.isApproximate()) {
+			QVector<bool> listed(index.size(), false);
+
+			for(const QVector<int>& l : index.mLists) {
+				for(int idx : l) {
+					if(idx < 0 || idx >= index.size() || listed[idx]) {
+						qWarning() << "WriterIndex:" << filePath << "is corrupted (inverted lists)";
+						return WriterIndex();
+					}
+					listed[idx] = true;
+				}
+			}
+
+			if(listed.contains(false)) {
+				qWarning() << "WriterIndex:" << filePath << "is corrupted (inverted lists)";
+				return WriterIndex();
+			}
+		}
+
+		for(int r = 0; r < index.size(); r++)
+			index.mSqNorms << (float)index.mFeatures.row(r).dot(index.mFeatures.row(r));
+
+		return index;
+	}
+	/// <summary>
+	/// Converts the features to continuous CV_32F rows.
+	/// For the cosine metric, the rows are L2 normalized.
+	/// </summary>
+	cv::Mat WriterIndex::prepare(const cv::Mat& features) const {
+		cv::Mat f;
+		features.convertTo(f, CV_32F);
+
+		if(mMetric == WI_COSINE) {
+			for(int r = 0; r < f.rows; r++) {
+				cv::Mat row = f.row(r);
+				row /= (cv::norm(row) + DBL_EPSILON);
+			}
+		}
+
+		return f;
+	}
+	/// <summary>
+	/// Computes the distances of the (prepared) query to the candidate features.
+	/// </summary>
+	QVector<float> WriterIndex::candidateDistances(const cv::Mat& query, const QVector<int>& candidates) const {
+		QVector<float> dists(candidates.size());
+		float qn = (float)query.dot(query);
+
+		for(int i = 0; i < candidates.size(); i++) {
+			int c = candidates[i];
+			float dot = (float)mFeatures.row(c).dot(query);
+
+			if(mMetric == WI_COSINE)
+				dists[i] = 1.0f - dot;
+			else
+				dists[i] = std::sqrt(qMax(mSqNorms[c] - 2.0f * dot + qn, 0.0f));
+		}
+
+		return dists;
+	}
+	/// <summary>
+	/// Returns the inverted list whose centroid is closest to the (prepared) feature.
+	/// </summary>
+	int WriterIndex::closestList(const cv::Mat& feature) const {
+		int best = 0;
+		double bestDist = std::numeric_limits<double>::max();
+
+		for(int l = 0; l < mCentroids.rows; l++) {
+			double d = cv::norm(feature, mCentroids.row(l), cv::NORM_L2SQR);
+			if(d < bestDist) {
+				bestDist = d;
+				best = l;
+			}
+		}
+
+		return best;
+	}
+
 	WriterVocabularyConfig::WriterVocabularyConfig() {
 		mModuleName = "WriterVocabulary";
 	}
@@ -1234,7 +1883,7 @@ namespace rdf {
 		mL2NormBefore = performL2;
 	}
 
-	void WriterVocabularyConfig::load(const QSettings & settings) {
+	void WriterVocabularyConfig::load(const ConfigSnapshot & settings) {
 		mType = settings.value("vocType", mType).toInt();
 		if(mType > rdf::WriterVocabulary::WI_UNDEFINED)
 			mType = rdf::WriterVocabulary::WI_UNDEFINED;
@@ -38,6 +38,7 @@
 // Qt Includes
 #include <QString>
 #include <QVector>
+#include <QStringList>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/ml.hpp>
 #pragma warning(pop)
@@ -91,7 +92,7 @@ namespace rdf {
 			//QString toString() const override;
 
 		protected:
-			void load(const QSettings& settings) override;
+			void load(const ConfigSnapshot& settings) override;
 			void save(QSettings& settings) const override;
 
 		private:
@@ -105,6 +106,92 @@ namespace rdf {
 			bool mL2NormBefore = false;
 	};
 
+	/// <summary>
+	/// Computes Fisher vectors for a diagonal GMM.
+	/// The GMM parameters are cached once (per vocabulary) so that
+	/// encoding does not need to query the cv::ml::EM. Posteriors
+	/// and statistics are computed with matrix operations in parallel 
+	/// chunks of descriptors which are then reduced.
+	/// </summary>
+	class DllCoreExport FisherVectorEncoder {
+
+	public:
+		FisherVectorEncoder(const cv::Ptr<cv::ml::EM> em = cv::Ptr<cv::ml::EM>());
+
+		bool isEmpty() const;
+		int numberOfClusters() const;
+		int dimensions() const;
+
+		cv::Mat posteriors(const cv::Mat& desc) const;
+		void accumulate(const cv::Mat& desc, cv::Mat& s0, cv::Mat& s1, cv::Mat& s2, bool secondOrder = true) const;
+		cv::Mat encode(const cv::Mat& desc, bool secondOrder = false) const;
+
+	private:
+		cv::Mat mMeans;				// K x D
+		cv::Mat mInvVars;			// K x D (1/sigma^2)
+		cv::Mat mMeansInvVars;		// K x D (mu/sigma^2)
+		cv::Mat mLogConst;			// 1 x K (log of the normalization, weights and mu^2/sigma^2 terms)
+		cv::Mat mWeights;			// 1 x K
+	};
+
+	/// <summary>
+	/// Persistent nearest neighbor index of writer feature vectors.
+	/// Features can be added incrementally. Exact queries compute
+	/// the distances to all features and select the top k partially.
+	/// If a coarse quantizer is trained (IVF), approximate queries only
+	/// visit the inverted lists of the numProbes closest centroids.
+	/// The index (features, labels and quantizer) is stored in a single binary file.
+	/// </summary>
+	class DllCoreExport WriterIndex {
+
+	public:
+		enum metric {
+			WI_COSINE,			// 1 - cos(a, b) (GMM)
+			WI_EUCLIDEAN,		// ||a - b|| (BOW)
+
+			WI_METRIC_END
+		};
+
+		WriterIndex(int metric = WI_COSINE);
+
+		static int metricOf(int vocabularyType);
+
+		bool isEmpty() const;
+		int size() const;
+		int dimensions() const;
+		int metric() const;
+
+		int add(const cv::Mat& features, const QStringList& labels = QStringList());
+		cv::Mat feature(int idx) const;
+		QString label(int idx) const;
+
+		void train(int numLists);
+		bool isApproximate() const;
+		void setNumProbes(int numProbes);
+		int numProbes() const;
+
+		cv::Mat distances(const cv::Mat& query) const;
+		void search(const cv::Mat& query, int k, QVector<int>& indexes, QVector<float>& dists, bool exact = false) const;
+		QVector<int> nearest(const cv::Mat& queries) const;
+
+		bool save(const QString& filePath) const;
+		static WriterIndex load(const QString& filePath);
+
+	private:
+		cv::Mat prepare(const cv::Mat& features) const;
+		QVector<float> candidateDistances(const cv::Mat& query, const QVector<int>& candidates) const;
+		int closestList(const cv::Mat& feature) const;
+
+		int mMetric = WI_COSINE;
+		cv::Mat mFeatures;					// N x D CV_32F (L2 normalized for cosine)
+		QVector<float> mSqNorms;			// squared norms of the features (euclidean)
+		QStringList mLabels;
+
+		cv::Mat mCentroids;					// L x D coarse quantizer
+		QVector<QVector<int> > mLists;		// inverted lists
+		int mNumProbes = 8;
+	};
+
 	class DllCoreExport WriterVocabulary {
 
 	public:
@@ -112,6 +199,7 @@ namespace rdf {
 
 		void loadVocabulary(const QString filePath);
 		void saveVocabulary(const QString filePath);
+		static QSharedPointer<const WriterVocabulary> loadCachedVocabulary(const QString filePath);
 
 		cv::Mat calcualteDistanceMatrix(cv::Mat hists) const;
 
@@ -190,6 +278,8 @@ namespace rdf {
 
 		cv::Mat mVocabulary = cv::Mat();
 		cv::Ptr<cv::ml::EM> mEM;
+		QSharedPointer<FisherVectorEncoder> mEncoder;
+		QSharedPointer<WriterIndex> mVocabularyIndex;
 		cv::Mat mPcaMean = cv::Mat();
 		cv::Mat mPcaEigenvectors = cv::Mat();
 		cv::Mat mPcaEigenvalues = cv::Mat();
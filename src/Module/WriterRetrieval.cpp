@@ -250,7 +250,7 @@ namespace rdf {
 	/// Loads the properties from the settings. If a vocabulary path is set, the vocabulary is also loaded.
 	/// </summary>
 	/// <param name="settings">The settings.</param>
-	void WriterRetrievalConfig::load(const QSettings & settings) {
+	void WriterRetrievalConfig::load(const ConfigSnapshot & settings) {
 		mVocPath = settings.value("vocPath", QString()).toString();		
 		mFeatureDir = settings.value("featureDir", QString()).toString();
 		mEvalPath = settings.value("evalPath", QString()).toString();
@@ -286,7 +286,10 @@ namespace rdf {
 			return false;
 
 		if (mVoc.isEmpty()) {
-			mVoc.loadVocabulary(config()->vocabularyPath());
+			// cv::Mats are shared - so copying the cached vocabulary is cheap
+			QSharedPointer<const WriterVocabulary> voc = WriterVocabulary::loadCachedVocabulary(config()->vocabularyPath());
+			if (voc)
+				mVoc = *voc;
 		}
 
 		WriterImage wi = WriterImage();
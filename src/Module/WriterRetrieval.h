@@ -74,7 +74,7 @@ namespace rdf {
 		QString toString() const override;
 
 	protected:
-		void load(const QSettings& settings) override;
+		void load(const ConfigSnapshot& settings) override;
 		void save(QSettings& settings) const override;
 
 	private:
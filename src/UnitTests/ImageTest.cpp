@@ -0,0 +1,184 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "ImageTest.h"
+
+#include "Image.h"		// tested
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QVector>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+namespace rdf {
+
+MatFileTest::MatFileTest() {
+}
+
+/// <summary>
+/// Writes uncompressed and compressed (several chunks) matrices to a
+/// container and reads them using the meta data stored in the JSON.
+/// A missing container must not return data.
+/// </summary>
+/// <returns>true if all matrices are read correctly.</returns>
+bool MatFileTest::roundTrip() const {
+
+	QVector<cv::Mat> mats;
+	mats << matrix(300, 64, CV_32FC1, 42);
+	mats << matrix(1, 1000, CV_8UC1, 43);
+	mats << matrix(5000, 1000, CV_32FC1, 44);	// > 16 MB: compressed in several chunks
+	mats << cv::Mat();
+
+	QString filePath = tempPath("rdf-mat-file-test." + MatFile::suffix());
+	QString dirPath = QFileInfo(filePath).absolutePath();
+
+	QVector<QJsonObject> meta;
+	MatFile mf(filePath);
+	if (!mf.open(QIODevice::WriteOnly)) {
+		qWarning() << "could not create" << filePath;
+		return false;
+	}
+
+	for (const cv::Mat& m : mats) {
+		meta << mf.append(m, false);
+		meta << mf.append(m, true);
+	}
+	mf.close();
+
+	for (int idx = 0; idx < meta.size(); idx++) {
+
+		cv::Mat m = Image::jsonToMat(meta[idx], dirPath);
+
+		if (!equal(m, mats[idx / 2])) {
+			qWarning() << "matrix" << idx / 2 << "(compressed:" << (idx % 2 == 1) << ") differs after reading it from" << filePath;
+			QFile::remove(filePath);
+			return false;
+		}
+	}
+
+	QFile::remove(filePath);
+
+	// the container is gone
+	if (!Image::jsonToMat(meta[0], dirPath).empty()) {
+		qWarning() << "a matrix was read from a missing container";
+		return false;
+	}
+
+	qInfo() << "MatFile round-trip passed";
+
+	return true;
+}
+
+/// <summary>
+/// Reads matrices stored in the formats that were used before MatFile:
+/// embedded base64 data and base64 data in an external file.
+/// Embedded data is used if a container is missing.
+/// </summary>
+/// <returns>true if the legacy formats are read correctly.</returns>
+bool MatFileTest::legacy() const {
+
+	cv::Mat m = matrix(100, 32, CV_32FC1, 42);
+
+	// embedded
+	for (bool compress : { false, true }) {
+
+		if (!equal(Image::jsonToMat(Image::matToJson(m, compress)), m)) {
+			qWarning() << "cannot read embedded matrix - compressed:" << compress;
+			return false;
+		}
+	}
+
+	// external file
+	QString filePath = tempPath("rdf-mat-file-test.rdf");
+	if (!Image::writeMat(m, filePath)) {
+		qWarning() << "could not write" << filePath;
+		return false;
+	}
+
+	QJsonObject jo = Image::matToJsonExtern(m, QFileInfo(filePath).fileName());
+	cv::Mat me = Image::jsonToMat(jo, QFileInfo(filePath).absolutePath());
+	QFile::remove(filePath);
+
+	if (!equal(me, m)) {
+		qWarning() << "cannot read matrix from the external file" << filePath;
+		return false;
+	}
+
+	// container is missing, but the data is embedded
+	jo = Image::matToJson(m);
+	jo.insert("fileName", "rdf-missing-container." + MatFile::suffix());
+	jo.insert("offset", 0);
+
+	if (!equal(Image::jsonToMat(jo, QDir::tempPath()), m)) {
+		qWarning() << "embedded data is not used if the container is missing";
+		return false;
+	}
+
+	qInfo() << "legacy matrix formats are read correctly";
+
+	return true;
+}
+
+/// <summary>
+/// Random matrix.
+/// </summary>
+cv::Mat MatFileTest::matrix(int rows, int cols, int type, int seed) const {
+
+	cv::RNG rng(seed);
+
+	cv::Mat m(rows, cols, type);
+	rng.fill(m, cv::RNG::UNIFORM, 0, 255);
+
+	return m;
+}
+
+bool MatFileTest::equal(const cv::Mat & a, const cv::Mat & b) const {
+
+	if (a.empty() || b.empty())
+		return a.empty() && b.empty();
+
+	if (a.size() != b.size() || a.type() != b.type())
+		return false;
+
+	return cv::norm(a, b, cv::NORM_INF) == 0.0;
+}
+
+QString MatFileTest::tempPath(const QString & fileName) const {
+	return QDir::temp().absoluteFilePath(fileName);
+}
+
+}
@@ -44,6 +44,8 @@
 #include "SuperPixelScaleSpace.h"
 #include "Evaluation.h"
 #include "EvaluationModule.h"
+#include "PixelLabel.h"
+#include "TextHeightEstimation.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QImage>
@@ -53,6 +55,9 @@
 #include <opencv2/ml.hpp>
 #pragma warning(pop)
 
+#include <algorithm>
+#include <cmath>
+
 namespace rdf {
 
 BaselineTest::BaselineTest(const TestConfig & config) : mConfig(config) {
@@ -385,4 +390,265 @@ bool SuperPixelTest::load(rdf::PageXmlParser& parser) const {
 	return true;
 }
 
-}
\ No newline at end of file
+// -------------------------------------------------------------------- RandomTreesTest 
+RandomTreesTest::RandomTreesTest() {
+}
+
+/// <summary>
+/// Trains random trees on a synthetic 3 class problem and checks that
+/// the RandomTreesEngine predicts the same labels as cv::ml::RTrees::predict.
+/// The SuperPixelModel's (batched) classification must match the per sample
+/// classification (votes and labels).
+/// </summary>
+/// <returns>true if the predictions are equal.</returns>
+bool RandomTreesTest::predict() const {
+
+	LabelManager lm;
+	lm.add(LabelInfo(1, "class-a"));
+	lm.add(LabelInfo(2, "class-b"));
+	lm.add(LabelInfo(3, "class-c"));
+
+	cv::Mat features, labels;
+	samples(42, features, labels);
+
+	cv::theRNG().state = 42;
+	cv::Ptr<cv::ml::RTrees> trees = cv::ml::RTrees::create();
+	trees->setMaxDepth(8);
+	trees->setMinSampleCount(2);
+	trees->setTermCriteria(cv::TermCriteria(cv::TermCriteria::COUNT, mNumTrees, 1e-6));
+
+	if (!trees->train(features, cv::ml::ROW_SAMPLE, labels)) {
+		qWarning() << "could not train the random trees";
+		return false;
+	}
+
+	RandomTreesEngine engine(trees, lm);
+
+	if (engine.isEmpty() || engine.numTrees() != mNumTrees) {
+		qWarning() << "could not flatten the random trees";
+		return false;
+	}
+
+	// the flattened trees vs. OpenCV
+	cv::Mat tFeatures, tLabels;
+	samples(7, tFeatures, tLabels);
+
+	cv::Mat votes, labelIndexes;
+	if (!engine.predict(tFeatures, votes, labelIndexes)) {
+		qWarning() << "the RandomTreesEngine could not predict";
+		return false;
+	}
+
+	QVector<LabelInfo> lis = lm.labelInfos();
+
+	for (int rIdx = 0; rIdx < tFeatures.rows; rIdx++) {
+
+		int cvLabel = qRound(trees->predict(tFeatures.row(rIdx)));
+		int label = lis[labelIndexes.at<int>(rIdx)].id();
+
+		if (label != cvLabel) {
+			qWarning() << "sample" << rIdx << "is predicted as" << label << "but OpenCV predicts" << cvLabel;
+			return false;
+		}
+
+		if (std::abs(cv::sum(votes.row(rIdx))[0] - 1.0) > 1e-4) {
+			qWarning() << "the votes of sample" << rIdx << "do not sum up to 1";
+			return false;
+		}
+	}
+
+	// batched vs. per sample classification
+	SuperPixelModel model(lm, trees);
+	QVector<PixelLabel> batched = model.classify(tFeatures.clone());
+	QVector<PixelLabel> single = model.classifyStatModel(tFeatures.clone());
+
+	if (batched.size() != single.size()) {
+		qWarning() << "the batched classification returns" << batched.size() << "instead of" << single.size() << "labels";
+		return false;
+	}
+
+	for (int idx = 0; idx < batched.size(); idx++) {
+
+		PixelVotes bv = batched[idx].votes();
+		PixelVotes sv = single[idx].votes();
+
+		if (batched[idx].predicted() != single[idx].predicted() || 
+			bv.numTrees() != mNumTrees ||
+			(!sv.isEmpty() && cv::norm(bv.data(), sv.data(), cv::NORM_INF) > 1e-4)) {
+			qWarning() << "the batched classification of sample" << idx << "differs";
+			return false;
+		}
+	}
+
+	qInfo() << "RandomTreesEngine predicts" << tFeatures.rows << "samples like OpenCV";
+
+	return true;
+}
+
+/// <summary>
+/// Three (overlapping) gaussian classes in 8 dimensions.
+/// </summary>
+void RandomTreesTest::samples(int seed, cv::Mat & features, cv::Mat & labels) const {
+
+	cv::RNG rng(seed);
+
+	features = cv::Mat(mNumSamples, 8, CV_32FC1);
+	labels = cv::Mat(mNumSamples, 1, CV_32SC1);
+
+	rng.fill(features, cv::RNG::NORMAL, 0.0, 1.0);
+
+	for (int rIdx = 0; rIdx < features.rows; rIdx++) {
+
+		int cl = rIdx % 3;
+		features.row(rIdx).colRange(cl * 2, cl * 2 + 3) += cv::Scalar(1.5);
+		labels.at<int>(rIdx) = cl + 1;
+	}
+}
+
+// -------------------------------------------------------------------- TextHeightTest 
+TextHeightTest::TextHeightTest() {
+}
+
+/// <summary>
+/// The 1D profile auto correlation (TextHeightEstimation::verticalProfileAcf)
+/// must find the same spectrum peaks as the former 2D auto correlation on
+/// every layer. The layer weights (mean peak magnitude / patch width) must
+/// be within mWeightTolerance (measured: < 7%).
+/// </summary>
+/// <returns>true if both auto correlations give the same results.</returns>
+bool TextHeightTest::autoCorrelation() const {
+
+	struct Fixture {
+		int cols;
+		int rows;
+		int lineHeight;
+	};
+
+	std::vector<Fixture> fixtures = { { 1024, 1408, 30 }, { 1248, 1760, 40 }, { 800, 1200, 20 } };
+
+	for (size_t fIdx = 0; fIdx < fixtures.size(); fIdx++) {
+
+		const Fixture& f = fixtures[fIdx];
+		cv::Mat img = fixture(f.cols, f.rows, f.lineHeight, (int)fIdx + 42);
+
+		std::vector<int> peaks, refPeaks;
+		std::vector<double> weights, refWeights;
+		layerWeights(img, false, peaks, weights);
+		layerWeights(img, true, refPeaks, refWeights);
+
+		for (int lIdx = 0; lIdx < mNumLevels; lIdx++) {
+
+			if (peaks[lIdx] != refPeaks[lIdx]) {
+				qWarning() << "fixture" << fIdx << "layer" << lIdx + 1 << ": peak at" << peaks[lIdx] << "but" << refPeaks[lIdx] << "expected";
+				return false;
+			}
+
+			double dw = refWeights[lIdx] > 0 ? std::abs(weights[lIdx] / refWeights[lIdx] - 1.0) : weights[lIdx];
+			if (dw > mWeightTolerance) {
+				qWarning() << "fixture" << fIdx << "layer" << lIdx + 1 << ": weight" << weights[lIdx] << "differs from" << refWeights[lIdx];
+				return false;
+			}
+
+			qDebug() << "fixture" << fIdx << "layer" << lIdx + 1 << "peak:" << peaks[lIdx] << "weight difference:" << dw * 100 << "%";
+		}
+	}
+
+	qInfo() << "text height auto correlation matches the 2D auto correlation";
+
+	return true;
+}
+
+/// <summary>
+/// A synthetic text page: lines of random dark 'characters' on a noisy background.
+/// </summary>
+cv::Mat TextHeightTest::fixture(int cols, int rows, int lineHeight, int seed) const {
+
+	cv::RNG rng(seed);
+	cv::Mat img(rows, cols, CV_8UC1, cv::Scalar(230));
+
+	for (int y = 40; y + lineHeight < img.rows - 40; y += cvRound(lineHeight * 1.8)) {
+
+		for (int x = 50; x < img.cols - 50; ) {
+
+			int cw = rng.uniform(lineHeight / 3, lineHeight);
+			int ch = rng.uniform(lineHeight / 2, lineHeight);
+
+			cv::Rect r(x, y + lineHeight - ch, cw / 2, ch);
+			img(r & cv::Rect(0, 0, img.cols, img.rows)).setTo(40);
+
+			x += cw + rng.uniform(2, lineHeight / 2);
+		}
+	}
+
+	cv::Mat noise(img.size(), CV_32FC1);
+	rng.fill(noise, cv::RNG::NORMAL, 0.0, 10.0);
+
+	cv::Mat fImg;
+	img.convertTo(fImg, CV_32F);
+	fImg += noise;
+	fImg.convertTo(img, CV_8U);
+
+	return img;
+}
+
+/// <summary>
+/// The former vertical profile: row sums of the patch's min-max normalized 2D auto correlation.
+/// The fftShift is omitted since circular shifts do not change the spectrum's magnitudes.
+/// </summary>
+cv::Mat TextHeightTest::referenceProfile(const cv::Mat & patch) const {
+
+	cv::Mat dftInput, autoCorr, vPP;
+	patch.convertTo(dftInput, CV_32F);
+
+	cv::dft(dftInput, autoCorr, cv::DFT_COMPLEX_OUTPUT);
+	cv::mulSpectrums(autoCorr, autoCorr, autoCorr, 0, true);
+	cv::dft(autoCorr, autoCorr, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+	cv::normalize(autoCorr, autoCorr, 0, 1, cv::NORM_MINMAX);
+
+	cv::reduce(autoCorr, vPP, 1, cv::REDUCE_SUM, CV_32F);
+
+	return vPP;
+}
+
+/// <summary>
+/// Computes the spectrum peak (text lines per patch) and the weight of each
+/// layer like TextHeightEstimation. Layer l has 2^l x 2^l patches.
+/// </summary>
+void TextHeightTest::layerWeights(const cv::Mat & img, bool reference, std::vector<int>& peaks, std::vector<double>& weights) const {
+
+	peaks.clear();
+	weights.clear();
+
+	for (int level = 1; level <= mNumLevels; level++) {
+
+		int numSplits = 1 << level;
+		int pw = img.cols / numSplits;
+		int ph = img.rows / numSplits;
+
+		std::vector<double> magHist(100, 0.0);
+		std::vector<int> magCount(100, 0);
+
+		for (int y = 0; y + ph <= img.rows; y += ph) {
+			for (int x = 0; x + pw <= img.cols; x += pw) {
+
+				cv::Mat patch = img(cv::Rect(x, y, pw, ph));
+				cv::Mat vPP = reference ? referenceProfile(patch) : TextHeightEstimation::verticalProfileAcf(patch);
+
+				double maxVal = 0;
+				cv::Point maxLoc;
+				TextHeightEstimation::spectrumPeak(vPP, maxVal, maxLoc);
+
+				if (maxLoc.y > 1) {
+					magHist[maxLoc.y] += maxVal;
+					magCount[maxLoc.y]++;
+				}
+			}
+		}
+
+		int peak = (int)(std::max_element(magCount.begin(), magCount.end()) - magCount.begin());
+		peaks.push_back(magCount[peak] > 0 ? peak : -1);
+		weights.push_back(magCount[peak] > 0 ? magHist[peak] / (pw * magCount[peak]) : 0.0);
+	}
+}
+
+}
@@ -38,6 +38,8 @@
 
 #include "TestUtils.h"
 
+#include <vector>
+
 // Qt defines
 namespace cv {
 	class Mat;
@@ -78,5 +80,43 @@ protected:
 	bool load(rdf::PageXmlParser& parser) const;
 };
 
+/// <summary>
+/// Compares the flattened random trees (RandomTreesEngine)
+/// with OpenCV's prediction on a synthetic training set.
+/// </summary>
+class RandomTreesTest {
+
+public:
+	RandomTreesTest();
+
+	bool predict() const;
+
+protected:
+	int mNumSamples = 600;
+	int mNumTrees = 15;
+
+	void samples(int seed, cv::Mat& features, cv::Mat& labels) const;
+};
+
+/// <summary>
+/// Compares the text height estimation's 1D profile auto correlation
+/// with the former 2D auto correlation on synthetic text pages.
+/// </summary>
+class TextHeightTest {
+
+public:
+	TextHeightTest();
+
+	bool autoCorrelation() const;
+
+protected:
+	int mNumLevels = 4;
+	double mWeightTolerance = 0.1;	// relative difference of the layer weights
+
+	cv::Mat fixture(int cols, int rows, int lineHeight, int seed) const;
+	cv::Mat referenceProfile(const cv::Mat& patch) const;
+	void layerWeights(const cv::Mat& img, bool reference, std::vector<int>& peaks, std::vector<double>& weights) const;
+};
+
 
 }
\ No newline at end of file
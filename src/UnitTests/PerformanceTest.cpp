@@ -0,0 +1,336 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "PerformanceTest.h"
+
+#include "Binarization.h"
+#include "SkewEstimation.h"
+#include "GradientVector.h"
+#include "LayoutAnalysis.h"
+#include "FormAnalysis.h"
+
+#include "Profiler.h"
+#include "ImageProcessor.h"
+#include "Utils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QJsonArray>
+#include <opencv2/imgproc.hpp>
+#pragma warning(pop)
+
+namespace rdf {
+
+PerformanceTest::PerformanceTest() {
+}
+
+void PerformanceTest::setNumRuns(int numRuns) {
+	mNumRuns = qMax(numRuns, 1);
+}
+
+void PerformanceTest::setPageSize(const cv::Size & size) {
+	mPageSize = size;
+}
+
+/// <summary>
+/// Sets the relative time budget (0.5 = stages may be 50% slower than the baseline).
+/// </summary>
+void PerformanceTest::setTimeTolerance(double tolerance) {
+	mTimeTolerance = tolerance;
+}
+
+/// <summary>
+/// Sets the relative memory budget (0.2 = stages may need 20% more memory than the baseline).
+/// </summary>
+void PerformanceTest::setMemoryTolerance(double tolerance) {
+	mMemoryTolerance = tolerance;
+}
+
+/// <summary>
+/// Runs all pipelines on a synthetic document.
+/// The profiler (and its memory tracking) is enabled for the test.
+/// </summary>
+/// <returns>false if a pipeline could not be computed.</returns>
+bool PerformanceTest::run() {
+
+	if (!Benchmark::isReleaseBuild())
+		qWarning() << "this is not a release build - timings are not representative";
+
+	Profiler& p = Profiler::instance();
+	p.setEnabled(true);
+	p.setMemoryTracking(true);
+
+	cv::Mat doc = Benchmark::syntheticDocument(mPageSize);
+
+	qInfo().nospace() << "measuring pipelines on a " << doc.cols << "x" << doc.rows << " synthetic page, " << mNumRuns << " runs";
+
+	bool ok = true;
+	ok &= measure("pre-processing", [&]() { return preProcessing(doc); });
+	ok &= measure("layout", [&]() { return layout(doc); });
+	ok &= measure("table", [&]() { return table(doc); });
+
+	mPeakResident = Utils::peakMemory();
+
+	p.clear();
+	p.setEnabled(false);
+
+	return ok;
+}
+
+/// <summary>
+/// Runs a pipeline (once for warm-up and numRuns times) and records its stages.
+/// </summary>
+/// <param name="name">The pipeline's name (i.e. its root stage).</param>
+/// <param name="pipeline">The pipeline.</param>
+/// <returns>false if the pipeline failed.</returns>
+bool PerformanceTest::measure(const QString & name, const std::function<bool()>& pipeline) {
+
+	Profiler& p = Profiler::instance();
+
+	for (int rIdx = 0; rIdx <= mNumRuns; rIdx++) {
+
+		p.clear();
+
+		bool ok = false;
+		{
+			rdfProfileScope(name);
+			ok = pipeline();
+		}
+
+		if (!ok) {
+			qWarning() << "could not compute the" << name << "pipeline";
+			return false;
+		}
+
+		// warm-up
+		if (rIdx == 0)
+			continue;
+
+		for (const QJsonValue& jv : p.summary().value("stages").toArray()) {
+
+			QJsonObject so = jv.toObject();
+			QString stage = so.value("stage").toString();
+
+			if (!mTimes.contains(stage)) {
+				mStages << stage;
+				mTimes.insert(stage, BenchmarkResult(stage, 1.0, "run"));
+			}
+
+			mTimes[stage].addTime(so.value("wallMs").toDouble());
+			mPeakAllocated[stage] = qMax(mPeakAllocated.value(stage), (qint64)so.value("peakAllocatedBytes").toDouble());
+			mResidentDelta[stage] = qMax(mResidentDelta.value(stage), (qint64)so.value("residentDeltaBytes").toDouble());
+		}
+	}
+
+	BenchmarkResult r = mTimes.value(name);
+	qInfo().noquote() << QString("%1 %2 ms, peak allocated %3 MB")
+		.arg(name, -18)
+		.arg(r.median(), 0, 'f', 1)
+		.arg(mPeakAllocated.value(name) / (1024.0 * 1024.0), 0, 'f', 1);
+
+	return true;
+}
+
+bool PerformanceTest::preProcessing(const cv::Mat & img) const {
+
+	BinarizationSuAdapted bsa(img);
+	if (!bsa.compute())
+		return false;
+
+	TextLineSkew tls(img);
+	if (!tls.compute())
+		return false;
+
+	GradientVector gv(IP::grayscale(img));
+	if (!gv.compute())
+		return false;
+
+	return true;
+}
+
+bool PerformanceTest::layout(const cv::Mat & img) const {
+
+	LayoutAnalysis la(img);
+	return la.compute();
+}
+
+bool PerformanceTest::table(const cv::Mat & img) const {
+
+	cv::Mat gImg = IP::grayscale(img);
+
+	FormFeatures ff(gImg);
+	ff.setFormName("synthetic");
+	ff.setSize(gImg.size());
+
+	return ff.compute();
+}
+
+/// <summary>
+/// Returns the results (can be used as baseline).
+/// Budgets can be configured in the baseline by adding
+/// timeTolerance or memoryTolerance globally or to single stages.
+/// </summary>
+QJsonObject PerformanceTest::toJson() const {
+
+	QJsonArray ja;
+
+	for (const QString& stage : mStages) {
+
+		BenchmarkResult r = mTimes.value(stage);
+
+		QJsonObject so;
+		so["stage"] = stage;
+		so["wallMs"] = r.median();
+		so["minMs"] = r.min();
+		so["peakAllocatedBytes"] = (double)mPeakAllocated.value(stage);
+		so["residentDeltaBytes"] = (double)mResidentDelta.value(stage);
+		ja << so;
+	}
+
+	QJsonObject jo;
+	jo["width"] = mPageSize.width;
+	jo["height"] = mPageSize.height;
+	jo["runs"] = mNumRuns;
+	jo["release"] = Benchmark::isReleaseBuild();
+	jo["peakResidentBytes"] = (double)mPeakResident;
+	jo["timeTolerance"] = mTimeTolerance;
+	jo["memoryTolerance"] = mMemoryTolerance;
+	jo["stages"] = ja;
+
+	return jo;
+}
+
+bool PerformanceTest::write(const QString & filePath) const {
+
+	if (Utils::writeJson(filePath, toJson()) <= 0) {
+		qWarning() << "could not write performance results to" << filePath;
+		return false;
+	}
+
+	qInfo() << "performance results written to" << filePath;
+	return true;
+}
+
+/// <summary>
+/// Compares the results to a baseline file (written by PerformanceTest::write).
+/// A stage regressed if its median time or its peak memory exceeds the budget.
+/// Time budgets are not checked for debug builds or if the baseline has
+/// no wallMs (e.g. the committed baseline which only has memory budgets).
+/// </summary>
+/// <param name="baselinePath">The baseline JSON file.</param>
+/// <returns>The number of regressions or -1 if the baseline could not be loaded.</returns>
+int PerformanceTest::compare(const QString & baselinePath) const {
+
+	QJsonObject jo = Utils::readJson(baselinePath);
+
+	if (jo.isEmpty()) {
+		qWarning() << "could not read baseline from" << baselinePath;
+		return -1;
+	}
+
+	if (jo.value("width").toInt() != mPageSize.width || jo.value("height").toInt() != mPageSize.height)
+		qWarning() << "the baseline was measured with a different page size - results are not comparable";
+
+	bool checkTime = jo.value("release").toBool() == Benchmark::isReleaseBuild();
+	if (!checkTime)
+		qWarning() << "the baseline was measured with a different build type - time budgets are not checked";
+
+	double timeTol = jo.value("timeTolerance").toDouble(mTimeTolerance);
+	double memTol = jo.value("memoryTolerance").toDouble(mMemoryTolerance);
+
+	auto report = [](bool regressed, const QString& stage, const QString& what, double val, double base, const QString& unit) {
+
+		double change = base > 0 ? (val - base) / base : 0.0;
+
+		QString msg = QString("%1 %2 %3 %4 vs. %5 %4 baseline (%6%7%)")
+			.arg(stage, -40)
+			.arg(what, -6)
+			.arg(val, 0, 'f', 1)
+			.arg(unit)
+			.arg(base, 0, 'f', 1)
+			.arg(change >= 0 ? "+" : "")
+			.arg(change * 100.0, 0, 'f', 1);
+
+		if (regressed)
+			qWarning().noquote() << "[REGRESSION]" << msg;
+		else
+			qInfo().noquote() << msg;
+	};
+
+	int numRegressions = 0;
+
+	for (const QJsonValue& jv : jo.value("stages").toArray()) {
+
+		QJsonObject so = jv.toObject();
+		QString stage = so.value("stage").toString();
+
+		if (!mTimes.contains(stage)) {
+			qInfo() << stage << "was not measured";
+			continue;
+		}
+
+		// time budget (machine dependent - hence optional)
+		bool tReg = false;
+
+		if (so.contains("wallMs")) {
+			double bt = so.value("wallMs").toDouble();
+			double t = mTimes.value(stage).median();
+			double tt = so.value("timeTolerance").toDouble(timeTol);
+			tReg = checkTime && t > mMinTime && t > bt * (1.0 + tt);
+
+			report(tReg, stage, "time", t, bt, "ms");
+		}
+
+		// memory budget
+		double mb = 1024.0 * 1024.0;
+		double bm = so.value("peakAllocatedBytes").toDouble();
+		double m = (double)mPeakAllocated.value(stage);
+		double mt = so.value("memoryTolerance").toDouble(memTol);
+		bool mReg = m - bm > mMinMemory && m > bm * (1.0 + mt);
+
+		report(mReg, stage, "memory", m / mb, bm / mb, "MB");
+
+		if (tReg || mReg)
+			numRegressions++;
+	}
+
+	// the process' peak
+	double bp = jo.value("peakResidentBytes").toDouble();
+	if (bp > 0 && mPeakResident > bp * (1.0 + memTol) + mMinMemory) {
+		report(true, "process", "peak", mPeakResident / (1024.0 * 1024.0), bp / (1024.0 * 1024.0), "MB");
+		numRegressions++;
+	}
+
+	return numRegressions;
+}
+
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QJsonObject>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#include "Benchmark.h"
+
+#include <functional>
+
+// Qt defines
+
+namespace rdf {
+
+// read defines
+
+/// <summary>
+/// Performance regression test.
+/// Runs the pre-processing, layout and table pipelines on a
+/// deterministic synthetic document and records the wall time
+/// (median of numRuns) and peak memory of every profiled stage.
+/// Results can be written as baseline and compared to a baseline.
+/// A stage regressed if it needs more time or memory than its
+/// budget (the baseline + tolerance). No network or images are needed.
+/// </summary>
+class PerformanceTest {
+
+public:
+	PerformanceTest();
+
+	void setNumRuns(int numRuns);
+	void setPageSize(const cv::Size& size);
+	void setTimeTolerance(double tolerance);
+	void setMemoryTolerance(double tolerance);
+
+	bool run();
+	int compare(const QString& baselinePath) const;
+
+	QJsonObject toJson() const;
+	bool write(const QString& filePath) const;
+
+protected:
+	cv::Size mPageSize = cv::Size(1240, 1754);
+	int mNumRuns = 3;
+	double mTimeTolerance = 0.5;		// 50% slower
+	double mMemoryTolerance = 0.2;		// 20% more memory
+	double mMinTime = 5.0;				// ms - faster stages are not checked (timer noise)
+	qint64 mMinMemory = 1 << 20;		// bytes - smaller changes are not checked
+
+	QStringList mStages;							// in order of their appearance
+	QMap<QString, BenchmarkResult> mTimes;
+	QMap<QString, qint64> mPeakAllocated;			// peak of live cv::Mat bytes
+	QMap<QString, qint64> mResidentDelta;			// max increase of the resident memory
+	qint64 mPeakResident = 0;
+
+	bool measure(const QString& name, const std::function<bool()>& pipeline);
+
+	bool preProcessing(const cv::Mat& img) const;
+	bool layout(const cv::Mat& img) const;
+	bool table(const cv::Mat& img) const;
+};
+
+}
@@ -40,13 +40,18 @@
 #include "Utils.h"
 #include "Settings.h"
 #include "ImageProcessor.h"
+#include "Shapes.h"
+#include "Benchmark.h"
 
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QFileInfo>
 #include <QDir>
+#include <opencv2/imgproc.hpp>
 #pragma warning(pop)
 
+#include <algorithm>
+
 namespace rdf {
 PreProcessingTest::PreProcessingTest(const TestConfig & config) : mConfig(config) {
 }
@@ -163,6 +168,22 @@ bool PreProcessingTest::gradient() const {
 	cv::Mat mag = gradients.magImg();
 	cv::Mat rad = gradients.radImg();
 
+	// compare with the double precision reference
+	GradientVector reference(img);
+	reference.config()->setSinglePrecision(false);
+	if (!reference.compute()) {
+		return false;
+	}
+
+	cv::Mat refMag;
+	reference.magImg().convertTo(refMag, CV_32F);
+	double maxDiff = cv::norm(mag, refMag, cv::NORM_INF);
+
+	if (maxDiff > 1e-4) {
+		qWarning() << "single precision gradient magnitudes differ from the reference by" << maxDiff;
+		return false;
+	}
+
 	cv::normalize(mag, mag, 255, 0, cv::NORM_MINMAX);
 	mag.convertTo(mag, CV_8U);
 	if (mag.channels() == 1) {
@@ -202,6 +223,68 @@ bool PreProcessingTest::load(cv::Mat& img) const {
 	return true;
 }
 
+/// <summary>
+/// Compares the single pass label polygonisation (IP::labelsToPolys)
+/// with tracing each label's mask (IP::maskToPoly).
+/// For each label, the polygons' areas and bounding boxes must be equal.
+/// No image is needed (synthetic labels).
+/// </summary>
+/// <returns>true if both approaches find the same polygons.</returns>
+bool PreProcessingTest::labelContours() const {
+
+	int numLabels = 8;
+	cv::Mat labels = Benchmark::syntheticLabels(cv::Size(1000, 1500), numLabels);
+
+	QVector<QVector<Polygon> > labelPolys = IP::labelsToPolys(labels, numLabels);
+
+	if (labelPolys.size() != numLabels) {
+		qWarning() << "labelsToPolys returns" << labelPolys.size() << "labels instead of" << numLabels;
+		return false;
+	}
+
+	// polygon signature (area, bounding box) - invariant to the start point and collinear points
+	typedef std::pair<double, std::vector<int> > Signature;
+
+	auto signatures = [](const QVector<Polygon>& polys) {
+
+		std::vector<Signature> sigs;
+		for (const Polygon& p : polys) {
+			std::vector<cv::Point> pts = p.toCvPoints();
+			cv::Rect r = cv::boundingRect(pts);
+			sigs.push_back(Signature(cv::contourArea(pts), std::vector<int>{ r.x, r.y, r.width, r.height }));
+		}
+		std::sort(sigs.begin(), sigs.end());
+
+		return sigs;
+	};
+
+	for (int idx = 0; idx < numLabels; idx++) {
+
+		cv::Mat mask = labels == idx;
+		std::vector<Signature> expected = signatures(IP::maskToPoly(mask, 1.0));
+		std::vector<Signature> found = signatures(labelPolys[idx]);
+
+		if (expected.size() != found.size()) {
+			qWarning() << "label" << idx << ":" << found.size() << "regions found, but" << expected.size() << "expected";
+			return false;
+		}
+
+		for (size_t pIdx = 0; pIdx < expected.size(); pIdx++) {
+
+			if (expected[pIdx] != found[pIdx]) {
+				const std::vector<int>& eb = expected[pIdx].second;
+				qWarning() << "label" << idx << ": region with area" << expected[pIdx].first 
+					<< "at" << eb[0] << eb[1] << "(" << eb[2] << "x" << eb[3] << ") differs";
+				return false;
+			}
+		}
+	}
+
+	qInfo() << "label contours of" << numLabels << "labels are equal";
+
+	return true;
+}
+
 bool PreProcessingTest::nativeSkew(const cv::Mat & img, double & angle) const {
 
 	rdf::BaseSkewEstimation bse;
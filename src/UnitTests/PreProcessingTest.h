@@ -55,6 +55,7 @@ public:
 	bool binarize() const;
 	bool skew() const;
 	bool gradient() const;
+	bool labelContours() const;
 
 protected:
 	TestConfig mConfig;
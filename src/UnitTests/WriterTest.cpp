@@ -0,0 +1,261 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "WriterTest.h"
+
+#include "WriterDatabase.h"		// tested
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace rdf {
+
+WriterIndexTest::WriterIndexTest() {
+}
+
+/// <summary>
+/// Compares exact and approximate (all lists probed) searches to a brute force search.
+/// This is done for both metrics and for features that are added after training.
+/// </summary>
+/// <returns>true if all searches found the nearest neighbors.</returns>
+bool WriterIndexTest::search() const {
+
+	cv::Mat queries = features(7).rowRange(0, 20);
+
+	for (int metric = 0; metric < WriterIndex::WI_METRIC_END; metric++) {
+
+		WriterIndex index(metric);
+		index.add(features(42));
+
+		if (!equal(index, queries, true)) {
+			qWarning() << "exact search does not match the brute force search - metric:" << metric;
+			return false;
+		}
+
+		// probing all lists must be exact too
+		int numLists = 8;
+		index.train(numLists);
+		index.setNumProbes(numLists);
+
+		if (!index.isApproximate() || !equal(index, queries, false)) {
+			qWarning() << "approximate search (all lists) does not match the brute force search - metric:" << metric;
+			return false;
+		}
+
+		// features that are added after training are added to the inverted lists
+		index.add(features(43));
+
+		if (!equal(index, queries, false)) {
+			qWarning() << "approximate search does not find features added after training - metric:" << metric;
+			return false;
+		}
+	}
+
+	qInfo() << "WriterIndex search matches the brute force search";
+
+	return true;
+}
+
+/// <summary>
+/// Saves and loads an (approximate) index.
+/// The loaded index must return the same results.
+/// A truncated file must not be loaded.
+/// </summary>
+/// <returns>true if the round-trip preserves the index.</returns>
+bool WriterIndexTest::roundTrip() const {
+
+	cv::Mat f = features(42);
+	QStringList labels;
+	for (int idx = 0; idx < f.rows; idx++)
+		labels << QString("writer-%1").arg(idx % 25);
+
+	WriterIndex index(WriterIndex::WI_EUCLIDEAN);
+	index.add(f, labels);
+	index.train(8);
+	index.setNumProbes(3);
+
+	QString filePath = QDir::temp().absoluteFilePath("rdf-writer-index-test.bin");
+
+	if (!index.save(filePath)) {
+		qWarning() << "could not save the WriterIndex to" << filePath;
+		return false;
+	}
+
+	WriterIndex loaded = WriterIndex::load(filePath);
+
+	bool ok = loaded.size() == index.size() &&
+		loaded.dimensions() == index.dimensions() &&
+		loaded.metric() == index.metric() &&
+		loaded.numProbes() == index.numProbes() &&
+		loaded.isApproximate() == index.isApproximate();
+
+	for (int idx = 0; ok && idx < index.size(); idx++) {
+		ok &= loaded.label(idx) == index.label(idx);
+		ok &= cv::norm(loaded.feature(idx), index.feature(idx), cv::NORM_INF) == 0.0;
+	}
+
+	if (!ok) {
+		qWarning() << "the loaded WriterIndex differs from the saved one";
+		QFile::remove(filePath);
+		return false;
+	}
+
+	// the loaded index must probe the same lists
+	cv::Mat queries = features(7).rowRange(0, 20);
+
+	for (int qIdx = 0; qIdx < queries.rows; qIdx++) {
+
+		QVector<int> idx, lIdx;
+		QVector<float> dists, lDists;
+		index.search(queries.row(qIdx), mK, idx, dists);
+		loaded.search(queries.row(qIdx), mK, lIdx, lDists);
+
+		if (idx != lIdx) {
+			qWarning() << "the loaded WriterIndex returns different neighbors for query" << qIdx;
+			QFile::remove(filePath);
+			return false;
+		}
+	}
+
+	// a truncated index must be rejected
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadWrite) || !file.resize(file.size() / 2)) {
+		qWarning() << "could not truncate" << filePath;
+		QFile::remove(filePath);
+		return false;
+	}
+	file.close();
+
+	WriterIndex truncated = WriterIndex::load(filePath);
+	QFile::remove(filePath);
+
+	if (!truncated.isEmpty()) {
+		qWarning() << "a truncated WriterIndex was loaded";
+		return false;
+	}
+
+	qInfo() << "WriterIndex save/load round-trip passed";
+
+	return true;
+}
+
+/// <summary>
+/// Random (clustered) features.
+/// </summary>
+/// <param name="seed">The random seed.</param>
+/// <returns>The features numFeatures x dimensions (CV_32F).</returns>
+cv::Mat WriterIndexTest::features(int seed) const {
+
+	cv::RNG rng(seed);
+
+	cv::Mat centers(10, mDimensions, CV_32FC1);
+	rng.fill(centers, cv::RNG::UNIFORM, -5.0, 5.0);
+
+	cv::Mat f(mNumFeatures, mDimensions, CV_32FC1);
+	rng.fill(f, cv::RNG::NORMAL, 0.0, 1.0);
+	for (int rIdx = 0; rIdx < f.rows; rIdx++)
+		f.row(rIdx) += centers.row(rIdx % centers.rows);
+
+	return f;
+}
+
+/// <summary>
+/// Returns true if the index finds the k nearest neighbors of all queries.
+/// Neighbors are compared by their (double precision) distances so that
+/// (nearly) equal distances may be returned in any order.
+/// </summary>
+bool WriterIndexTest::equal(const WriterIndex & index, const cv::Mat & queries, bool exact) const {
+
+	// the index' features are normalized for the cosine metric - so we compare with its features
+	cv::Mat f;
+	for (int idx = 0; idx < index.size(); idx++)
+		f.push_back(index.feature(idx));
+
+	for (int qIdx = 0; qIdx < queries.rows; qIdx++) {
+
+		QVector<int> indexes;
+		QVector<float> dists;
+		index.search(queries.row(qIdx), mK, indexes, dists, exact);
+
+		QVector<double> bf = bruteForce(f, queries.row(qIdx), index.metric());
+
+		if (indexes.size() != qMin(mK, bf.size()))
+			return false;
+
+		for (int rIdx = 0; rIdx < indexes.size(); rIdx++) {
+
+			double d = distance(f.row(indexes[rIdx]), queries.row(qIdx), index.metric());
+
+			if (std::abs(d - bf[rIdx]) > 1e-4 || std::abs(d - dists[rIdx]) > 1e-3)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Returns the sorted distances of the query to all features.
+/// </summary>
+QVector<double> WriterIndexTest::bruteForce(const cv::Mat & features, const cv::Mat & query, int metric) const {
+
+	QVector<double> dists;
+
+	for (int idx = 0; idx < features.rows; idx++)
+		dists << distance(features.row(idx), query, metric);
+
+	std::sort(dists.begin(), dists.end());
+
+	return dists;
+}
+
+double WriterIndexTest::distance(const cv::Mat & a, const cv::Mat & b, int metric) const {
+
+	cv::Mat ad, bd;
+	a.convertTo(ad, CV_64F);
+	b.convertTo(bd, CV_64F);
+
+	if (metric == WriterIndex::WI_COSINE)
+		return 1.0 - ad.dot(bd) / (cv::norm(ad) * cv::norm(bd) + DBL_EPSILON);
+
+	return cv::norm(ad, bd, cv::NORM_L2);
+}
+
+}
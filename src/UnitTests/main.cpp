@@ -37,6 +37,7 @@
 #include <QDebug>
 #include <QImage>
 #include <QFileInfo>
+#include <QDir>
 #pragma warning(pop)
 
 #include "Utils.h"
@@ -44,6 +45,9 @@
 #include "LayoutTest.h"
 #include "PreProcessingTest.h"
 #include "TableTest.h"
+#include "PerformanceTest.h"
+#include "WriterTest.h"
+#include "ImageTest.h"
 
 #if defined(_MSC_BUILD) && !defined(QT_NO_DEBUG_OUTPUT) // fixes cmake bug - really release uses subsystem windows, debug and release subsystem console
 #pragma comment (linker, "/SUBSYSTEM:CONSOLE")
@@ -78,6 +82,14 @@ int main(int argc, char** argv) {
 	QCommandLineOption trainSpOpt(QStringList() << "super-pixel", QObject::tr("Test Super Pixel Training."));
 	parser.addOption(trainSpOpt);
 
+	// random trees test
+	QCommandLineOption randomTreesOpt(QStringList() << "random-trees", QObject::tr("Test the flattened Random Trees."));
+	parser.addOption(randomTreesOpt);
+
+	// text height test
+	QCommandLineOption textHeightOpt(QStringList() << "text-height", QObject::tr("Test the Text Height Estimation."));
+	parser.addOption(textHeightOpt);
+
 	// table test
 	QCommandLineOption tableOpt(QStringList() << "table", QObject::tr("Test Table."));
 	parser.addOption(tableOpt);
@@ -86,6 +98,37 @@ int main(int argc, char** argv) {
 	QCommandLineOption preProcessingOpt(QStringList() << "pre-processing", QObject::tr("Test Pre-Processing."));
 	parser.addOption(preProcessingOpt);
 
+	// writer retrieval test
+	QCommandLineOption writerIndexOpt(QStringList() << "writer-index", QObject::tr("Test the Writer Index."));
+	parser.addOption(writerIndexOpt);
+
+	// binary matrix container test
+	QCommandLineOption matFileOpt(QStringList() << "mat-file", QObject::tr("Test the MatFile container."));
+	parser.addOption(matFileOpt);
+
+	// label contours test
+	QCommandLineOption labelContoursOpt(QStringList() << "label-contours", QObject::tr("Test Label Contours."));
+	parser.addOption(labelContoursOpt);
+
+	// performance regression test
+	QCommandLineOption performanceOpt(QStringList() << "performance", QObject::tr("Run the performance regression test on synthetic pages."));
+	parser.addOption(performanceOpt);
+
+	QCommandLineOption perfBaselineOpt(QStringList() << "perf-baseline", QObject::tr("Performance baseline (JSON) to compare with (default: the committed baseline)."), "filepath");
+	parser.addOption(perfBaselineOpt);
+
+	QCommandLineOption perfUpdateOpt(QStringList() << "perf-update", QObject::tr("Write the results as new performance baseline."));
+	parser.addOption(perfUpdateOpt);
+
+	QCommandLineOption perfRunsOpt(QStringList() << "perf-runs", QObject::tr("Number of runs per pipeline (default: 3)."), "runs");
+	parser.addOption(perfRunsOpt);
+
+	QCommandLineOption perfTimeOpt(QStringList() << "perf-time-tolerance", QObject::tr("Relative time budget w.r.t. the baseline (default: 0.5)."), "tolerance");
+	parser.addOption(perfTimeOpt);
+
+	QCommandLineOption perfMemoryOpt(QStringList() << "perf-memory-tolerance", QObject::tr("Relative memory budget w.r.t. the baseline (default: 0.2)."), "tolerance");
+	parser.addOption(perfMemoryOpt);
+
 	parser.process(*QCoreApplication::instance());
 	// CMD parser --------------------------------------------------------------------
 
@@ -133,6 +176,79 @@ int main(int argc, char** argv) {
 			return 1;	// fail the test
 
 
+	}
+	else if (parser.isSet(randomTreesOpt)) {
+
+		rdf::RandomTreesTest rtt;
+
+		if (!rtt.predict())
+			return 1;	// fail the test
+
+	}
+	else if (parser.isSet(textHeightOpt)) {
+
+		rdf::TextHeightTest tht;
+
+		if (!tht.autoCorrelation())
+			return 1;	// fail the test
+
+	}
+	else if (parser.isSet(writerIndexOpt)) {
+
+		rdf::WriterIndexTest wit;
+
+		if (!wit.search())
+			return 1;	// fail the test
+
+		if (!wit.roundTrip())
+			return 1;	// fail the test
+
+	}
+	else if (parser.isSet(matFileOpt)) {
+
+		rdf::MatFileTest mft;
+
+		if (!mft.roundTrip())
+			return 1;	// fail the test
+
+		if (!mft.legacy())
+			return 1;	// fail the test
+
+	}
+	else if (parser.isSet(labelContoursOpt)) {
+
+		rdf::PreProcessingTest ppt;
+
+		if (!ppt.labelContours())
+			return 1;	// fail the test
+
+	}
+	else if (parser.isSet(performanceOpt)) {
+
+		rdf::PerformanceTest pt;
+
+		if (parser.isSet(perfRunsOpt))
+			pt.setNumRuns(parser.value(perfRunsOpt).toInt());
+		if (parser.isSet(perfTimeOpt))
+			pt.setTimeTolerance(parser.value(perfTimeOpt).toDouble());
+		if (parser.isSet(perfMemoryOpt))
+			pt.setMemoryTolerance(parser.value(perfMemoryOpt).toDouble());
+
+		if (!pt.run())
+			return 1;	// fail the test
+
+		QString baselinePath = parser.isSet(perfBaselineOpt) ? parser.value(perfBaselineOpt) : QString(RDF_PERFORMANCE_BASELINE);
+
+		if (parser.isSet(perfUpdateOpt)) {
+
+			QDir().mkpath(QFileInfo(baselinePath).absolutePath());
+
+			if (!pt.write(baselinePath))
+				return 1;	// fail the test
+		}
+		else if (pt.compare(baselinePath) != 0)
+			return 1;	// fail the test
+
 	} else if (parser.isSet(tableOpt)) {
 		//parser.showHelp();
 
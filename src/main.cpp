@@ -50,6 +50,8 @@
 #include "DebugDavid.h"
 #include "PageParser.h"
 #include "Shapes.h"
+#include "BatchProcessing.h"
+#include "Profiler.h"
 
 #if defined(_MSC_BUILD) && !defined(QT_NO_DEBUG_OUTPUT) // fixes cmake bug - really release uses subsystem windows, debug and release subsystem console
 #pragma comment (linker, "/SUBSYSTEM:CONSOLE")
@@ -58,6 +60,9 @@
 #endif
 
 void applyDebugSettings(rdf::DebugConfig& dc);
+void writeProfile(const QString& tracePath);
+bool isBatchMode(const QString& mode);
+bool processPage(const QString& mode, const rdf::DebugConfig& dc, const rdf::FormFeaturesConfig& fc);
 bool testFunction();
 
 int main(int argc, char** argv) {
@@ -78,7 +83,7 @@ int main(int argc, char** argv) {
 	parser.setApplicationDescription("Welcome to the CVL READ Framework testing application.");
 	parser.addHelpOption();
 	parser.addVersionOption();
-	parser.addPositionalArgument("imagepath", QObject::tr("Path to an input image."));
+	parser.addPositionalArgument("imagepath", QObject::tr("Path to an input image. A directory or a list file (one image path per line) starts the batch mode."));
 
 	// xml path
 	QCommandLineOption xmlOpt(QStringList() << "x" << "xml", QObject::tr("Path to PAGE xml. If provided, we make use of the information"), "path");
@@ -120,7 +125,33 @@ int main(int argc, char** argv) {
 	QCommandLineOption jsonOpt(QStringList() << "json", QObject::tr("Path to JSON file for PIE crawler"), "filepath");
 	parser.addOption(jsonOpt);
 
+	// batch mode: number of threads
+	QCommandLineOption threadsOpt(QStringList() << "j" << "threads", QObject::tr("Number of worker threads in batch mode (default: number of cores)."), "number");
+	parser.addOption(threadsOpt);
+
+	// batch mode: number of pages in flight
+	QCommandLineOption inFlightOpt(QStringList() << "in-flight", QObject::tr("Maximal number of pages processed at once in batch mode - reduce it to limit the memory (default: 2 x threads)."), "number");
+	parser.addOption(inFlightOpt);
+
+	// batch mode: summary
+	QCommandLineOption summaryOpt(QStringList() << "summary", QObject::tr("Path to the JSON summary (status & timings per page) of the batch mode."), "filepath");
+	parser.addOption(summaryOpt);
+
+	// profiler
+	QCommandLineOption profileOpt(QStringList() << "profile", QObject::tr("Profiles all stages and writes a Chrome/Perfetto trace to filepath (and an aggregated summary)."), "filepath");
+	parser.addOption(profileOpt);
+
+	// memory profiling
+	QCommandLineOption memoryOpt(QStringList() << "profile-memory", QObject::tr("Tracks the resident memory and cv::Mat allocations of all stages (reported with --profile or on the console)."));
+	parser.addOption(memoryOpt);
+
 	parser.process(*QCoreApplication::instance());
+
+	if (parser.isSet(profileOpt) || parser.isSet(memoryOpt))
+		rdf::Profiler::instance().setEnabled(true);
+
+	if (parser.isSet(memoryOpt))
+		rdf::Profiler::instance().setMemoryTracking(true);
 	// CMD parser --------------------------------------------------------------------
 
 	// stop processing if little tests are preformed
@@ -185,6 +216,48 @@ int main(int argc, char** argv) {
 
 	//rdf::XmlTest xmlTest(dc);
 	//xmlTest.parseXml();
+
+	// batch mode --------------------------------------------------------------------
+	if (rdf::BatchProcessing::isBatchInput(dc.imagePath())) {
+
+		QString mode = parser.value(modeOpt);
+
+		if (!isBatchMode(mode)) {
+			qWarning() << "mode" << mode << "is not supported in batch mode - use [-m layout|separators|table|atable]";
+			parser.showHelp();
+		}
+
+		QStringList imagePaths = rdf::BatchProcessing::collectImages(dc.imagePath());
+
+		if (imagePaths.isEmpty()) {
+			qWarning() << "no images found in" << dc.imagePath();
+			return -1;
+		}
+
+		rdf::BatchProcessing batch(dc);
+		
+		if (parser.isSet(threadsOpt))
+			batch.setNumThreads(parser.value(threadsOpt).toInt());
+		if (parser.isSet(inFlightOpt))
+			batch.setMaxInFlight(parser.value(inFlightOpt).toInt());
+
+		if (parser.isSet(summaryOpt))
+			batch.setSummaryPath(parser.value(summaryOpt));
+		else
+			batch.setSummaryPath(rdf::Utils::createFilePath(dc.imagePath(), "-batch-summary", "json"));
+
+		bool ok = batch.run(imagePaths, [&](const rdf::DebugConfig& pc) {
+			return processPage(mode, pc, fc);
+		});
+
+		if (parser.isSet(profileOpt))
+			writeProfile(parser.value(profileOpt));
+		else if (parser.isSet(memoryOpt))
+			qInfo().noquote() << rdf::Profiler::instance().toString();
+
+		config.save();
+		return ok ? 0 : 1;
+	}
 	
 	if (!dc.imagePath().isEmpty()) {
 
@@ -409,6 +482,11 @@ int main(int argc, char** argv) {
 		parser.showHelp();
 	}
 
+	if (parser.isSet(profileOpt))
+		writeProfile(parser.value(profileOpt));
+	else if (parser.isSet(memoryOpt))
+		qInfo().noquote() << rdf::Profiler::instance().toString();
+
 	// save settings
 	config.save();
 	return 0;	// thanks
@@ -491,6 +569,66 @@ void applyDebugSettings(rdf::DebugConfig& dc) {
 	// add your debug overwrites here...
 }
 
+/// <summary>
+/// Writes the profiler's trace and its summary (tracePath-summary.json).
+/// </summary>
+/// <param name="tracePath">The trace's file path.</param>
+void writeProfile(const QString& tracePath) {
+
+	rdf::Profiler& p = rdf::Profiler::instance();
+	qInfo().noquote() << p.toString();
+
+	QString summaryPath = rdf::Utils::createFilePath(tracePath, "-summary", "json");
+
+	if (p.writeTrace(tracePath) && p.writeSummary(summaryPath))
+		qInfo() << "profile written to" << tracePath << "and" << summaryPath;
+}
+
+/// <summary>
+/// Returns true if mode can be used in batch mode (see processPage).
+/// </summary>
+/// <param name="mode">The mode (e.g. layout).</param>
+bool isBatchMode(const QString& mode) {
+
+	QStringList modes;
+	modes << "layout" << "separators" << "table" << "atable";
+
+	return modes.contains(mode);
+}
+
+/// <summary>
+/// Processes a single page in batch mode.
+/// Only modes that process a page independently are supported.
+/// </summary>
+/// <param name="mode">The mode (e.g. layout).</param>
+/// <param name="dc">The page's configuration.</param>
+/// <param name="fc">The table configuration.</param>
+/// <returns>false if the page could not be processed</returns>
+bool processPage(const QString& mode, const rdf::DebugConfig& dc, const rdf::FormFeaturesConfig& fc) {
+
+	if (mode == "table") {
+		rdf::TableProcessing tableproc(dc);
+		tableproc.setTableConfig(fc);
+		return tableproc.match();
+	}
+	else if (mode == "atable") {
+		rdf::TableProcessing tableproc(dc);
+		tableproc.setTableConfig(fc);
+		return tableproc.apply();
+	}
+	else if (mode == "separators") {
+		rdf::LineProcessing lineproc(dc);
+		return lineproc.lineTrace();
+	}
+	else if (mode == "layout") {
+		rdf::LayoutTest lt(dc);
+		return lt.layoutToXml();
+	}
+
+	qWarning() << "mode" << mode << "is not supported in batch mode - use [-m layout|separators|table|atable]";
+	return false;
+}
+
 bool testFunction() {
 
 	// tests the line distance to point function